@@ -26,16 +26,27 @@
 # originally generated with the command:
 # find opm -name '*.c*' -printf '\t%p\n' | sort
 list (APPEND MAIN_SOURCE_FILES
+	opm/polymer/AndersonAcceleration.cpp
+	opm/polymer/CellRenumbering.cpp
+	opm/polymer/CellStencil.cpp
 	opm/polymer/CompressibleTpfaPolymer.cpp
+	opm/polymer/GravityColumnSolverPolymer.cpp
+	opm/polymer/GravityColumns.cpp
 	opm/polymer/IncompTpfaPolymer.cpp
 	opm/polymer/PolymerInflow.cpp
+	opm/polymer/PolymerLog.cpp
 	opm/polymer/PolymerProperties.cpp
+	opm/polymer/PolymerTrace.cpp
+	opm/polymer/PolymerWellboreTransport.cpp
 	opm/polymer/polymerUtilities.cpp
 	opm/polymer/SimulatorCompressiblePolymer.cpp
 	opm/polymer/SimulatorPolymer.cpp
 	opm/polymer/TransportSolverTwophaseCompressiblePolymer.cpp
 	opm/polymer/TransportSolverTwophasePolymer.cpp
+	opm/polymer/TwophaseFluidPolymer.cpp
+	opm/polymer/WellNameIndex.cpp
     opm/polymer/fullyimplicit/PolymerPropsAd.cpp
+    opm/polymer/fullyimplicit/NewtonIterationBlackoilReorderCPR.cpp
     opm/polymer/fullyimplicit/FullyImplicitCompressiblePolymerSolver.cpp
     opm/polymer/fullyimplicit/SimulatorFullyImplicitCompressiblePolymer.cpp
 	)
@@ -43,6 +54,11 @@ list (APPEND MAIN_SOURCE_FILES
 # originally generated with the command:
 # find tests -name '*.cpp' -a ! -wholename '*/not-unit/*' -printf '\t%p\n' | sort
 list (APPEND TEST_SOURCE_FILES
+	tests/test_adsorptionconservation.cpp
+	tests/test_gravitycolumnsolverpolymer.cpp
+	tests/test_gravitysweep.cpp
+	tests/test_implicittransportpolymer.cpp
+	tests/test_multicellsolves.cpp
 	)
 
 # originally generated with the command:
@@ -72,22 +88,36 @@ list (APPEND PROGRAM_SOURCE_FILES
 # originally generated with the command:
 # find opm -name '*.h*' -a ! -name '*-pch.hpp' -printf '\t%p\n' | sort
 list (APPEND PUBLIC_HEADER_FILES
+	opm/polymer/AndersonAcceleration.hpp
+	opm/polymer/CellRenumbering.hpp
+	opm/polymer/CellStencil.hpp
 	opm/polymer/CompressibleTpfaPolymer.hpp
 	opm/polymer/GravityColumnSolverPolymer.hpp
 	opm/polymer/GravityColumnSolverPolymer_impl.hpp
+	opm/polymer/GravityColumns.hpp
+	opm/polymer/ImplicitTransportSolverPolymer.hpp
+	opm/polymer/ImplicitTransportSolverPolymer_impl.hpp
 	opm/polymer/IncompPropertiesDefaultPolymer.hpp
 	opm/polymer/IncompTpfaPolymer.hpp
 	opm/polymer/PolymerBlackoilState.hpp
 	opm/polymer/PolymerInflow.hpp
+	opm/polymer/PolymerLog.hpp
 	opm/polymer/PolymerProperties.hpp
 	opm/polymer/PolymerState.hpp
+	opm/polymer/PolymerStepMaxConcentration.hpp
+	opm/polymer/PolymerTrace.hpp
+	opm/polymer/PolymerWellboreTransport.hpp
 	opm/polymer/polymerUtilities.hpp
+	opm/polymer/ScratchBuffer.hpp
 	opm/polymer/SimulatorCompressiblePolymer.hpp
 	opm/polymer/SimulatorPolymer.hpp
 	opm/polymer/SinglePointUpwindTwoPhasePolymer.hpp
 	opm/polymer/TransportSolverTwophaseCompressiblePolymer.hpp
     opm/polymer/TransportSolverTwophasePolymer.hpp
+	opm/polymer/TwophaseFluidPolymer.hpp
+	opm/polymer/WellNameIndex.hpp
     opm/polymer/fullyimplicit/PolymerPropsAd.hpp
+    opm/polymer/fullyimplicit/NewtonIterationBlackoilReorderCPR.hpp
     opm/polymer/fullyimplicit/FullyImplicitCompressiblePolymerSolver.hpp
     opm/polymer/fullyimplicit/SimulatorFullyImplicitCompressiblePolymer.hpp
     opm/polymer/fullyimplicit/FullyImplicitBlackoilPolymerSolver.hpp
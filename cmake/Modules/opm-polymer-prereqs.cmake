@@ -16,6 +16,9 @@ set (opm-polymer_DEPS
 		COMPONENTS date_time filesystem system iostreams unit_test_framework REQUIRED"
 	# Ensembles-based Reservoir Tools
 	"ERT"
+	# DUNE prerequisites, the reorder CPR solver uses dune-istl AMG
+	"dune-common REQUIRED;
+	dune-istl REQUIRED"
 	# OPM dependency
 	"opm-autodiff REQUIRED"
 	"opm-core REQUIRED"
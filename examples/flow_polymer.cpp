@@ -47,8 +47,11 @@
 
 #include <opm/polymer/fullyimplicit/SimulatorFullyImplicitBlackoilPolymer.hpp>
 #include <opm/polymer/fullyimplicit/PolymerPropsAd.hpp>
+#include <opm/polymer/fullyimplicit/NewtonIterationBlackoilReorderCPR.hpp>
 #include <opm/polymer/PolymerProperties.hpp>
 #include <opm/polymer/PolymerInflow.hpp>
+#include <opm/polymer/PolymerLog.hpp>
+#include <opm/polymer/PolymerTrace.hpp>
 #include <opm/autodiff/BlackoilPropsAdFromDeck.hpp>
 #include <opm/autodiff/BlackoilPropsAdInterface.hpp>
 
@@ -93,6 +96,8 @@ try
 
     std::cout << "\n================    Test program for fully implicit three-phase black-oil-polymer flow     ===============\n\n";
     parameter::ParameterGroup param(argc, argv, false);
+    PolymerLog::init(param);
+    PolymerTrace::init(param);
     std::cout << "---------------    Reading parameters     ---------------" << std::endl;
 
     // If we have a "deck_filename", grid and props will be read from that.
@@ -169,6 +174,12 @@ try
     const bool polymer = deck->hasKeyword("POLYMER");
     const bool use_wpolymer = deck->hasKeyword("WPOLYMER");
     PolymerProperties polymer_props(deck, eclipseState);
+    polymer_props.setSmoothing(param.getDefault("polymer_smoothing_width", 0.0));
+    if (polymer_props.smoothingWidth() > 0.0) {
+        OPM_POLYMER_LOG_INFO("Polymer model smoothing width " << polymer_props.smoothingWidth()
+                             << ", viscosity multiplier error bound " << polymer_props.viscMultSmoothingError()
+                             << ", adsorption error bound " << polymer_props.adsorptionSmoothingError());
+    }
     PolymerPropsAd polymer_props_ad(polymer_props);
     // check_well_controls = param.getDefault("check_well_controls", false);
     // max_well_control_iterations = param.getDefault("max_well_control_iterations", 10);
@@ -215,7 +226,11 @@ try
 
     // Solver for Newton iterations.
     std::unique_ptr<NewtonIterationBlackoilInterface> fis_solver;
-    if (param.getDefault("use_cpr", true)) {
+    NewtonIterationBlackoilReorderCPR* reorder_cpr = 0;
+    if (param.getDefault("use_reorder_cpr", false)) {
+        reorder_cpr = new NewtonIterationBlackoilReorderCPR(param);
+        fis_solver.reset(reorder_cpr);
+    } else if (param.getDefault("use_cpr", true)) {
         fis_solver.reset(new NewtonIterationBlackoilCPR(param));
     } else {
         fis_solver.reset(new NewtonIterationBlackoilSimple(param));
@@ -261,12 +276,15 @@ try
                                              outputWriter,
                                              deck,
                                              threshold_pressures);
+    simulator.setReorderSolver(reorder_cpr);
 
     std::cout << "\n\n================ Starting main simulation loop ===============\n"
               << std::flush;
 
     SimulatorReport fullReport = simulator.run(simtimer, state);
 
+    PolymerTrace::write();
+    PolymerLog::flush();
     std::cout << "\n\n================    End of simulation     ===============\n\n";
     fullReport.report(std::cout);
 
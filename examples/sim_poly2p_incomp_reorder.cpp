@@ -46,6 +46,9 @@
 #include <opm/polymer/SimulatorPolymer.hpp>
 #include <opm/polymer/PolymerInflow.hpp>
 #include <opm/polymer/PolymerProperties.hpp>
+#include <opm/polymer/CellRenumbering.hpp>
+#include <opm/polymer/PolymerLog.hpp>
+#include <opm/polymer/PolymerTrace.hpp>
 
 #include <opm/parser/eclipse/Parser/Parser.hpp>
 #include <opm/parser/eclipse/EclipseState/EclipseState.hpp>
@@ -82,12 +85,17 @@ try
 
     std::cout << "\n================    Test program for incompressible two-phase flow with polymer    ===============\n\n";
     parameter::ParameterGroup param(argc, argv, false);
+    PolymerLog::init(param);
+    PolymerTrace::init(param);
     std::cout << "---------------    Reading parameters     ---------------" << std::endl;
 
     // If we have a "deck_filename", grid and props will be read from that.
     bool use_deck = param.has("deck_filename");
     Opm::DeckConstPtr deck;
     boost::scoped_ptr<GridManager> grid;
+    boost::scoped_ptr<CellRenumbering> renumbering;
+    const CellRenumbering::Method renumber_method
+        = CellRenumbering::methodFromString(param.getDefault("renumber_cells", std::string("none")));
     boost::scoped_ptr<IncompPropertiesInterface> props;
     boost::scoped_ptr<RockCompressibility> rock_comp;
     EclipseStateConstPtr eclipseState;
@@ -104,8 +112,9 @@ try
 
         // Grid init
         grid.reset(new GridManager(deck));
+        renumbering.reset(new CellRenumbering(*grid->c_grid(), renumber_method));
         // Rock and fluid init
-        props.reset(new IncompPropertiesFromDeck(deck, eclipseState, *grid->c_grid()));
+        props.reset(new IncompPropertiesFromDeck(deck, eclipseState, renumbering->grid()));
         // check_well_controls = param.getDefault("check_well_controls", false);
         // max_well_control_iterations = param.getDefault("max_well_control_iterations", 10);
         // Rock compressibility.
@@ -114,9 +123,9 @@ try
         gravity[2] = deck->hasKeyword("NOGRAV") ? 0.0 : unit::gravity;
         // Init state variables (saturation and pressure).
         if (param.has("init_saturation")) {
-            initStateBasic(*grid->c_grid(), *props, param, gravity[2], state);
+            initStateBasic(renumbering->grid(), *props, param, gravity[2], state);
         } else {
-            initStateFromDeck(*grid->c_grid(), *props, deck, gravity[2], state);
+            initStateFromDeck(renumbering->grid(), *props, deck, gravity[2], state);
         }
         // Init polymer properties.
         poly_props.readFromDeck(deck, eclipseState);
@@ -129,18 +138,19 @@ try
         const double dy = param.getDefault("dy", 1.0);
         const double dz = param.getDefault("dz", 1.0);
         grid.reset(new GridManager(nx, ny, nz, dx, dy, dz));
+        renumbering.reset(new CellRenumbering(*grid->c_grid(), renumber_method));
         // Rock and fluid init.
-        props.reset(new IncompPropertiesBasic(param, grid->c_grid()->dimensions, grid->c_grid()->number_of_cells));
+        props.reset(new IncompPropertiesBasic(param, renumbering->grid().dimensions, renumbering->grid().number_of_cells));
         // Rock compressibility.
         rock_comp.reset(new RockCompressibility(param));
         // Gravity.
         gravity[2] = param.getDefault("gravity", 0.0);
         // Init state variables (saturation and pressure).
-        initStateBasic(*grid->c_grid(), *props, param, gravity[2], state);
+        initStateBasic(renumbering->grid(), *props, param, gravity[2], state);
         // Init Polymer state
         if (param.has("poly_init")) {
             double poly_init = param.getDefault("poly_init", 0.0);
-            for (int cell = 0; cell < grid->c_grid()->number_of_cells; ++cell) {
+            for (int cell = 0; cell < renumbering->grid().number_of_cells; ++cell) {
                 double smin[2], smax[2];
                 props->satRange(1, &cell, smin, smax);
                 if (state.saturation()[2*cell] > 0.5*(smin[0] + smax[0])) {
@@ -191,6 +201,12 @@ try
                        c_vals_visc,  visc_mult_vals, c_vals_ads, ads_vals, water_vel_vals, shear_vrf_vals);
     }
 
+    if (renumber_method != CellRenumbering::None) {
+        std::cout << "Renumbered cells, average neighbour index distance "
+                  << CellRenumbering::neighbourDistance(*grid->c_grid()) << " -> "
+                  << CellRenumbering::neighbourDistance(renumbering->grid()) << std::endl;
+    }
+
     // Warn if gravity but no density difference.
     bool use_gravity = (gravity[0] != 0.0 || gravity[1] != 0.0 || gravity[2] != 0.0);
     if (use_gravity) {
@@ -201,7 +217,7 @@ try
     const double *grav = use_gravity ? &gravity[0] : 0;
 
     // Initialising src
-    int num_cells = grid->c_grid()->number_of_cells;
+    int num_cells = renumbering->grid().number_of_cells;
     std::vector<double> src(num_cells, 0.0);
     if (use_deck) {
         // Do nothing, wells will be the driving force, not source terms.
@@ -210,16 +226,16 @@ try
         // terms of total pore volume.
         std::vector<double> porevol;
         if (rock_comp->isActive()) {
-            computePorevolume(*grid->c_grid(), props->porosity(), *rock_comp, state.pressure(), porevol);
+            computePorevolume(renumbering->grid(), props->porosity(), *rock_comp, state.pressure(), porevol);
         } else {
-            computePorevolume(*grid->c_grid(), props->porosity(), porevol);
+            computePorevolume(renumbering->grid(), props->porosity(), porevol);
         }
         const double tot_porevol_init = std::accumulate(porevol.begin(), porevol.end(), 0.0);
         const double default_injection = use_gravity ? 0.0 : 0.1;
         const double flow_per_sec = param.getDefault<double>("injected_porevolumes_per_day", default_injection)
             *tot_porevol_init/unit::day;
-        src[0] = flow_per_sec;
-        src[num_cells - 1] = -flow_per_sec;
+        src[renumbering->oldToNew()[0]] = flow_per_sec;
+        src[renumbering->oldToNew()[num_cells - 1]] = -flow_per_sec;
     }
 
     // Boundary conditions.
@@ -227,7 +243,7 @@ try
     if (param.getDefault("use_pside", false)) {
         int pside = param.get<int>("pside");
         double pside_pressure = param.get<double>("pside_pressure");
-        bcs.pressureSide(*grid->c_grid(), FlowBCManager::Side(pside), pside_pressure);
+        bcs.pressureSide(renumbering->grid(), FlowBCManager::Side(pside), pside_pressure);
     }
 
     // Linear solver.
@@ -260,7 +276,7 @@ try
                                           param.getDefault("poly_amount", poly_props.cMax()));
         WellsManager wells;
         SimulatorPolymer simulator(param,
-                                   *grid->c_grid(),
+                                   renumbering->grid(),
                                    *props,
                                    poly_props,
                                    rock_comp->isActive() ? rock_comp.get() : 0,
@@ -302,7 +318,7 @@ try
                       << simtimer.numSteps() - step << ")\n\n" << std::flush;
 
             // Create new wells, polymer inflow controls.
-            WellsManager wells(eclipseState , reportStepIdx , *grid->c_grid(), props->permeability());
+            WellsManager wells(eclipseState , reportStepIdx , renumbering->grid(), props->permeability());
             boost::scoped_ptr<PolymerInflowInterface> polymer_inflow;
             if (use_wpolymer) {
                 if (wells.c_wells() == 0) {
@@ -324,7 +340,7 @@ try
 
             // Create and run simulator.
             SimulatorPolymer simulator(param,
-                                       *grid->c_grid(),
+                                       renumbering->grid(),
                                        *props,
                                        poly_props,
                                        rock_comp->isActive() ? rock_comp.get() : 0,
@@ -345,6 +361,8 @@ try
         }
     }
 
+    PolymerTrace::write();
+    PolymerLog::flush();
     std::cout << "\n\n================    End of simulation     ===============\n\n";
     rep.report(std::cout);
 }
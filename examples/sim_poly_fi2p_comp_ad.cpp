@@ -52,6 +52,9 @@
 #include <opm/polymer/fullyimplicit/PolymerPropsAd.hpp>
 #include <opm/polymer/PolymerProperties.hpp>
 #include <opm/polymer/PolymerInflow.hpp>
+#include <opm/polymer/CellRenumbering.hpp>
+#include <opm/polymer/PolymerLog.hpp>
+#include <opm/polymer/PolymerTrace.hpp>
 #include <opm/polymer/PolymerState.hpp>
 
 #include <opm/autodiff/BlackoilPropsAdFromDeck.hpp>
@@ -94,6 +97,8 @@ try
 
     std::cout << "\n================    Test program for fully implicit three-phase black-oil flow     ===============\n\n";
     parameter::ParameterGroup param(argc, argv, false);
+    PolymerLog::init(param);
+    PolymerTrace::init(param);
     std::cout << "---------------    Reading parameters     ---------------" << std::endl;
 
     // If we have a "deck_filename", grid and props will be read from that.
@@ -121,7 +126,9 @@ try
         porv = eclipseState->getDoubleGridProperty("PORV")->getData();
     }
     grid.reset(new GridManager(eclipseState->getEclipseGrid(), porv));
-    auto &cGrid = *grid->c_grid();
+    CellRenumbering renumbering(*grid->c_grid(),
+                                CellRenumbering::methodFromString(param.getDefault("renumber_cells", std::string("none"))));
+    const UnstructuredGrid& cGrid = renumbering.grid();
     const PhaseUsage pu = Opm::phaseUsageFromDeck(deck);
     Opm::EclipseWriter outputWriter(param,
                                     eclipseState,
@@ -129,9 +136,15 @@ try
                                     cGrid.number_of_cells,
                                     cGrid.global_cell);
     // Rock and fluid init
-    props.reset(new BlackoilPropertiesFromDeck(deck, eclipseState, *grid->c_grid(), param));
-    new_props.reset(new BlackoilPropsAdFromDeck(deck, eclipseState, *grid->c_grid()));
+    props.reset(new BlackoilPropertiesFromDeck(deck, eclipseState, cGrid, param));
+    new_props.reset(new BlackoilPropsAdFromDeck(deck, eclipseState, cGrid));
     PolymerProperties polymer_props(deck, eclipseState);
+    polymer_props.setSmoothing(param.getDefault("polymer_smoothing_width", 0.0));
+    if (polymer_props.smoothingWidth() > 0.0) {
+        OPM_POLYMER_LOG_INFO("Polymer model smoothing width " << polymer_props.smoothingWidth()
+                             << ", viscosity multiplier error bound " << polymer_props.viscMultSmoothingError()
+                             << ", adsorption error bound " << polymer_props.adsorptionSmoothingError());
+    }
     PolymerPropsAd polymer_props_ad(polymer_props);
     // Rock compressibility.
     rock_comp.reset(new RockCompressibility(deck, eclipseState));
@@ -139,10 +152,10 @@ try
     gravity[2] = deck->hasKeyword("NOGRAV") ? 0.0 : unit::gravity;
     // Init state variables (saturation and pressure).
     if (param.has("init_saturation")) {
-        initStateBasic(*grid->c_grid(), *props, param, gravity[2], state);
-        initBlackoilSurfvol(*grid->c_grid(), *props, state);
+        initStateBasic(cGrid, *props, param, gravity[2], state);
+        initBlackoilSurfvol(cGrid, *props, state);
     } else {
-        initStateFromDeck(*grid->c_grid(), *props, deck, gravity[2], state);
+        initStateFromDeck(cGrid, *props, deck, gravity[2], state);
     }
 
     bool use_gravity = (gravity[0] != 0.0 || gravity[1] != 0.0 || gravity[2] != 0.0);
@@ -192,9 +205,9 @@ try
               << std::flush;
     SimulatorReport fullReport;
     // Create and run simulator.
-    Opm::DerivedGeology geology(*grid->c_grid(), *new_props, eclipseState, grav);
+    Opm::DerivedGeology geology(cGrid, *new_props, eclipseState, grav);
     SimulatorFullyImplicitCompressiblePolymer simulator(param,
-                                             *grid->c_grid(),
+                                             cGrid,
                                              geology,
                                              *new_props,
                                              polymer_props_ad,
@@ -206,6 +219,8 @@ try
                                              grav);
     fullReport= simulator.run(simtimer, state);
 
+    PolymerTrace::write();
+    PolymerLog::flush();
     std::cout << "\n\n================    End of simulation     ===============\n\n";
     fullReport.report(std::cout);
 
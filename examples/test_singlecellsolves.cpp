@@ -171,6 +171,8 @@ try
         method = Opm::TransportSolverTwophasePolymer::NewtonSimpleSC;
     } else if (method_string == "NewtonSimpleC") {
         method = Opm::TransportSolverTwophasePolymer::NewtonSimpleC;
+    } else if (method_string == "TrustRegion") {
+        method = Opm::TransportSolverTwophasePolymer::TrustRegion;
     } else {
         OPM_THROW(std::runtime_error, "Unknown method: " << method_string);
     }
@@ -211,6 +213,11 @@ try
         OPM_THROW(std::runtime_error, "Could not find face adjacent to cells [0 1]");
     }
     state.faceflux()[face01] = src[0];
+    // Residual evaluations per (s, c) solve, to compare methods.
+    long total_evaluations = 0;
+    long max_evaluations = 0;
+    double hardest_s = 0.0;
+    double hardest_c = 0.0;
     for (int sats = 0; sats < num_sats; ++sats) {
         const double s = double(sats)/double(num_sats - 1);
         const double ff = s; // Simplified a lot...
@@ -234,6 +241,13 @@ try
                                 state.saturation(),
                                 state.concentration(),
                                 state.maxconcentration());
+            const long evaluations = reorder_model.residualEvaluations() - total_evaluations;
+            total_evaluations += evaluations;
+            if (evaluations > max_evaluations) {
+                max_evaluations = evaluations;
+                hardest_s = s;
+                hardest_c = c;
+            }
 
 #ifdef PROFILING
             // Extract residual counts.
@@ -251,6 +265,13 @@ try
 #endif
         }
     }
+    const std::pair<long, long> tr_solves = reorder_model.trustRegionSolves();
+    std::cerr << "Method " << method_string << ": "
+              << double(total_evaluations)/double(num_sats*num_concs)
+              << " residual evaluations per solve on average, at most " << max_evaluations
+              << " for inflow (s, c) = (" << hardest_s << ", " << hardest_c << ").\n"
+              << "Trust-region solves: " << tr_solves.first
+              << ", fallbacks to bracketing: " << tr_solves.second << std::endl;
 }
 catch (const std::exception &e) {
     std::cerr << "Program threw an exception: " << e.what() << "\n";
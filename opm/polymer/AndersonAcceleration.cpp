@@ -0,0 +1,249 @@
+/*
+  Copyright 2014 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+#include <opm/polymer/AndersonAcceleration.hpp>
+#include <opm/core/utility/ErrorMacros.hpp>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace Opm
+{
+
+    namespace
+    {
+        // Restart when the residual norm grows by more than this factor.
+        const double residual_growth_limit = 2.0;
+
+        double dot(const int n, const double* a, const double* b)
+        {
+            double sum = 0.0;
+            for (int i = 0; i < n; ++i) {
+                sum += a[i]*b[i];
+            }
+            return sum;
+        }
+    } // anonymous namespace
+
+
+
+
+    AndersonAcceleration::AndersonAcceleration(const int depth, const int max_size)
+        : depth_(0),
+          max_size_(max_size),
+          n_(0),
+          num_columns_(0),
+          next_column_(0),
+          have_previous_(false),
+          previous_norm_(0.0),
+          restarts_(0),
+          accelerated_steps_(0)
+    {
+        setDepth(depth);
+    }
+
+
+
+
+    void AndersonAcceleration::setDepth(const int depth)
+    {
+        if (depth < 0) {
+            OPM_THROW(std::runtime_error, "Anderson acceleration depth must be non-negative, got " << depth);
+        }
+        depth_ = depth;
+        reset(n_);
+        if (depth_ > 0 && max_size_ > 0) {
+            f_.get(max_size_);
+            previous_f_.get(max_size_);
+            previous_g_.get(max_size_);
+            df_.get(depth_*max_size_);
+            dg_.get(depth_*max_size_);
+            normal_.get(depth_*(depth_ + 1));
+            gamma_.get(depth_);
+        }
+    }
+
+
+
+
+    int AndersonAcceleration::depth() const
+    {
+        return depth_;
+    }
+
+
+
+
+    void AndersonAcceleration::reset(const int n)
+    {
+        n_ = n;
+        num_columns_ = 0;
+        next_column_ = 0;
+        have_previous_ = false;
+        previous_norm_ = 0.0;
+    }
+
+
+
+
+    void AndersonAcceleration::restart()
+    {
+        num_columns_ = 0;
+        next_column_ = 0;
+        ++restarts_;
+    }
+
+
+
+
+    void AndersonAcceleration::accelerate(const double* x, double* gx)
+    {
+        if (depth_ == 0 || n_ == 0) {
+            return;
+        }
+        double* f = f_.get(n_);
+        double* previous_f = previous_f_.get(n_);
+        double* previous_g = previous_g_.get(n_);
+        double* df = df_.get(depth_*n_);
+        double* dg = dg_.get(depth_*n_);
+        for (int i = 0; i < n_; ++i) {
+            f[i] = gx[i] - x[i];
+        }
+        const double norm = std::sqrt(dot(n_, f, f));
+
+        // Update the history with the differences to the previous step.
+        bool mix = true;
+        if (!have_previous_) {
+            mix = false;
+        } else if (norm > residual_growth_limit*previous_norm_) {
+            restart();
+            mix = false;
+        } else {
+            double* df_col = df + next_column_*n_;
+            double* dg_col = dg + next_column_*n_;
+            for (int i = 0; i < n_; ++i) {
+                df_col[i] = f[i] - previous_f[i];
+                dg_col[i] = gx[i] - previous_g[i];
+            }
+            next_column_ = (next_column_ + 1) % depth_;
+            num_columns_ = std::min(num_columns_ + 1, depth_);
+        }
+        std::copy(f, f + n_, previous_f);
+        std::copy(gx, gx + n_, previous_g);
+        have_previous_ = true;
+        previous_norm_ = norm;
+        if (!mix) {
+            return;
+        }
+
+        double* gamma = gamma_.get(depth_);
+        if (!solveLeastSquares(num_columns_, f, gamma)) {
+            restart();
+            return;
+        }
+        for (int j = 0; j < num_columns_; ++j) {
+            const double* dg_col = dg + j*n_;
+            for (int i = 0; i < n_; ++i) {
+                gx[i] -= gamma[j]*dg_col[i];
+            }
+        }
+        ++accelerated_steps_;
+    }
+
+
+
+
+    /// Solve min |f - dF gamma| through the normal equations, with
+    /// Gaussian elimination and partial pivoting. Returns false if the
+    /// system is numerically singular.
+    bool AndersonAcceleration::solveLeastSquares(const int m, const double* f, double* gamma)
+    {
+        const double* df = df_.get(depth_*n_);
+        double* a = normal_.get(depth_*(depth_ + 1));
+        const int lda = m + 1;
+        double max_diag = 0.0;
+        for (int r = 0; r < m; ++r) {
+            for (int c = 0; c <= r; ++c) {
+                a[r*lda + c] = a[c*lda + r] = dot(n_, df + r*n_, df + c*n_);
+            }
+            a[r*lda + m] = dot(n_, df + r*n_, f);
+            max_diag = std::max(max_diag, a[r*lda + r]);
+        }
+        if (max_diag <= 0.0) {
+            return false;
+        }
+        const double eps = 1e-12*max_diag;
+        for (int k = 0; k < m; ++k) {
+            int pivot = k;
+            for (int r = k + 1; r < m; ++r) {
+                if (std::fabs(a[r*lda + k]) > std::fabs(a[pivot*lda + k])) {
+                    pivot = r;
+                }
+            }
+            if (std::fabs(a[pivot*lda + k]) <= eps) {
+                return false;
+            }
+            if (pivot != k) {
+                std::swap_ranges(a + k*lda, a + (k + 1)*lda, a + pivot*lda);
+            }
+            for (int r = k + 1; r < m; ++r) {
+                const double factor = a[r*lda + k]/a[k*lda + k];
+                for (int c = k; c <= m; ++c) {
+                    a[r*lda + c] -= factor*a[k*lda + c];
+                }
+            }
+        }
+        for (int k = m - 1; k >= 0; --k) {
+            double sum = a[k*lda + m];
+            for (int c = k + 1; c < m; ++c) {
+                sum -= a[k*lda + c]*gamma[c];
+            }
+            gamma[k] = sum/a[k*lda + k];
+        }
+        return true;
+    }
+
+
+
+
+    int AndersonAcceleration::restarts() const
+    {
+        return restarts_;
+    }
+
+
+
+
+    long AndersonAcceleration::acceleratedSteps() const
+    {
+        return accelerated_steps_;
+    }
+
+
+
+
+    int AndersonAcceleration::scratchAllocations() const
+    {
+        return df_.allocations() + dg_.allocations() + f_.allocations()
+            + previous_f_.allocations() + previous_g_.allocations()
+            + normal_.allocations() + gamma_.allocations();
+    }
+
+} // namespace Opm
@@ -0,0 +1,98 @@
+/*
+  Copyright 2014 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_ANDERSONACCELERATION_HEADER_INCLUDED
+#define OPM_ANDERSONACCELERATION_HEADER_INCLUDED
+
+#include <opm/polymer/ScratchBuffer.hpp>
+
+namespace Opm
+{
+
+    /// @brief Anderson acceleration of a fixed-point iteration x = G(x).
+    ///
+    /// Keeps the differences of the last few iterates and their
+    /// residuals G(x) - x, and replaces G(x_k) by the combination of
+    /// the recent G values whose residual has the smallest norm in the
+    /// least squares sense. The history is dropped (a restart) when the
+    /// residual norm grows, or when the least squares problem is
+    /// singular, and the plain fixed-point step is taken instead.
+    /// With depth 0 the iteration is left unchanged.
+    class AndersonAcceleration
+    {
+    public:
+        /// Construct with a memory depth, typically 1 to 5, and the
+        /// largest vector size that reset() will be called with. The
+        /// scratch storage for that size is allocated by the constructor
+        /// and by setDepth(), so accelerate() does not allocate.
+        explicit AndersonAcceleration(const int depth = 0, const int max_size = 0);
+
+        /// Set the memory depth, 0 disables acceleration.
+        void setDepth(const int depth);
+
+        /// The memory depth.
+        int depth() const;
+
+        /// Start a new fixed-point iteration on vectors of size n. The
+        /// scratch storage grows if n is larger than max_size.
+        void reset(const int n);
+
+        /// Accelerate one step.
+        /// \param[in]     x   current iterate x_k.
+        /// \param[in,out] gx  G(x_k) on input, next iterate on output.
+        void accelerate(const double* x, double* gx);
+
+        /// Number of restarts since construction.
+        int restarts() const;
+
+        /// Number of accelerated (mixed) steps since construction.
+        long acceleratedSteps() const;
+
+        /// Number of scratch buffer allocations made so far, including
+        /// those made by the constructor and setDepth().
+        int scratchAllocations() const;
+
+    private:
+        void restart();
+        bool solveLeastSquares(const int m, const double* f, double* gamma);
+
+        int depth_;
+        int max_size_;
+        int n_;
+        int num_columns_;
+        int next_column_;
+        bool have_previous_;
+        double previous_norm_;
+        int restarts_;
+        long accelerated_steps_;
+        // Differences of residuals and of G values, one column of size
+        // n_ per stored step.
+        ScratchBuffer<double> df_;
+        ScratchBuffer<double> dg_;
+        ScratchBuffer<double> f_;
+        ScratchBuffer<double> previous_f_;
+        ScratchBuffer<double> previous_g_;
+        ScratchBuffer<double> normal_;
+        ScratchBuffer<double> gamma_;
+    };
+
+} // namespace Opm
+
+
+#endif // OPM_ANDERSONACCELERATION_HEADER_INCLUDED
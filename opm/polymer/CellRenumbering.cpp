@@ -0,0 +1,432 @@
+/*
+  Copyright 2014 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+#include <opm/polymer/CellRenumbering.hpp>
+#include <opm/core/grid.h>
+#include <opm/core/utility/ErrorMacros.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <utility>
+
+namespace Opm
+{
+
+    namespace
+    {
+
+        typedef unsigned long long HilbertKey;
+
+        // Number of bits per coordinate; 3*21 bits fit in the key.
+        const int hilbert_bits = 21;
+
+        /// Position along the Hilbert curve of a point with integer
+        /// coordinates in [0, 2^bits), following J. Skilling,
+        /// "Programming the Hilbert curve", AIP Conf. Proc. 707 (2004).
+        HilbertKey hilbertKey(unsigned int* x, const int dim, const int bits)
+        {
+            const unsigned int m = 1u << (bits - 1);
+            // Inverse undo excess work.
+            for (unsigned int q = m; q > 1; q >>= 1) {
+                const unsigned int p = q - 1;
+                for (int i = 0; i < dim; ++i) {
+                    if (x[i] & q) {
+                        x[0] ^= p;
+                    } else {
+                        const unsigned int t = (x[0] ^ x[i]) & p;
+                        x[0] ^= t;
+                        x[i] ^= t;
+                    }
+                }
+            }
+            // Gray encode.
+            for (int i = 1; i < dim; ++i) {
+                x[i] ^= x[i - 1];
+            }
+            unsigned int t = 0;
+            for (unsigned int q = m; q > 1; q >>= 1) {
+                if (x[dim - 1] & q) {
+                    t ^= q - 1;
+                }
+            }
+            for (int i = 0; i < dim; ++i) {
+                x[i] ^= t;
+            }
+            // Interleave the transposed bits, most significant first.
+            HilbertKey key = 0;
+            for (int b = bits - 1; b >= 0; --b) {
+                for (int i = 0; i < dim; ++i) {
+                    key = (key << 1) | ((x[i] >> b) & 1u);
+                }
+            }
+            return key;
+        }
+
+
+
+        /// Cell adjacency through interior faces, in CSR form.
+        void cellNeighbours(const UnstructuredGrid& grid,
+                            std::vector<int>& ia,
+                            std::vector<int>& ja)
+        {
+            const int nc = grid.number_of_cells;
+            ia.assign(nc + 1, 0);
+            ja.resize(grid.cell_facepos[nc]);
+            for (int cell = 0; cell < nc; ++cell) {
+                ia[cell + 1] = ia[cell];
+                for (int i = grid.cell_facepos[cell]; i < grid.cell_facepos[cell + 1]; ++i) {
+                    const int f = grid.cell_faces[i];
+                    const int c0 = grid.face_cells[2*f];
+                    const int c1 = grid.face_cells[2*f + 1];
+                    const int other = (c0 == cell) ? c1 : c0;
+                    if (other >= 0 && other != cell) {
+                        ja[ia[cell + 1]++] = other;
+                    }
+                }
+            }
+        }
+
+
+
+        /// Breadth-first search from start, marking the cells reached
+        /// with stamp. Appends the cells in visiting order to order,
+        /// with neighbours visited by increasing degree, and returns
+        /// the last cell reached.
+        int cuthillMcKee(const std::vector<int>& ia,
+                         const std::vector<int>& ja,
+                         const int start,
+                         const int stamp,
+                         std::vector<int>& mark,
+                         std::vector<int>& order)
+        {
+            const std::size_t first = order.size();
+            mark[start] = stamp;
+            order.push_back(start);
+            std::vector<std::pair<int, int> > next;
+            for (std::size_t pos = first; pos < order.size(); ++pos) {
+                const int cell = order[pos];
+                next.clear();
+                for (int i = ia[cell]; i < ia[cell + 1]; ++i) {
+                    const int nb = ja[i];
+                    if (mark[nb] != stamp) {
+                        mark[nb] = stamp;
+                        next.push_back(std::make_pair(ia[nb + 1] - ia[nb], nb));
+                    }
+                }
+                std::sort(next.begin(), next.end());
+                for (std::size_t i = 0; i < next.size(); ++i) {
+                    order.push_back(next[i].second);
+                }
+            }
+            return order.back();
+        }
+
+    } // anonymous namespace
+
+
+
+
+    CellRenumbering::Method CellRenumbering::methodFromString(const std::string& method)
+    {
+        if (method == "none") {
+            return None;
+        } else if (method == "hilbert") {
+            return Hilbert;
+        } else if (method == "rcm") {
+            return ReverseCuthillMcKee;
+        }
+        OPM_THROW(std::runtime_error, "Unknown cell renumbering method " << method
+                  << ", use none, hilbert or rcm.");
+    }
+
+
+
+
+    CellRenumbering::CellRenumbering(const UnstructuredGrid& grid, const Method method)
+        : original_(&grid),
+          renumbered_(0)
+    {
+        const int nc = grid.number_of_cells;
+        switch (method) {
+        case None:
+            new_to_old_.resize(nc);
+            for (int cell = 0; cell < nc; ++cell) {
+                new_to_old_[cell] = cell;
+            }
+            break;
+        case Hilbert:
+            computeHilbertOrder(grid);
+            break;
+        case ReverseCuthillMcKee:
+            computeRcmOrder(grid);
+            break;
+        default:
+            OPM_THROW(std::runtime_error, "Unknown cell renumbering method.");
+        }
+        old_to_new_.resize(nc);
+        for (int cell = 0; cell < nc; ++cell) {
+            old_to_new_[new_to_old_[cell]] = cell;
+        }
+        if (method != None) {
+            buildGrid(grid);
+        }
+    }
+
+
+
+
+    CellRenumbering::~CellRenumbering()
+    {
+        if (renumbered_) {
+            destroy_grid(renumbered_);
+        }
+    }
+
+
+
+
+    const UnstructuredGrid& CellRenumbering::grid() const
+    {
+        return renumbered_ ? *renumbered_ : *original_;
+    }
+
+
+
+
+    const std::vector<int>& CellRenumbering::newToOld() const
+    {
+        return new_to_old_;
+    }
+
+
+
+
+    const std::vector<int>& CellRenumbering::oldToNew() const
+    {
+        return old_to_new_;
+    }
+
+
+
+
+    double CellRenumbering::neighbourDistance(const UnstructuredGrid& grid)
+    {
+        double sum = 0.0;
+        int num_interior = 0;
+        for (int f = 0; f < grid.number_of_faces; ++f) {
+            const int c0 = grid.face_cells[2*f];
+            const int c1 = grid.face_cells[2*f + 1];
+            if (c0 >= 0 && c1 >= 0) {
+                sum += std::abs(c1 - c0);
+                ++num_interior;
+            }
+        }
+        return num_interior > 0 ? sum / num_interior : 0.0;
+    }
+
+
+
+
+    void CellRenumbering::computeHilbertOrder(const UnstructuredGrid& grid)
+    {
+        const int nc = grid.number_of_cells;
+        const int dim = grid.dimensions;
+        if (dim < 2 || dim > 3) {
+            OPM_THROW(std::runtime_error, "Hilbert renumbering requires a 2D or 3D grid.");
+        }
+        // Bounding box of the cell centroids.
+        double lo[3] = { 0.0, 0.0, 0.0 };
+        double hi[3] = { 0.0, 0.0, 0.0 };
+        for (int d = 0; d < dim; ++d) {
+            lo[d] = std::numeric_limits<double>::max();
+            hi[d] = -std::numeric_limits<double>::max();
+        }
+        for (int cell = 0; cell < nc; ++cell) {
+            for (int d = 0; d < dim; ++d) {
+                const double x = grid.cell_centroids[dim*cell + d];
+                lo[d] = std::min(lo[d], x);
+                hi[d] = std::max(hi[d], x);
+            }
+        }
+        // Scale all directions equally, to keep the curve's locality
+        // for strongly anisotropic reservoirs.
+        double extent = 0.0;
+        for (int d = 0; d < dim; ++d) {
+            extent = std::max(extent, hi[d] - lo[d]);
+        }
+        const double scale = extent > 0.0 ? ((1u << hilbert_bits) - 1) / extent : 0.0;
+
+        std::vector<std::pair<HilbertKey, int> > keys(nc);
+        for (int cell = 0; cell < nc; ++cell) {
+            unsigned int x[3] = { 0, 0, 0 };
+            for (int d = 0; d < dim; ++d) {
+                x[d] = static_cast<unsigned int>((grid.cell_centroids[dim*cell + d] - lo[d])*scale);
+            }
+            keys[cell] = std::make_pair(hilbertKey(x, dim, hilbert_bits), cell);
+        }
+        std::sort(keys.begin(), keys.end());
+        new_to_old_.resize(nc);
+        for (int cell = 0; cell < nc; ++cell) {
+            new_to_old_[cell] = keys[cell].second;
+        }
+    }
+
+
+
+
+    void CellRenumbering::computeRcmOrder(const UnstructuredGrid& grid)
+    {
+        const int nc = grid.number_of_cells;
+        std::vector<int> ia;
+        std::vector<int> ja;
+        cellNeighbours(grid, ia, ja);
+
+        new_to_old_.clear();
+        new_to_old_.reserve(nc);
+        std::vector<int> mark(nc, -1);
+        std::vector<int> probe;
+        for (int seed = 0; seed < nc; ++seed) {
+            if (mark[seed] >= 0) {
+                continue;
+            }
+            // Start each connected component from a pseudo-peripheral
+            // cell: the last cell reached from a search started in it.
+            probe.clear();
+            const int start = cuthillMcKee(ia, ja, seed, 2*seed, mark, probe);
+            const std::size_t first = new_to_old_.size();
+            cuthillMcKee(ia, ja, start, 2*seed + 1, mark, new_to_old_);
+            std::reverse(new_to_old_.begin() + first, new_to_old_.end());
+        }
+    }
+
+
+
+
+    void CellRenumbering::buildGrid(const UnstructuredGrid& grid)
+    {
+        const int dim = grid.dimensions;
+        const int nc = grid.number_of_cells;
+        const int nf = grid.number_of_faces;
+        const int nn = grid.number_of_nodes;
+
+        // Order faces by their lowest, then highest, renumbered cell.
+        std::vector<std::pair<std::pair<int, int>, int> > face_keys(nf);
+        for (int f = 0; f < nf; ++f) {
+            const int c0 = grid.face_cells[2*f];
+            const int c1 = grid.face_cells[2*f + 1];
+            const int n0 = c0 >= 0 ? old_to_new_[c0] : -1;
+            const int n1 = c1 >= 0 ? old_to_new_[c1] : -1;
+            const int lo = (n0 < 0) ? n1 : ((n1 < 0) ? n0 : std::min(n0, n1));
+            const int hi = std::max(n0, n1);
+            face_keys[f] = std::make_pair(std::make_pair(lo, hi), f);
+        }
+        std::sort(face_keys.begin(), face_keys.end());
+        std::vector<int> face_old_to_new(nf);
+        for (int f = 0; f < nf; ++f) {
+            face_old_to_new[face_keys[f].second] = f;
+        }
+
+        renumbered_ = allocate_grid(dim, nc, nf, grid.face_nodepos[nf],
+                                    grid.cell_facepos[nc], nn);
+        if (renumbered_ == 0) {
+            OPM_THROW(std::runtime_error, "Failed to allocate renumbered grid.");
+        }
+        UnstructuredGrid& g = *renumbered_;
+        std::copy(grid.cartdims, grid.cartdims + 3, g.cartdims);
+        std::copy(grid.node_coordinates, grid.node_coordinates + dim*nn, g.node_coordinates);
+
+        // Faces. Orientation is kept, so normals are copied as is.
+        g.face_nodepos[0] = 0;
+        for (int f = 0; f < nf; ++f) {
+            const int old = face_keys[f].second;
+            const int* nodes_begin = grid.face_nodes + grid.face_nodepos[old];
+            const int* nodes_end = grid.face_nodes + grid.face_nodepos[old + 1];
+            std::copy(nodes_begin, nodes_end, g.face_nodes + g.face_nodepos[f]);
+            g.face_nodepos[f + 1] = g.face_nodepos[f] + (nodes_end - nodes_begin);
+            for (int side = 0; side < 2; ++side) {
+                const int c = grid.face_cells[2*old + side];
+                g.face_cells[2*f + side] = c >= 0 ? old_to_new_[c] : -1;
+            }
+            g.face_areas[f] = grid.face_areas[old];
+            std::copy(grid.face_centroids + dim*old, grid.face_centroids + dim*(old + 1),
+                      g.face_centroids + dim*f);
+            std::copy(grid.face_normals + dim*old, grid.face_normals + dim*(old + 1),
+                      g.face_normals + dim*f);
+        }
+
+        // Cells, keeping the local face order of each cell.
+        if (g.global_cell == 0) {
+            g.global_cell = static_cast<int*>(std::malloc(nc * sizeof *g.global_cell));
+            if (g.global_cell == 0) {
+                OPM_THROW(std::runtime_error, "Failed to allocate renumbered grid.");
+            }
+        }
+        g.cell_facepos[0] = 0;
+        for (int cell = 0; cell < nc; ++cell) {
+            const int old = new_to_old_[cell];
+            const int begin = grid.cell_facepos[old];
+            const int end = grid.cell_facepos[old + 1];
+            const int pos = g.cell_facepos[cell];
+            for (int i = begin; i < end; ++i) {
+                g.cell_faces[pos + i - begin] = face_old_to_new[grid.cell_faces[i]];
+            }
+            if (grid.cell_facetag != 0) {
+                std::copy(grid.cell_facetag + begin, grid.cell_facetag + end, g.cell_facetag + pos);
+            }
+            g.cell_facepos[cell + 1] = pos + (end - begin);
+            g.cell_volumes[cell] = grid.cell_volumes[old];
+            std::copy(grid.cell_centroids + dim*old, grid.cell_centroids + dim*(old + 1),
+                      g.cell_centroids + dim*cell);
+            g.global_cell[cell] = grid.global_cell ? grid.global_cell[old] : old;
+        }
+        if (grid.cell_facetag == 0) {
+            std::free(g.cell_facetag);
+            g.cell_facetag = 0;
+        }
+    }
+
+
+
+
+    void mapToOriginalOrdering(const UnstructuredGrid& grid,
+                               const std::vector<double>& data,
+                               std::vector<double>& original)
+    {
+        const int nc = grid.number_of_cells;
+        const int* gc = grid.global_cell;
+        if (gc == 0 || nc == 0 || std::is_sorted(gc, gc + nc)) {
+            original = data;
+            return;
+        }
+        const int ncomp = data.size() / nc;
+        std::vector<std::pair<int, int> > order(nc);
+        for (int cell = 0; cell < nc; ++cell) {
+            order[cell] = std::make_pair(gc[cell], cell);
+        }
+        std::sort(order.begin(), order.end());
+        original.resize(data.size());
+        for (int i = 0; i < nc; ++i) {
+            const int cell = order[i].second;
+            std::copy(data.begin() + ncomp*cell, data.begin() + ncomp*(cell + 1),
+                      original.begin() + ncomp*i);
+        }
+    }
+
+} // namespace Opm
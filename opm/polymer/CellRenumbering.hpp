@@ -0,0 +1,101 @@
+/*
+  Copyright 2014 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_CELLRENUMBERING_HEADER_INCLUDED
+#define OPM_CELLRENUMBERING_HEADER_INCLUDED
+
+#include <string>
+#include <vector>
+
+struct UnstructuredGrid;
+
+namespace Opm
+{
+
+    /// @brief Renumbered copy of a grid, for better memory locality.
+    ///
+    /// Cells are ordered along a Hilbert curve through the cell
+    /// centroids, or by reverse Cuthill-McKee on the cell adjacency
+    /// graph. Faces are then ordered by their lowest neighbouring
+    /// cell, so that both the cell_faces walks of the transport
+    /// solvers and the face_cells gathers of the flux operators access
+    /// nearby memory.
+    ///
+    /// The global_cell field of the renumbered grid refers to the
+    /// original cell (the logical Cartesian cell if the original grid
+    /// has global_cell, otherwise the original cell index). Properties
+    /// and wells set up from a deck through global_cell therefore
+    /// follow the renumbering without further changes, and
+    /// mapToOriginalOrdering() recovers the original cell order for
+    /// output.
+    class CellRenumbering
+    {
+    public:
+        enum Method { None, Hilbert, ReverseCuthillMcKee };
+
+        /// Method from a parameter value: none, hilbert or rcm.
+        static Method methodFromString(const std::string& method);
+
+        /// Renumber a grid. With method None the original grid is
+        /// used as is and no copy is made.
+        CellRenumbering(const UnstructuredGrid& grid, const Method method);
+
+        ~CellRenumbering();
+
+        /// The renumbered grid.
+        const UnstructuredGrid& grid() const;
+
+        /// Original cell of each renumbered cell.
+        const std::vector<int>& newToOld() const;
+
+        /// Renumbered cell of each original cell.
+        const std::vector<int>& oldToNew() const;
+
+        /// Average index distance between the two cells of the
+        /// interior faces, a measure of the memory locality of
+        /// neighbour accesses.
+        static double neighbourDistance(const UnstructuredGrid& grid);
+
+    private:
+        CellRenumbering(const CellRenumbering&);
+        CellRenumbering& operator=(const CellRenumbering&);
+
+        void computeHilbertOrder(const UnstructuredGrid& grid);
+        void computeRcmOrder(const UnstructuredGrid& grid);
+        void buildGrid(const UnstructuredGrid& grid);
+
+        const UnstructuredGrid* original_;
+        UnstructuredGrid* renumbered_;
+        std::vector<int> new_to_old_;
+        std::vector<int> old_to_new_;
+    };
+
+
+    /// Cell data of a grid in the original cell order, i.e. ordered by
+    /// increasing global_cell, with data.size() / number_of_cells
+    /// components per cell. Grids that were not renumbered give back
+    /// the data unchanged.
+    void mapToOriginalOrdering(const UnstructuredGrid& grid,
+                               const std::vector<double>& data,
+                               std::vector<double>& original);
+
+} // namespace Opm
+
+
+#endif // OPM_CELLRENUMBERING_HEADER_INCLUDED
@@ -0,0 +1,109 @@
+/*
+  Copyright 2014 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+#include <opm/polymer/CellStencil.hpp>
+#include <vector>
+
+namespace Opm
+{
+
+    namespace
+    {
+
+        struct FaceVisit
+        {
+            int face;
+            int other;
+            bool first;
+        };
+
+        struct CollectFaces
+        {
+            explicit CollectFaces(std::vector<FaceVisit>& faces)
+                : faces_(&faces)
+            {
+            }
+
+            void operator()(const int face, const int other, const bool first) const
+            {
+                const FaceVisit visit = { face, other, first };
+                faces_->push_back(visit);
+            }
+
+            std::vector<FaceVisit>* faces_;
+        };
+
+    } // anonymous namespace
+
+
+
+
+    CellStencil::CellStencil(const UnstructuredGrid& grid)
+        : grid_(grid),
+          cartesian_(false),
+          nx_(grid.cartdims[0]),
+          ny_(grid.cartdims[1]),
+          nz_(grid.dimensions == 3 ? grid.cartdims[2] : 1),
+          nxy_(nx_*ny_),
+          x_faces_((nx_ + 1)*ny_*nz_),
+          y_faces_(nx_*(ny_ + 1)*nz_)
+    {
+        cartesian_ = hasCartesianLayout();
+    }
+
+
+
+
+    bool CellStencil::hasCartesianLayout() const
+    {
+        const int nc = grid_.number_of_cells;
+        if (grid_.dimensions < 2 || grid_.dimensions > 3
+            || nx_ <= 0 || ny_ <= 0 || nz_ <= 0 || nxy_*nz_ != nc) {
+            return false;
+        }
+        const int z_faces = (grid_.dimensions == 3) ? nxy_*(nz_ + 1) : 0;
+        if (grid_.number_of_faces != x_faces_ + y_faces_ + z_faces) {
+            return false;
+        }
+        // Compare the stencil with the neighbour lists, cell by cell.
+        CellStencil cartesian(*this);
+        cartesian.cartesian_ = true;
+        std::vector<FaceVisit> generic_faces;
+        std::vector<FaceVisit> cartesian_faces;
+        for (int cell = 0; cell < nc; ++cell) {
+            generic_faces.clear();
+            cartesian_faces.clear();
+            forEachInteriorFace(cell, CollectFaces(generic_faces));
+            cartesian.forEachInteriorFace(cell, CollectFaces(cartesian_faces));
+            if (generic_faces.size() != cartesian_faces.size()) {
+                return false;
+            }
+            for (std::size_t i = 0; i < generic_faces.size(); ++i) {
+                if (generic_faces[i].face != cartesian_faces[i].face
+                    || generic_faces[i].other != cartesian_faces[i].other
+                    || generic_faces[i].first != cartesian_faces[i].first) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+} // namespace Opm
@@ -0,0 +1,99 @@
+/*
+  Copyright 2014 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_CELLSTENCIL_HEADER_INCLUDED
+#define OPM_CELLSTENCIL_HEADER_INCLUDED
+
+#include <opm/core/grid.h>
+
+namespace Opm
+{
+
+    /// @brief Interior face neighbourhood of the cells of a grid.
+    ///
+    /// For a grid with the layout of a Cartesian grid from
+    /// GridManager(nx, ny, nz, dx, dy, dz) the faces and neighbours of
+    /// a cell are computed from its (i, j, k) index with a 5- or
+    /// 7-point stencil, without reading cell_facepos, cell_faces or
+    /// face_cells. The layout is verified once at construction,
+    /// including the face order of each cell, so the Cartesian path
+    /// visits exactly the same faces in the same order as the generic
+    /// one. Any other grid, e.g. a corner-point or renumbered grid,
+    /// uses the generic neighbour lists.
+    class CellStencil
+    {
+    public:
+        /// Construct for a grid, detecting Cartesian layout.
+        explicit CellStencil(const UnstructuredGrid& grid);
+
+        /// True if the Cartesian stencil is used.
+        bool isCartesian() const
+        {
+            return cartesian_;
+        }
+
+        /// Call visit(face, other, first) for each interior face of a
+        /// cell, in the order of the cell's cell_faces. other is the
+        /// neighbour cell and first is true if cell is
+        /// face_cells[2*face], i.e. a positive face flux leaves cell.
+        template <class Visitor>
+        void forEachInteriorFace(const int cell, Visitor visit) const
+        {
+            if (cartesian_) {
+                const int i = cell % nx_;
+                const int j = (cell / nx_) % ny_;
+                const int k = cell / nxy_;
+                const int xf = i + (nx_ + 1)*(j + ny_*k);
+                const int yf = x_faces_ + i + nx_*(j + (ny_ + 1)*k);
+                const int zf = x_faces_ + y_faces_ + cell;
+                if (i > 0)       visit(xf,           cell - 1,   false);
+                if (i < nx_ - 1) visit(xf + 1,       cell + 1,   true);
+                if (j > 0)       visit(yf,           cell - nx_, false);
+                if (j < ny_ - 1) visit(yf + nx_,     cell + nx_, true);
+                if (k > 0)       visit(zf,           cell - nxy_, false);
+                if (k < nz_ - 1) visit(zf + nxy_,    cell + nxy_, true);
+                return;
+            }
+            for (int pos = grid_.cell_facepos[cell]; pos < grid_.cell_facepos[cell + 1]; ++pos) {
+                const int f = grid_.cell_faces[pos];
+                const bool first = (cell == grid_.face_cells[2*f]);
+                const int other = grid_.face_cells[2*f + (first ? 1 : 0)];
+                if (other != -1) {
+                    visit(f, other, first);
+                }
+            }
+        }
+
+    private:
+        bool hasCartesianLayout() const;
+
+        const UnstructuredGrid& grid_;
+        bool cartesian_;
+        int nx_;
+        int ny_;
+        int nz_;
+        int nxy_;
+        int x_faces_;
+        int y_faces_;
+    };
+
+} // namespace Opm
+
+
+#endif // OPM_CELLSTENCIL_HEADER_INCLUDED
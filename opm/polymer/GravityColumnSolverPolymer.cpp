@@ -0,0 +1,35 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#include <opm/polymer/GravityColumnSolverPolymer.hpp>
+#include <opm/polymer/SinglePointUpwindTwoPhasePolymer.hpp>
+#include <opm/polymer/TwophaseFluidPolymer.hpp>
+#include <opm/polymer/PolymerProperties.hpp>
+
+namespace Opm
+{
+
+    // Instantiate for the flux model used by the implicit transport
+    // solver, so that the column solver is compiled with the library.
+    template class GravityColumnSolverPolymer<SinglePointUpwindTwoPhasePolymer<TwophaseFluidPolymer>,
+                                              PolymerProperties>;
+
+} // namespace Opm
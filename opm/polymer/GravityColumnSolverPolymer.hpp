@@ -21,6 +21,8 @@
 #define OPM_GRAVITYCOLUMNSOLVERPOLYMER_HEADER_INCLUDED
 
 #include <opm/core/grid.h>
+#include <opm/polymer/GravityColumns.hpp>
+#include <opm/polymer/ScratchBuffer.hpp>
 #include <vector>
 #include <map>
 
@@ -41,30 +43,52 @@ namespace Opm
                                    const double tol,
                                    const int maxit);
 
-	/// \param[in] columns         for each column (with logical cartesian indices as key),
-	///                            contains the cells on which to solve the segregation
+	/// \param[in] columns         the cells on which to solve the segregation
 	///                            problem. For each column, its cells must be in a single
 	///                            vertical column, and ordered
 	///                            (direction doesn't matter).
-	void solve(const std::vector<std::vector<int> >& columns,
+	void solve(const GravityColumns& columns,
 		   const double dt,
 		   std::vector<double>& s,
 		   std::vector<double>& c,
 		   std::vector<double>& cmax);
 
+	/// Number of scratch buffer allocations made so far. The buffers
+	/// depend on the number and length of the columns, so they are
+	/// sized by the first solve() and only grow when a later call has
+	/// more or longer columns.
+	int scratchAllocations() const;
+
     private:
-	void solveSingleColumn(const std::vector<int>& column_cells,
+	void solveSingleColumn(const int col_size,
+			       const int* column_cells,
 			       const double dt,
 			       std::vector<double>& s,
 			       std::vector<double>& c,
 			       std::vector<double>& cmax,
-			       std::vector<double>& sol_vec
- 			       );
+			       std::vector<double>& sol_vec);
+	double updateColumn(const int col_size,
+			    const int* column_cells,
+			    const std::vector<double>& s,
+			    const std::vector<double>& c,
+			    const double cmax_cell,
+			    const double tol_c_cell,
+			    std::vector<double>& increment,
+			    std::vector<double>& solution) const;
 	FluxModel& fmodel_;
         const Model& model_;
 	const UnstructuredGrid& grid_;
 	const double tol_;
 	const int maxit_;
+	// Scratch storage, reused across calls.
+	std::vector<double> sol_;
+	std::vector<double> increment_;
+	std::vector<int> column_cells_;
+	ScratchBuffer<int> active_;
+	ScratchBuffer<int> next_active_;
+	ScratchBuffer<double> hm_;
+	ScratchBuffer<double> rhs_;
+	ScratchBuffer<int> ipiv_;
 };
 
 } // namespace Opm
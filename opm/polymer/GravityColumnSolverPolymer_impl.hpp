@@ -39,8 +39,10 @@
 #include <opm/polymer/GravityColumnSolverPolymer.hpp>
 #include <opm/core/linalg/blas_lapack.h>
 #include <opm/core/utility/ErrorMacros.hpp>
+#include <opm/polymer/PolymerLog.hpp>
 #include <iterator>
 #include <iostream>
+#include <cassert>
 #include <cmath>
 #include <algorithm>
 
@@ -53,8 +55,21 @@ namespace Opm
                                                                              const UnstructuredGrid& grid,
                                                                              const double tol,
                                                                              const int maxit)
-	: fmodel_(fmodel), model_(model), grid_(grid), tol_(tol), maxit_(maxit)
+	: fmodel_(fmodel), model_(model), grid_(grid), tol_(tol), maxit_(maxit),
+	  sol_(2*grid.number_of_cells, 0.0),
+	  increment_(2*grid.number_of_cells, 0.0)
     {
+	column_cells_.reserve(grid.number_of_cells);
+    }
+
+
+
+
+    template <class FluxModel, class Model>
+    int GravityColumnSolverPolymer<FluxModel, Model>::scratchAllocations() const
+    {
+	return active_.allocations() + next_active_.allocations() + hm_.allocations()
+	    + rhs_.allocations() + ipiv_.allocations();
     }
 
     namespace {
@@ -80,14 +95,14 @@ namespace Opm
 
 	struct Vecs
 	{
-	    Vecs(int sz) : sol(sz, 0.0) {}
+	    Vecs(std::vector<double>& s) : sol(s) {}
 	    const std::vector<double>& solution() const { return sol; }
 	    std::vector<double>& writableSolution() { return sol; }
-	    std::vector<double> sol;
+	    std::vector<double>& sol;
 	};
 	struct JacSys
 	{
-	    JacSys(int sz) : v(sz) {}
+	    JacSys(std::vector<double>& sol) : v(sol) {}
 	    const Vecs& vector() const { return v; }
 	    Vecs& vector() { return v; }
 	    Vecs v;
@@ -116,13 +131,12 @@ namespace Opm
 
 
 
-    /// \param[in] columns         for each column col, columns[col]
-    ///                            contains the cells on which to solve the segregation
+    /// \param[in] columns         the cells on which to solve the segregation
     ///                            problem. For each column, its cells must be in a single
     ///                            vertical column, connected and ordered
     ///                            (direction doesn't matter).
     template <class FluxModel, class Model>
-    void GravityColumnSolverPolymer<FluxModel, Model>::solve(const std::vector<std::vector<int> >& columns,
+    void GravityColumnSolverPolymer<FluxModel, Model>::solve(const GravityColumns& columns,
 						  const double dt,
 						  std::vector<double>& s,
 						  std::vector<double>& c,
@@ -131,97 +145,57 @@ namespace Opm
     {
 	// Initialize model. These things are done for the whole grid!
 	StateWithZeroFlux state(s, c, cmax); // This holds s, c and cmax by reference.
-	JacSys sys(2*grid_.number_of_cells);
-	std::vector<double> increment(2*grid_.number_of_cells, 0.0);
+	JacSys sys(sol_); // This holds the solution by reference.
+	std::fill(increment_.begin(), increment_.end(), 0.0);
 	fmodel_.initStep(state, grid_, sys);
 
+	// Columns still iterating. A column leaves the active set once its
+	// own update is below tolerance; since columns do not interact, it
+	// is then converged for this solve. Segregated columns at gravity
+	// equilibrium have a zero residual and never reach the band solver.
+	const int num_columns = columns.numColumns();
+	int* active = active_.get(num_columns);
+	int* next_active = next_active_.get(num_columns);
+	int num_active = num_columns;
+	for (int i = 0; i < num_columns; ++i) {
+	    active[i] = i;
+	}
+
 	int iter = 0;
 	double max_delta = 1e100;
         const double cmax_cell = 2.0*model_.cMax();
         const double tol_c_cell = 1e-2*cmax_cell; 
-	while (iter < maxit_) {
-	    fmodel_.initIteration(state, grid_, sys);
-            int size = columns.size();
-            for(int i = 0; i < size; ++i) {
-		solveSingleColumn(columns[i], dt, s, c, cmax, increment);
+	while (num_active > 0 && iter < maxit_) {
+	    // Only the active column cells need their mobilities etc. refreshed.
+	    column_cells_.clear();
+	    for (int i = 0; i < num_active; ++i) {
+		const int* col = columns.columnCells(active[i]);
+		column_cells_.insert(column_cells_.end(), col, col + columns.columnSize(active[i]));
 	    }
-	    for (int cell = 0; cell < grid_.number_of_cells; ++cell) {
-                double& s_cell = sys.vector().writableSolution()[2*cell + 0];
-                double& c_cell = sys.vector().writableSolution()[2*cell + 1];
-		s_cell += increment[2*cell + 0];
-		c_cell += increment[2*cell + 1];
-                if (s_cell < 0.) {
-                    double& incr = increment[2*cell + 0];
-                    s_cell -=  incr;
-                    if (std::fabs(incr) < 1e-2) {
-                        incr = -s_cell;
-                        s_cell = 0.;
-                    } else {
-                        incr = -s_cell/2.0;
-                        s_cell = s_cell/2.0;
-                    }
-                }
-                if (s_cell > 1.) {
-                    double& incr = increment[2*cell + 0];
-                    s_cell -=  incr;
-                    if (std::fabs(incr) < 1e-2) {
-                        incr = 1. - s_cell;
-                        s_cell = 1.;
-                    } else {
-                        incr = (1 - s_cell)/2.0;
-                        s_cell = (1 + s_cell)/2.0;
-                    }
-                }
-                if (c_cell < 0.) {
-                    double& incr = increment[2*cell + 1];
-                    c_cell -=  incr;
-                    if (std::fabs(incr) < tol_c_cell) {
-                        incr = -c_cell;
-                        c_cell = 0.;
-                    } else {
-                        incr = -c_cell/2.0;
-                        c_cell = c_cell/2.0;
-                    }
-                }
-                if (c_cell > cmax_cell) {
-                    double& incr = increment[2*cell + 1];
-                    c_cell -=  incr;
-                    if (std::fabs(incr) < tol_c_cell) {
-                        incr = cmax_cell - c_cell;
-                        c_cell = cmax_cell;
-                    } else {
-                        incr = (cmax_cell - c_cell)/2.0;
-                        c_cell = (cmax_cell + c_cell)/2.0;
-                    }
-                }
-                
-                // if (s_cell < 0.) {
-                //     increment[2*cell + 0] = increment[2*cell + 0] - s_cell;
-                //     s_cell = 0.;
-                // } else if (s_cell > 1.) {
-                //     increment[2*cell + 0] = increment[2*cell + 0] - s_cell + 1.;
-                //     s_cell = 1.;
-                // }
-                // if (c_cell < 0) {
-                //     increment[2*cell + 1] = increment[2*cell + 1] - c_cell;
-                //     c_cell = 0.;
-                // } else if (c_cell > cmax_cell) {
-                //     increment[2*cell + 1] = increment[2*cell + 1] - c_cell + cmax_cell;
-                //     c_cell = cmax_cell;
-                // }
-	    } 
-	    const double maxelem = *std::max_element(increment.begin(), increment.end());
-	    const double minelem = *std::min_element(increment.begin(), increment.end());
-	    max_delta = std::max(maxelem, -minelem);
-	    std::cout << "Iteration " << iter << "   max_delta = " << max_delta << std::endl;
-	    if (max_delta < tol_) {
-		break;
+	    fmodel_.initIteration(state, grid_, sys, column_cells_);
+	    max_delta = 0.0;
+	    int num_next_active = 0;
+            for (int i = 0; i < num_active; ++i) {
+		const int col_size = columns.columnSize(active[i]);
+		const int* column = columns.columnCells(active[i]);
+		solveSingleColumn(col_size, column, dt, s, c, cmax, increment_);
+		const double col_delta = updateColumn(col_size, column, s, c, cmax_cell, tol_c_cell,
+						      increment_, sys.vector().writableSolution());
+		max_delta = std::max(max_delta, col_delta);
+		if (col_delta >= tol_) {
+		    next_active[num_next_active++] = active[i];
+		}
 	    }
+	    OPM_POLYMER_LOG_DEBUG("Iteration " << iter << "   max_delta = " << max_delta
+				  << "   active columns = " << num_next_active);
+	    std::swap(active, next_active);
+	    num_active = num_next_active;
 	    ++iter;
 	}
-	if (max_delta >= tol_) {
+	if (num_active > 0) {
 	    OPM_THROW(std::runtime_error, "Failed to converge!");
 	}
+	OPM_POLYMER_LOG_DEBUG("Scratch allocations: " << scratchAllocations());
 	// Finalize.
 	// fmodel_.finishIteration(); //
 	// finishStep() writes to state, which holds s by reference.
@@ -232,11 +206,88 @@ namespace Opm
 
 
 
+    /// Apply the Newton increment of one column, chopped to keep s in
+    /// [0, 1] and c in [0, cmax_cell], and return its largest entry.
+    /// The solution holds the change from the start-of-step values s
+    /// and c, so the bounds apply to the start value plus the change.
+    template <class FluxModel, class Model>
+    double GravityColumnSolverPolymer<FluxModel, Model>::updateColumn(const int col_size,
+                                                                      const int* column_cells,
+                                                                      const std::vector<double>& s,
+                                                                      const std::vector<double>& c,
+                                                                      const double cmax_cell,
+                                                                      const double tol_c_cell,
+                                                                      std::vector<double>& increment,
+                                                                      std::vector<double>& solution) const
+    {
+	double max_delta = 0.0;
+	for (int ci = 0; ci < col_size; ++ci) {
+	    const int cell = column_cells[ci];
+	    double& ds_cell = solution[2*cell + 0];
+	    double& dc_cell = solution[2*cell + 1];
+	    const double s0 = s[2*cell + 0];
+	    const double c0 = c[cell];
+	    ds_cell += increment[2*cell + 0];
+	    dc_cell += increment[2*cell + 1];
+	    if (s0 + ds_cell < 0.) {
+		double& incr = increment[2*cell + 0];
+		ds_cell -=  incr;
+		const double s_cell = s0 + ds_cell;
+		if (std::fabs(incr) < 1e-2) {
+		    incr = -s_cell;
+		} else {
+		    incr = -s_cell/2.0;
+		}
+		ds_cell += incr;
+	    }
+	    if (s0 + ds_cell > 1.) {
+		double& incr = increment[2*cell + 0];
+		ds_cell -=  incr;
+		const double s_cell = s0 + ds_cell;
+		if (std::fabs(incr) < 1e-2) {
+		    incr = 1. - s_cell;
+		} else {
+		    incr = (1 - s_cell)/2.0;
+		}
+		ds_cell += incr;
+	    }
+	    if (c0 + dc_cell < 0.) {
+		double& incr = increment[2*cell + 1];
+		dc_cell -=  incr;
+		const double c_cell = c0 + dc_cell;
+		if (std::fabs(incr) < tol_c_cell) {
+		    incr = -c_cell;
+		} else {
+		    incr = -c_cell/2.0;
+		}
+		dc_cell += incr;
+	    }
+	    if (c0 + dc_cell > cmax_cell) {
+		double& incr = increment[2*cell + 1];
+		dc_cell -=  incr;
+		const double c_cell = c0 + dc_cell;
+		if (std::fabs(incr) < tol_c_cell) {
+		    incr = cmax_cell - c_cell;
+		} else {
+		    incr = (cmax_cell - c_cell)/2.0;
+		}
+		dc_cell += incr;
+	    }
+	    max_delta = std::max(max_delta, std::fabs(increment[2*cell + 0]));
+	    max_delta = std::max(max_delta, std::fabs(increment[2*cell + 1]));
+	}
+	return max_delta;
+    }
+
+
+
+
     /// \param[in] column_cells    the cells on which to solve the segregation
     ///                            problem. Must be in a single vertical column,
     ///                            and ordered (direction doesn't matter).
     template <class FluxModel, class Model>
-    void GravityColumnSolverPolymer<FluxModel, Model>::solveSingleColumn(const std::vector<int>& column_cells,
+    void GravityColumnSolverPolymer<FluxModel, Model>::solveSingleColumn(const int col_size,
+                                                              const int* column_cells,
                                                               const double dt,
                                                               std::vector<double>& s,
                                                               std::vector<double>& c,
@@ -245,7 +296,6 @@ namespace Opm
     {
 	// This is written only to work with SinglePointUpwindTwoPhase,
 	// not with arbitrary problem models.
-        int col_size = column_cells.size();
 
         // if (col_size == 1) {
 	//     sol_vec[2*column_cells[0] + 0] = 0.0;
@@ -260,16 +310,18 @@ namespace Opm
         const int ku = 3;
         const int nrow = 2*kl + ku + 1;
         const int N = 2*col_size; // N unknowns: s and c for each cell.
-	std::vector<double> hm(nrow*N, 0.0); // band matrix with 3 upper and 3 lower diagonals.
-	std::vector<double> rhs(N, 0.0);
+	double* hm = hm_.get(nrow*N); // band matrix with 3 upper and 3 lower diagonals.
+	double* rhs = rhs_.get(N);
+	std::fill(hm, hm + nrow*N, 0.0);
+	std::fill(rhs, rhs + N, 0.0);
         const BandMatrixCoeff bmc(N, ku, kl);
 
 
 	for (int ci = 0; ci < col_size; ++ci) {
-	    std::vector<double> F(2, 0.);
-	    std::vector<double> dFd1(4, 0.);
-	    std::vector<double> dFd2(4, 0.);
-	    std::vector<double> dF(4, 0.);
+	    double F[2];
+	    double dFd1[4];
+	    double dFd2[4];
+	    double dF[4];
 	    const int cell = column_cells[ci];
 	    const int prev_cell = (ci == 0) ? -999 : column_cells[ci - 1];
 	    const int next_cell = (ci == col_size - 1) ? -999 : column_cells[ci + 1];
@@ -279,10 +331,10 @@ namespace Opm
 		const int c1 = grid_.face_cells[2*face + 0];
                 const int c2 = grid_.face_cells[2*face + 1];
 		if (c1 == prev_cell || c2 == prev_cell || c1 == next_cell || c2 == next_cell) {
-                    F.assign(2, 0.);
-                    dFd1.assign(4, 0.);
-                    dFd2.assign(4, 0.);
-		    fmodel_.fluxConnection(state, grid_, dt, cell, face, &F[0], &dFd1[0], &dFd2[0]);
+                    std::fill(F, F + 2, 0.);
+                    std::fill(dFd1, dFd1 + 4, 0.);
+                    std::fill(dFd2, dFd2 + 4, 0.);
+		    fmodel_.fluxConnection(state, grid_, dt, cell, face, F, dFd1, dFd2);
 		    if (c1 == prev_cell || c2 == prev_cell) {
                         hm[bmc(2*ci + 0, 2*(ci - 1) + 0)] += dFd2[0];
                         hm[bmc(2*ci + 0, 2*(ci - 1) + 1)] += dFd2[1];
@@ -304,9 +356,9 @@ namespace Opm
 		    rhs[2*ci + 1] += F[1];
 		}
 	    }
-	    F.assign(2, 0.);
-            dF.assign(4, 0.);
-	    fmodel_.accumulation(grid_, cell, &F[0], &dF[0]);
+	    std::fill(F, F + 2, 0.);
+            std::fill(dF, dF + 4, 0.);
+	    fmodel_.accumulation(grid_, cell, F, dF);
             hm[bmc(2*ci + 0, 2*ci + 0)] += dF[0];
             hm[bmc(2*ci + 0, 2*ci + 1)] += dF[1];
             hm[bmc(2*ci + 1, 2*ci + 0)] += dF[2];
@@ -321,15 +373,30 @@ namespace Opm
 
 	}
 	// model_.sourceTerms(); // Not needed
+	// Skip columns without driving force, such as segregated columns
+	// at gravity equilibrium: a zero residual gives a zero Newton
+	// update. Any other column takes the update, and the increment
+	// check in solve() decides whether it stays active.
+	bool zero_residual = true;
+	for (int i = 0; i < N; ++i) {
+	    zero_residual = zero_residual && rhs[i] == 0.0;
+	}
+	if (zero_residual) {
+	    for (int ci = 0; ci < col_size; ++ci) {
+		sol_vec[2*column_cells[ci] + 0] = 0.0;
+		sol_vec[2*column_cells[ci] + 1] = 0.0;
+	    }
+	    return;
+	}
 	// Solve.
 	const int num_rhs = 1;
 	int info = 0;
-        std::vector<int> ipiv(N, 0);
+        int* ipiv = ipiv_.get(N);
 	// Solution will be written to rhs.
-        dgbsv_(&N, &kl, &ku, &num_rhs, &hm[0], &nrow, &ipiv[0], &rhs[0], &N, &info);
+        dgbsv_(&N, &kl, &ku, &num_rhs, hm, &nrow, ipiv, rhs, &N, &info);
 	if (info != 0) {
             std::cerr << "Failed column cells: ";
-            std::copy(column_cells.begin(), column_cells.end(), std::ostream_iterator<int>(std::cerr, " "));
+            std::copy(column_cells, column_cells + col_size, std::ostream_iterator<int>(std::cerr, " "));
             std::cerr << "\n";
 	    OPM_THROW(std::runtime_error, "Lapack reported error in dgtsv: " << info);
 	}
@@ -0,0 +1,145 @@
+/*
+  Copyright 2014 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+#include <opm/polymer/GravityColumns.hpp>
+#include <opm/core/grid.h>
+#include <opm/core/grid/ColumnExtract.hpp>
+#include <algorithm>
+#include <utility>
+
+namespace Opm
+{
+
+    GravityColumns::GravityColumns()
+        : offsets_(1, 0),
+          max_size_(0)
+    {
+    }
+
+
+
+
+    GravityColumns::GravityColumns(const UnstructuredGrid& grid)
+        : max_size_(0)
+    {
+        std::vector<std::vector<int> > columns;
+        extractColumn(grid, columns);
+        init(columns);
+    }
+
+
+
+
+    GravityColumns::GravityColumns(const std::vector<std::vector<int> >& columns)
+        : max_size_(0)
+    {
+        init(columns);
+    }
+
+
+
+
+    int GravityColumns::numColumns() const
+    {
+        return offsets_.size() - 1;
+    }
+
+
+
+
+    int GravityColumns::columnSize(const int col) const
+    {
+        return offsets_[col + 1] - offsets_[col];
+    }
+
+
+
+
+    int GravityColumns::maxColumnSize() const
+    {
+        return max_size_;
+    }
+
+
+
+
+    const int* GravityColumns::columnCells(const int col) const
+    {
+        return cells_.empty() ? 0 : &cells_[0] + offsets_[col];
+    }
+
+
+
+
+    int GravityColumns::numCells() const
+    {
+        return cells_.size();
+    }
+
+
+
+
+    const std::vector<int>& GravityColumns::offsets() const
+    {
+        return offsets_;
+    }
+
+
+
+
+    const std::vector<int>& GravityColumns::cells() const
+    {
+        return cells_;
+    }
+
+
+
+
+    void GravityColumns::init(const std::vector<std::vector<int> >& columns)
+    {
+        // Order the (nonempty) columns by smallest cell.
+        std::vector<std::pair<int, int> > order;
+        order.reserve(columns.size());
+        int total = 0;
+        for (std::size_t col = 0; col < columns.size(); ++col) {
+            if (columns[col].empty()) {
+                continue;
+            }
+            const int first = *std::min_element(columns[col].begin(), columns[col].end());
+            order.push_back(std::make_pair(first, int(col)));
+            total += columns[col].size();
+        }
+        std::sort(order.begin(), order.end());
+
+        offsets_.clear();
+        offsets_.reserve(order.size() + 1);
+        offsets_.push_back(0);
+        cells_.clear();
+        cells_.reserve(total);
+        max_size_ = 0;
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            const std::vector<int>& column = columns[order[i].second];
+            cells_.insert(cells_.end(), column.begin(), column.end());
+            offsets_.push_back(cells_.size());
+            max_size_ = std::max(max_size_, int(column.size()));
+        }
+    }
+
+} // namespace Opm
@@ -0,0 +1,80 @@
+/*
+  Copyright 2014 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_GRAVITYCOLUMNS_HEADER_INCLUDED
+#define OPM_GRAVITYCOLUMNS_HEADER_INCLUDED
+
+#include <vector>
+
+struct UnstructuredGrid;
+
+namespace Opm
+{
+
+    /// @brief Vertical cell columns for gravity segregation solvers,
+    /// stored in compressed (CSR) form: the cells of column i are
+    /// cells()[offsets()[i]] ... cells()[offsets()[i + 1] - 1], ordered
+    /// along the column. Columns are sorted by their smallest cell
+    /// index, so that a sweep over the columns in order accesses the
+    /// cell data roughly sequentially.
+    class GravityColumns
+    {
+    public:
+        /// Construct without columns.
+        GravityColumns();
+
+        /// Construct from the columns of a grid (see extractColumn()).
+        explicit GravityColumns(const UnstructuredGrid& grid);
+
+        /// Construct from given columns, each ordered along the column.
+        explicit GravityColumns(const std::vector<std::vector<int> >& columns);
+
+        /// Number of columns.
+        int numColumns() const;
+
+        /// Number of cells in a column, e.g. for load balancing.
+        int columnSize(const int col) const;
+
+        /// Largest number of cells in any column.
+        int maxColumnSize() const;
+
+        /// First cell of a column; the column's cells follow contiguously.
+        const int* columnCells(const int col) const;
+
+        /// Total number of cells in all columns.
+        int numCells() const;
+
+        /// Column start positions, numColumns() + 1 entries.
+        const std::vector<int>& offsets() const;
+
+        /// Cells of all columns.
+        const std::vector<int>& cells() const;
+
+    private:
+        void init(const std::vector<std::vector<int> >& columns);
+
+        std::vector<int> offsets_;
+        std::vector<int> cells_;
+        int max_size_;
+    };
+
+} // namespace Opm
+
+
+#endif // OPM_GRAVITYCOLUMNS_HEADER_INCLUDED
@@ -0,0 +1,140 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_IMPLICITTRANSPORTSOLVERPOLYMER_HEADER_INCLUDED
+#define OPM_IMPLICITTRANSPORTSOLVERPOLYMER_HEADER_INCLUDED
+
+#include <opm/core/grid.h>
+#include <vector>
+
+namespace Opm
+{
+
+    class LinearSolverInterface;
+
+    /// Class for solving the polymer transport equations implicitly
+    /// on the whole grid at once, as an alternative to the reordering
+    /// solver when capillarity or counter-current flow couple large
+    /// parts of the grid. Each Newton iteration assembles the residual
+    /// and 2x2 cell Jacobian blocks of the flux model (usually
+    /// SinglePointUpwindTwoPhasePolymer) into one sparse system in
+    /// CSR format, which is handed to the linear solver.
+    ///
+    /// Assembly is done in two passes, both parallel with OpenMP: the
+    /// flux model is evaluated once per interior face into per-face
+    /// storage, then each cell gathers its face terms, accumulation
+    /// and sources into its own rows. No two threads write the same
+    /// entry, so no atomics or face colouring are needed.
+    template <class FluxModel, class Model>
+    class ImplicitTransportSolverPolymer
+    {
+    public:
+	/// Note: the model will be changed since it stores computed
+	/// quantities in itself, such as mobilities.
+	/// \param[in] fmodel     Flux model, with half-transmissibilities initialised.
+	/// \param[in] model      Polymer properties (for cMax()).
+	/// \param[in] grid       A 2d or 3d grid.
+	/// \param[in] linsolver  Linear solver, must handle nonsymmetric systems.
+	/// \param[in] tol        Tolerance for the pore volume scaled residual.
+	/// \param[in] maxit      Maximum number of Newton iterations.
+	ImplicitTransportSolverPolymer(FluxModel& fmodel,
+                                       const Model& model,
+                                       const UnstructuredGrid& grid,
+                                       const LinearSolverInterface& linsolver,
+                                       const double tol,
+                                       const int maxit);
+
+	/// Solve for saturation, concentration and cmax at next timestep.
+	/// Same interface as TransportSolverTwophasePolymer::solve().
+	/// \param[in] darcyflux           Array of signed face fluxes.
+	/// \param[in] porevolume          Array of pore volumes.
+	/// \param[in] source              Transport source term, to be interpreted by sign:
+        ///                                 (+) Inflow, value is first phase flow (water)
+        ///                                     per second, in reservoir volumes.
+        ///                                 (-) Outflow, value is total flow of all phases
+        ///                                     per second, in reservoir volumes.
+	/// \param[in] polymer_inflow_c    Array of inflow polymer concentrations per cell.
+	/// \param[in] dt                  Time step.
+	/// \param[in, out] saturation     Phase saturations.
+	/// \param[in, out] concentration  Polymer concentration.
+	/// \param[in, out] cmax           Highest concentration that has occured in a given cell.
+	void solve(const double* darcyflux,
+                   const double* porevolume,
+		   const double* source,
+                   const double* polymer_inflow_c,
+		   const double dt,
+		   std::vector<double>& saturation,
+                   std::vector<double>& concentration,
+                   std::vector<double>& cmax);
+
+        /// Newton iterations used in the last call to solve().
+        int newtonIterations() const;
+
+        /// Linear iterations used in the last call to solve().
+        int linearIterations() const;
+
+        /// Time (in seconds) spent assembling in the last call to solve().
+        double assemblyTime() const;
+
+    private:
+        template <class State, class Sources>
+        void assemble(const State& state,
+                      const Sources& src,
+                      const std::vector<double>& x,
+                      const double* porevolume,
+                      const double dt);
+        void addBlock(const int cell, const int pos, const double* J);
+
+	FluxModel& fmodel_;
+        const Model& model_;
+	const UnstructuredGrid& grid_;
+        const LinearSolverInterface& linsolver_;
+	const double tol_;
+	const int maxit_;
+        int newton_its_;
+        int linear_its_;
+        double assembly_time_;
+
+        // Sparsity pattern of the scalar system. Rows 2*c and 2*c + 1
+        // hold the s- and c-equations of cell c, with one 2x2 block
+        // per neighbour (including c itself) in increasing cell order.
+        std::vector<int> ia_;
+        std::vector<int> ja_;
+        std::vector<double> sa_;
+        std::vector<double> rhs_;
+        std::vector<double> dx_;
+        // Block position of the diagonal for each cell, and of the
+        // neighbour across each half-face (-1 for boundary faces).
+        std::vector<int> diag_pos_;
+        std::vector<int> hf_pos_;
+        // Interior faces, and per face the flux model's residual (2 values)
+        // and Jacobian (dFd0 and dFd1, 8 values) of the face_cells[2*f]
+        // side. Only interior faces are filled.
+        std::vector<int> faces_;
+        std::vector<double> face_F_;
+        std::vector<double> face_J_;
+        // Source index of each cell, -1 if none.
+        std::vector<int> cell_src_;
+};
+
+} // namespace Opm
+
+#include <opm/polymer/ImplicitTransportSolverPolymer_impl.hpp>
+
+#endif // OPM_IMPLICITTRANSPORTSOLVERPOLYMER_HEADER_INCLUDED
@@ -0,0 +1,349 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <opm/polymer/ImplicitTransportSolverPolymer.hpp>
+#include <opm/core/linalg/LinearSolverInterface.hpp>
+#include <opm/core/utility/ErrorMacros.hpp>
+#include <opm/core/utility/StopWatch.hpp>
+#include <opm/polymer/PolymerLog.hpp>
+#include <cmath>
+#include <algorithm>
+
+namespace Opm
+{
+
+    namespace ImplicitTransportPolymerDetails
+    {
+	struct State
+	{
+	    State(const double* flux, std::vector<double>& s, std::vector<double>& c, std::vector<double>& cmax_arg)
+                : dflux(flux), sat(s), cpoly(c), cmax(cmax_arg) {}
+	    const double* faceflux() const { return dflux; }
+	    const std::vector<double>& saturation() const { return sat; }
+	    std::vector<double>& saturation() { return sat; }
+	    const std::vector<double>& concentration() const { return cpoly; }
+	    std::vector<double>& concentration() { return cpoly; }
+	    const std::vector<double>& maxconcentration() const { return cmax; }
+	    std::vector<double>& maxconcentration() { return cmax; }
+	    const double* dflux;
+	    std::vector<double>& sat;
+	    std::vector<double>& cpoly;
+	    std::vector<double>& cmax;
+	};
+
+	struct Vecs
+	{
+	    Vecs(int sz) : sol(sz, 0.0) {}
+	    const std::vector<double>& solution() const { return sol; }
+	    std::vector<double>& writableSolution() { return sol; }
+	    std::vector<double> sol;
+	};
+	struct JacSys
+	{
+	    JacSys(int sz) : v(sz) {}
+	    const Vecs& vector() const { return v; }
+	    Vecs& vector() { return v; }
+	    Vecs v;
+	    typedef std::vector<double> vector_type;
+	};
+
+        // Cell sources in the form expected by the flux model's
+        // sourceTerms() and polymerSourceTerms().
+        struct Sources
+        {
+            std::vector<int> cell;
+            std::vector<double> flux;
+            std::vector<double> saturation;
+            std::vector<double> concentration;
+        };
+
+    } // namespace ImplicitTransportPolymerDetails
+
+
+
+
+    template <class FluxModel, class Model>
+    ImplicitTransportSolverPolymer<FluxModel, Model>::ImplicitTransportSolverPolymer(FluxModel& fmodel,
+                                                                                     const Model& model,
+                                                                                     const UnstructuredGrid& grid,
+                                                                                     const LinearSolverInterface& linsolver,
+                                                                                     const double tol,
+                                                                                     const int maxit)
+	: fmodel_(fmodel), model_(model), grid_(grid), linsolver_(linsolver),
+          tol_(tol), maxit_(maxit), newton_its_(0), linear_its_(0), assembly_time_(0.0)
+    {
+        const int nc = grid.number_of_cells;
+        ia_.resize(2*nc + 1);
+        ia_[0] = 0;
+        diag_pos_.resize(nc);
+        hf_pos_.assign(grid.cell_facepos[nc], -1);
+        std::vector<int> nb;
+        for (int c = 0; c < nc; ++c) {
+            nb.clear();
+            nb.push_back(c);
+            for (int hf = grid.cell_facepos[c]; hf < grid.cell_facepos[c + 1]; ++hf) {
+                const int f = grid.cell_faces[hf];
+                const int other = (grid.face_cells[2*f] == c) ? grid.face_cells[2*f + 1] : grid.face_cells[2*f];
+                if (other >= 0 && other != c) {
+                    nb.push_back(other);
+                }
+            }
+            std::sort(nb.begin(), nb.end());
+            nb.erase(std::unique(nb.begin(), nb.end()), nb.end());
+            diag_pos_[c] = std::lower_bound(nb.begin(), nb.end(), c) - nb.begin();
+            for (int hf = grid.cell_facepos[c]; hf < grid.cell_facepos[c + 1]; ++hf) {
+                const int f = grid.cell_faces[hf];
+                const int other = (grid.face_cells[2*f] == c) ? grid.face_cells[2*f + 1] : grid.face_cells[2*f];
+                if (other >= 0 && other != c) {
+                    hf_pos_[hf] = std::lower_bound(nb.begin(), nb.end(), other) - nb.begin();
+                    if (grid.face_cells[2*f] == c) {
+                        faces_.push_back(f);
+                    }
+                }
+            }
+            for (int row = 0; row < 2; ++row) {
+                for (int k = 0; k < int(nb.size()); ++k) {
+                    ja_.push_back(2*nb[k] + 0);
+                    ja_.push_back(2*nb[k] + 1);
+                }
+                ia_[2*c + row + 1] = ja_.size();
+            }
+        }
+        sa_.resize(ja_.size());
+        rhs_.resize(2*nc);
+        dx_.resize(2*nc);
+        face_F_.resize(2*grid.number_of_faces);
+        face_J_.resize(8*grid.number_of_faces);
+        cell_src_.resize(nc);
+    }
+
+
+
+
+    template <class FluxModel, class Model>
+    void ImplicitTransportSolverPolymer<FluxModel, Model>::solve(const double* darcyflux,
+                                                                 const double* porevolume,
+                                                                 const double* source,
+                                                                 const double* polymer_inflow_c,
+                                                                 const double dt,
+                                                                 std::vector<double>& saturation,
+                                                                 std::vector<double>& concentration,
+                                                                 std::vector<double>& cmax)
+    {
+        using namespace ImplicitTransportPolymerDetails;
+        const int nc = grid_.number_of_cells;
+
+        // Collect the nonzero sources.
+        Sources src;
+        for (int cell = 0; cell < nc; ++cell) {
+            cell_src_[cell] = -1;
+            if (source[cell] != 0.0) {
+                cell_src_[cell] = src.cell.size();
+                src.cell.push_back(cell);
+                src.flux.push_back(source[cell]);
+                src.saturation.push_back(source[cell] > 0.0 ? 1.0 : 0.0);
+                src.saturation.push_back(source[cell] > 0.0 ? 0.0 : 1.0);
+                src.concentration.push_back(source[cell] > 0.0 ? polymer_inflow_c[cell] : 0.0);
+            }
+        }
+
+	State state(darcyflux, saturation, concentration, cmax); // This holds s, c and cmax by reference.
+	JacSys sys(2*nc);
+        fmodel_.setPoreVolume(grid_, porevolume);
+	fmodel_.initStep(state, grid_, sys);
+
+        newton_its_ = 0;
+        linear_its_ = 0;
+        assembly_time_ = 0.0;
+        time::StopWatch clock;
+        const double cmax_cell = 2.0*model_.cMax();
+        const double cscale = model_.cMax() > 0.0 ? model_.cMax() : 1.0;
+        double res = 1e100;
+        while (true) {
+	    fmodel_.initIteration(state, grid_, sys);
+            clock.start();
+            assemble(state, src, sys.vector().solution(), porevolume, dt);
+            clock.stop();
+            assembly_time_ += clock.secsSinceStart();
+
+            res = 0.0;
+            for (int cell = 0; cell < nc; ++cell) {
+                res = std::max(res, std::fabs(rhs_[2*cell + 0]) / porevolume[cell]);
+                res = std::max(res, std::fabs(rhs_[2*cell + 1]) / (porevolume[cell]*cscale));
+            }
+            OPM_POLYMER_LOG_DEBUG("Implicit transport iteration " << newton_its_ << "   residual = " << res);
+            if (res < tol_) {
+                break;
+            }
+            if (newton_its_ == maxit_) {
+                OPM_THROW(std::runtime_error, "Implicit polymer transport failed to converge, residual = " << res);
+            }
+
+            std::fill(dx_.begin(), dx_.end(), 0.0);
+            const LinearSolverInterface::LinearSolverReport rep
+                = linsolver_.solve(2*nc, sa_.size(), &ia_[0], &ja_[0], &sa_[0], &rhs_[0], &dx_[0]);
+            if (!rep.converged) {
+                OPM_THROW(std::runtime_error, "Linear solver failed to converge in implicit polymer transport.");
+            }
+            linear_its_ += rep.iterations;
+            ++newton_its_;
+
+            // Update, keeping s in [0, 1] and c in [0, 2 cmax].
+            std::vector<double>& x = sys.vector().writableSolution();
+            for (int cell = 0; cell < nc; ++cell) {
+                const double s_new = saturation[2*cell] + x[2*cell + 0] - dx_[2*cell + 0];
+                const double c_new = concentration[cell] + x[2*cell + 1] - dx_[2*cell + 1];
+                x[2*cell + 0] = std::min(std::max(s_new, 0.0), 1.0) - saturation[2*cell];
+                x[2*cell + 1] = std::min(std::max(c_new, 0.0), cmax_cell) - concentration[cell];
+            }
+        }
+        OPM_POLYMER_LOG_INFO("Implicit transport converged in " << newton_its_ << " Newton iterations, "
+                             << linear_its_ << " linear iterations, assembly took " << assembly_time_ << " seconds.");
+
+	// finishStep() writes to state, which holds s, c and cmax by reference.
+	fmodel_.finishStep(grid_, sys.vector().solution(), state);
+    }
+
+
+
+
+    template <class FluxModel, class Model>
+    int ImplicitTransportSolverPolymer<FluxModel, Model>::newtonIterations() const
+    {
+        return newton_its_;
+    }
+
+
+
+
+    template <class FluxModel, class Model>
+    int ImplicitTransportSolverPolymer<FluxModel, Model>::linearIterations() const
+    {
+        return linear_its_;
+    }
+
+
+
+
+    template <class FluxModel, class Model>
+    double ImplicitTransportSolverPolymer<FluxModel, Model>::assemblyTime() const
+    {
+        return assembly_time_;
+    }
+
+
+
+
+    template <class FluxModel, class Model>
+    template <class State, class Sources>
+    void ImplicitTransportSolverPolymer<FluxModel, Model>::assemble(const State& state,
+                                                                    const Sources& src,
+                                                                    const std::vector<double>& x,
+                                                                    const double* porevolume,
+                                                                    const double dt)
+    {
+        // Pass 1: face terms, each face writes only its own storage.
+        const int num_faces = faces_.size();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (int i = 0; i < num_faces; ++i) {
+            const int f = faces_[i];
+            fmodel_.fluxFace(state, grid_, dt, f, &face_F_[2*f], &face_J_[8*f], &face_J_[8*f + 4]);
+        }
+
+        // Pass 2: each cell gathers into its own rows.
+        const int nc = grid_.number_of_cells;
+        // Polymer storage per pore volume, d/dc of s c (1 - dps) + adsorption,
+        // below which a cell is treated as holding no polymer.
+        const double degenerate_storage = 1e-10;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (int cell = 0; cell < nc; ++cell) {
+            std::fill(&sa_[ia_[2*cell]], &sa_[0] + ia_[2*cell + 2], 0.0);
+            double F[2] = { 0.0, 0.0 };
+            double J[4];
+            for (int hf = grid_.cell_facepos[cell]; hf < grid_.cell_facepos[cell + 1]; ++hf) {
+                const int pos = hf_pos_[hf];
+                if (pos < 0) {
+                    continue;
+                }
+                const int f = grid_.cell_faces[hf];
+                const double* Ff = &face_F_[2*f];
+                const double* J0 = &face_J_[8*f];
+                const double* J1 = J0 + 4;
+                if (grid_.face_cells[2*f] == cell) {
+                    F[0] += Ff[0];
+                    F[1] += Ff[1];
+                    addBlock(cell, diag_pos_[cell], J0);
+                    addBlock(cell, pos, J1);
+                } else {
+                    F[0] -= Ff[0];
+                    F[1] -= Ff[1];
+                    for (int k = 0; k < 4; ++k) {
+                        J[k] = -J1[k];
+                    }
+                    addBlock(cell, diag_pos_[cell], J);
+                    for (int k = 0; k < 4; ++k) {
+                        J[k] = -J0[k];
+                    }
+                    addBlock(cell, pos, J);
+                }
+            }
+            std::fill(J, J + 4, 0.0);
+            fmodel_.accumulation(grid_, cell, F, J);
+            // Without water and adsorption the c-equation has no
+            // accumulation term, and c is undefined. Such a cell has no
+            // water flowing in at convergence (the s-equation would
+            // raise its saturation), so it keeps its concentration:
+            // the c-equation is replaced by pv (c - c_old) = 0, scaled
+            // like the other rows for the convergence test.
+            const bool no_polymer_storage = J[3] <= degenerate_storage*porevolume[cell];
+            addBlock(cell, diag_pos_[cell], J);
+            if (cell_src_[cell] >= 0) {
+                std::fill(J, J + 4, 0.0);
+                fmodel_.polymerSourceTerms(grid_, &src, cell_src_[cell], dt, J, F);
+                addBlock(cell, diag_pos_[cell], J);
+            }
+            if (no_polymer_storage) {
+                std::fill(&sa_[ia_[2*cell + 1]], &sa_[0] + ia_[2*cell + 2], 0.0);
+                sa_[ia_[2*cell + 1] + 2*diag_pos_[cell] + 1] = porevolume[cell];
+                F[1] = porevolume[cell]*x[2*cell + 1];
+            }
+            rhs_[2*cell + 0] = F[0];
+            rhs_[2*cell + 1] = F[1];
+        }
+    }
+
+
+
+
+    template <class FluxModel, class Model>
+    void ImplicitTransportSolverPolymer<FluxModel, Model>::addBlock(const int cell, const int pos, const double* J)
+    {
+        double* s_row = &sa_[ia_[2*cell + 0] + 2*pos];
+        double* c_row = &sa_[ia_[2*cell + 1] + 2*pos];
+        s_row[0] += J[0];
+        s_row[1] += J[1];
+        c_row[0] += J[2];
+        c_row[1] += J[3];
+    }
+
+} // namespace Opm
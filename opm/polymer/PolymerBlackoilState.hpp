@@ -23,6 +23,7 @@
 
 #include <opm/core/simulator/BlackoilState.hpp>
 #include <opm/core/grid.h>
+#include <algorithm>
 #include <vector>
 
 namespace Opm
@@ -43,6 +44,7 @@ namespace Opm
             state_blackoil_.init(number_of_cells, number_of_faces, num_phases);
             concentration_.resize(number_of_cells, 0.0);
             cmax_.resize(number_of_cells, 0.0);
+            cmax0_.clear();
         }
         int numPhases() const
         {
@@ -70,6 +72,7 @@ namespace Opm
         std::vector<double>& rv          ()     { return state_blackoil_.rv(); }
         std::vector<double>& concentration()    { return concentration_; }
         std::vector<double>& maxconcentration() { return cmax_; }
+        std::vector<double>& prevmaxconcentration() { return cmax0_; }
 
         const std::vector<double>& pressure    () const     { return state_blackoil_.pressure(); }
         const std::vector<double>& temperature () const     { return state_blackoil_.temperature(); }
@@ -81,6 +84,22 @@ namespace Opm
         const std::vector<double>& rv          () const     { return state_blackoil_.rv(); }
         const std::vector<double>& concentration() const    { return concentration_; }
         const std::vector<double>& maxconcentration() const { return cmax_; }
+        const std::vector<double>& prevmaxconcentration() const { return cmax0_; }
+
+        /// Update the max concentration after a converged time step.
+        /// The max concentration the step started from is kept in
+        /// prevmaxconcentration(): together with the concentration it
+        /// gives the adsorption of the step's converged accumulation,
+        /// which the next step must start from to conserve polymer mass
+        /// when the max is smoothed. prevmaxconcentration() is empty
+        /// before the first update, meaning equal to maxconcentration().
+        void updateMaxConcentration()
+        {
+            cmax0_ = cmax_;
+            for (std::size_t i = 0; i < cmax_.size(); ++i) {
+                cmax_[i] = std::max(cmax_[i], concentration_[i]);
+            }
+        }
 
         BlackoilState& blackoilState() { return state_blackoil_; }
         const BlackoilState& blackoilState() const { return state_blackoil_; }
@@ -89,6 +108,7 @@ namespace Opm
         BlackoilState state_blackoil_;
         std::vector<double> concentration_;
         std::vector<double> cmax_;
+        std::vector<double> cmax0_;
     };
 
 } // namespace Opm
@@ -72,6 +72,16 @@ namespace Opm
     PolymerInflowFromDeck::PolymerInflowFromDeck(Opm::DeckConstPtr deck,
                                                  const Wells& wells,
                                                  const int num_cells)
+        : PolymerInflowFromDeck(deck, wells, WellNameIndex(&wells), num_cells)
+    {
+    }
+
+    /// Constructor.
+    /// @param[in]  deck     Input deck expected to contain WPOLYMER.
+    PolymerInflowFromDeck::PolymerInflowFromDeck(Opm::DeckConstPtr deck,
+                                                 const Wells& wells,
+                                                 const WellNameIndex& well_index,
+                                                 const int num_cells)
         : sparse_inflow_(num_cells)
     {
         if (!deck->hasKeyword("WPOLYMER")) {
@@ -87,21 +97,17 @@ namespace Opm
             // Only use well name and polymer concentration.
             // That is, we ignore salt concentration and group
             // names.
-            int wix = 0;
-            for (; wix < wells.number_of_wells; ++wix) {
-                if (wpolymerKeyword->getRecord(i)->getItem("WELL")->getString(0) == wells.name[wix]) {
-                    break;
-                }
-            }
-            if (wix == wells.number_of_wells) {
+            const std::string& wname = wpolymerKeyword->getRecord(i)->getItem("WELL")->getString(0);
+            const int wix = well_index.index(wname);
+            if (wix < 0) {
                 OPM_THROW(std::runtime_error, "Could not find a match for well "
-                          << wpolymerKeyword->getRecord(i)->getItem("WELL")->getString(0)
+                          << wname
                           << " from WPOLYMER.");
             }
+            const double conc = wpolymerKeyword->getRecord(i)->getItem("POLYMER_CONCENTRATION")->getSIDouble(0);
             for (int j = wells.well_connpos[wix]; j < wells.well_connpos[wix+1]; ++j) {
                 const int perf_cell = wells.well_cells[j];
-                perfcell_conc[perf_cell] =
-                    wpolymerKeyword->getRecord(i)->getItem("POLYMER_CONCENTRATION")->getSIDouble(0);
+                perfcell_conc[perf_cell] = conc;
             }
         }
 
@@ -125,14 +131,14 @@ namespace Opm
             DeckRecordConstPtr record = keyword->getRecord(recordNr);
 
             const std::string& wellNamesPattern = record->getItem("WELL")->getTrimmedString(0);
-            std::string wellName = record->getItem("WELL")->getTrimmedString(0);
             std::vector<WellPtr> wells = schedule->getWells(wellNamesPattern);
             for (auto wellIter = wells.begin(); wellIter != wells.end(); ++wellIter) {
                 WellPtr well = *wellIter;
                 WellInjectionProperties injection = well->getInjectionProperties(currentStep);
                 if (injection.injectorType == WellInjector::WATER) {
                     WellPolymerProperties polymer = well->getPolymerProperties(currentStep);
-                    wellPolymerRate_.insert(std::make_pair(wellName, polymer.m_polymerConcentration));
+                    // Key on the actual well name, the record may hold a pattern.
+                    wellPolymerRate_[well->name()] = polymer.m_polymerConcentration;
                 } else {
                     OPM_THROW(std::logic_error, "For polymer injector you must have a water injector");
                 }
@@ -147,6 +153,18 @@ namespace Opm
                                                  const Wells& wells,
                                                  const int num_cells,
                                                  size_t currentStep)
+        : PolymerInflowFromDeck(deck, eclipseState, wells, WellNameIndex(&wells), num_cells, currentStep)
+    {
+    }
+
+    /// Constructor.
+    /// @param[in]  deck     Input deck expected to contain WPOLYMER.
+    PolymerInflowFromDeck::PolymerInflowFromDeck(Opm::DeckConstPtr deck,
+                                                 Opm::EclipseStateConstPtr eclipseState,
+                                                 const Wells& wells,
+                                                 const WellNameIndex& well_index,
+                                                 const int num_cells,
+                                                 size_t currentStep)
         : sparse_inflow_(num_cells)
     {
         if (!deck->hasKeyword("WPOLYMER")) {
@@ -154,22 +172,16 @@ namespace Opm
             return;
         }
         setInflowValues(deck, eclipseState, currentStep);
-        
-        std::unordered_map<std::string, double>::const_iterator map_it;
+
         // Extract concentrations and put into cell->concentration map.
+        // Wells from WPOLYMER that are not part of the current Wells
+        // structure (e.g. shut wells) do not inject.
         std::map<int, double> perfcell_conc;
-        for (size_t i = 0; i < wellPolymerRate_.size(); ++i) {
-            // Only use well name and polymer concentration.
-            // That is, we ignore salt concentration and group
-            // names.
-            int wix = 0;
-            for (; wix < wells.number_of_wells; ++wix) {
-                map_it = wellPolymerRate_.find(wells.name[wix]);
-                if (map_it == wellPolymerRate_.end()) {
-                    OPM_THROW(std::runtime_error, "Could not find a match for well from WPOLYMER.");
-                } else {
-                    break;
-                }
+        std::unordered_map<std::string, double>::const_iterator map_it = wellPolymerRate_.begin();
+        for (; map_it != wellPolymerRate_.end(); ++map_it) {
+            const int wix = well_index.index(map_it->first);
+            if (wix < 0) {
+                continue;
             }
             for (int j = wells.well_connpos[wix]; j < wells.well_connpos[wix+1]; ++j) {
                 const int perf_cell = wells.well_cells[j];
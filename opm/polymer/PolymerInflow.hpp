@@ -21,6 +21,7 @@
 #define OPM_POLYMERINFLOW_HEADER_INCLUDED
 
 #include <opm/core/utility/SparseVector.hpp>
+#include <opm/polymer/WellNameIndex.hpp>
 #include <opm/parser/eclipse/Deck/Deck.hpp>
 #include <opm/parser/eclipse/EclipseState/Schedule/Well.hpp>
 #include <opm/parser/eclipse/EclipseState/Schedule/Schedule.hpp>
@@ -99,11 +100,35 @@ namespace Opm
         /// Constructor.
         /// \param[in]  deck        Input deck expected to contain WPOLYMER.
         /// \param[in]  wells       Wells structure.
+        /// \param[in]  well_index  Name index for wells.
+        /// \param[in]  num_cells   Number of cells in grid.
+        PolymerInflowFromDeck(Opm::DeckConstPtr deck,
+                              const Wells& wells,
+                              const WellNameIndex& well_index,
+                              const int num_cells);
+
+        /// Constructor.
+        /// \param[in]  deck        Input deck expected to contain WPOLYMER.
+        /// \param[in]  wells       Wells structure.
+        /// \param[in]  num_cells   Number of cells in grid.
+        /// \param[in]  currentStep Number of current simulation step.
+        PolymerInflowFromDeck(Opm::DeckConstPtr deck,
+                              Opm::EclipseStateConstPtr eclipseState,
+                              const Wells& wells,
+                              const int num_cells,
+                              size_t currentStep);
+
+        /// Constructor.
+        /// \param[in]  deck        Input deck expected to contain WPOLYMER.
+        /// \param[in]  wells       Wells structure.
+        /// \param[in]  well_index  Name index for wells, shared with other
+        ///                         per-step well setup.
         /// \param[in]  num_cells   Number of cells in grid.
         /// \param[in]  currentStep Number of current simulation step.
         PolymerInflowFromDeck(Opm::DeckConstPtr deck,
                               Opm::EclipseStateConstPtr eclipseState,
                               const Wells& wells,
+                              const WellNameIndex& well_index,
                               const int num_cells,
                               size_t currentStep);
 
@@ -0,0 +1,388 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#include <opm/polymer/PolymerLog.hpp>
+#include <opm/core/utility/parameters/ParameterGroup.hpp>
+#include <opm/core/utility/ErrorMacros.hpp>
+#include <opm/parser/eclipse/OpmLog/OpmLog.hpp>
+#include <opm/parser/eclipse/OpmLog/LogUtil.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <streambuf>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Opm
+{
+namespace PolymerLog
+{
+
+    namespace
+    {
+        int64_t messageType(const Level level)
+        {
+            switch (level) {
+            case Debug:   return Log::MessageType::Debug;
+            case Info:    return Log::MessageType::Info;
+            case Warning: return Log::MessageType::Warning;
+            default:      return Log::MessageType::Error;
+            }
+        }
+
+        class Sink;
+
+        /// Stream buffer that queues everything written to it on the
+        /// sink, used in place of the std::cout and std::cerr buffers
+        /// while the sink thread runs.
+        class RedirectBuffer : public std::streambuf
+        {
+        public:
+            RedirectBuffer(Sink& sink, const int stream)
+                : sink_(sink), stream_(stream)
+            {
+            }
+        protected:
+            int_type overflow(int_type ch);
+            std::streamsize xsputn(const char* s, std::streamsize n);
+        private:
+            Sink& sink_;
+            int stream_;
+        };
+
+        /// Writes terminal output, either directly or from a sink thread.
+        class Sink
+        {
+        public:
+            enum Stream { Out = 0, Err = 1 };
+
+            Sink()
+                : level_(Info), rate_limit_(0), rate_window_(1.0), terminal_(true),
+                  out_redirect_(*this, Out), err_redirect_(*this, Err),
+                  out_buffer_(0), err_buffer_(0),
+                  running_(false), busy_(false)
+            {
+            }
+
+            ~Sink()
+            {
+                stop();
+            }
+
+            void write(const Level level, const std::string& message)
+            {
+                OpmLog::addMessage(messageType(level), message);
+                if (terminal_) {
+                    const Stream stream = (level >= Warning) ? Err : Out;
+                    std::string line(message);
+                    line += '\n';
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    if (running_) {
+                        enqueueLocked(stream, line.data(), line.size());
+                        lock.unlock();
+                        wakeup_.notify_one();
+                    } else {
+                        std::ostream& os = (stream == Err) ? std::cerr : std::cout;
+                        os << line;
+                    }
+                }
+            }
+
+            void enqueue(const int stream, const char* s, const std::size_t n)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    enqueueLocked(stream, s, n);
+                }
+                wakeup_.notify_one();
+            }
+
+            void start()
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!running_) {
+                    running_ = true;
+                    out_buffer_ = std::cout.rdbuf();
+                    err_buffer_ = std::cerr.rdbuf();
+                    thread_ = std::thread(&Sink::run, this);
+                    std::cout.flush();
+                    std::cout.rdbuf(&out_redirect_);
+                    std::cerr.rdbuf(&err_redirect_);
+                }
+            }
+
+            void stop()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (!running_) {
+                        return;
+                    }
+                    std::cout.rdbuf(out_buffer_);
+                    std::cerr.rdbuf(err_buffer_);
+                    running_ = false;
+                }
+                wakeup_.notify_one();
+                thread_.join();
+            }
+
+            void drain()
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                drained_.wait(lock, [this]{ return queue_.empty() && !busy_; });
+                if (!running_) {
+                    std::cout.flush();
+                }
+            }
+
+            void addSite(Site* site)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                sites_.push_back(site);
+            }
+
+            std::vector<Site*> sites()
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return sites_;
+            }
+
+            std::atomic<int> level_;
+            std::atomic<int> rate_limit_;
+            std::atomic<double> rate_window_;
+            std::atomic<bool> terminal_;
+
+        private:
+            // Consecutive output to the same stream is merged into
+            // one queue entry.
+            void enqueueLocked(const int stream, const char* s, const std::size_t n)
+            {
+                if (queue_.empty() || queue_.back().first != stream) {
+                    queue_.emplace_back(stream, std::string());
+                }
+                queue_.back().second.append(s, n);
+            }
+
+            void run()
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                while (true) {
+                    wakeup_.wait(lock, [this]{ return !queue_.empty() || !running_; });
+                    if (queue_.empty() && !running_) {
+                        break;
+                    }
+                    std::deque<std::pair<int, std::string> > batch;
+                    batch.swap(queue_);
+                    busy_ = true;
+                    lock.unlock();
+                    for (const auto& m : batch) {
+                        std::streambuf* buffer = (m.first == Err) ? err_buffer_ : out_buffer_;
+                        buffer->sputn(m.second.data(), m.second.size());
+                    }
+                    out_buffer_->pubsync();
+                    err_buffer_->pubsync();
+                    lock.lock();
+                    busy_ = false;
+                    drained_.notify_all();
+                }
+                drained_.notify_all();
+            }
+
+            RedirectBuffer out_redirect_;
+            RedirectBuffer err_redirect_;
+            std::streambuf* out_buffer_;
+            std::streambuf* err_buffer_;
+            std::mutex mutex_;
+            std::condition_variable wakeup_;
+            std::condition_variable drained_;
+            std::deque<std::pair<int, std::string> > queue_;
+            std::vector<Site*> sites_;
+            std::thread thread_;
+            bool running_;
+            bool busy_;
+        };
+
+        RedirectBuffer::int_type RedirectBuffer::overflow(int_type ch)
+        {
+            if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+                const char c = traits_type::to_char_type(ch);
+                sink_.enqueue(stream_, &c, 1);
+            }
+            return traits_type::not_eof(ch);
+        }
+
+        std::streamsize RedirectBuffer::xsputn(const char* s, std::streamsize n)
+        {
+            sink_.enqueue(stream_, s, n);
+            return n;
+        }
+
+        double now()
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        Sink& sink()
+        {
+            static Sink the_sink;
+            return the_sink;
+        }
+
+    } // anonymous namespace
+
+
+
+    void setLevel(const Level level)
+    {
+        sink().level_ = level;
+    }
+
+    Level level()
+    {
+        return static_cast<Level>(sink().level_.load());
+    }
+
+    void setRateLimit(const int max_per_window, const double window_seconds)
+    {
+        if (window_seconds <= 0.0) {
+            OPM_THROW(std::runtime_error, "Log rate limit window must be positive, got " << window_seconds);
+        }
+        sink().rate_limit_ = max_per_window;
+        sink().rate_window_ = window_seconds;
+    }
+
+    void setTerminalOutput(const bool on)
+    {
+        sink().terminal_ = on;
+    }
+
+    void setAsync(const bool on)
+    {
+        if (on) {
+            sink().start();
+        } else {
+            sink().stop();
+        }
+    }
+
+    void init(const parameter::ParameterGroup& param)
+    {
+        const std::string lvl = param.getDefault("log_level", std::string("info"));
+        if (lvl == "debug") {
+            setLevel(Debug);
+        } else if (lvl == "info") {
+            setLevel(Info);
+        } else if (lvl == "warning") {
+            setLevel(Warning);
+        } else if (lvl == "error") {
+            setLevel(Error);
+        } else if (lvl == "off") {
+            setLevel(Off);
+        } else {
+            OPM_THROW(std::runtime_error, "Unknown log_level " << lvl);
+        }
+        if (level() < OPM_POLYMER_LOG_LEVEL) {
+            OPM_THROW(std::runtime_error, "log_level " << lvl << " is compiled out, rebuild with "
+                      "OPM_POLYMER_LOG_LEVEL=" << int(level()) << " or lower");
+        }
+        setRateLimit(param.getDefault("log_rate_limit", 0),
+                     param.getDefault("log_rate_window", 1.0));
+        setTerminalOutput(param.getDefault("output_terminal", true));
+        setAsync(param.getDefault("log_async", false));
+    }
+
+    void write(const Level level, const std::string& message)
+    {
+        sink().write(level, message);
+    }
+
+    void flush()
+    {
+        sink().drain();
+        const std::vector<Site*> sites = sink().sites();
+        for (std::vector<Site*>::const_iterator it = sites.begin(); it != sites.end(); ++it) {
+            const int n = (*it)->takeSuppressed();
+            if (n > 0) {
+                std::ostringstream os;
+                os << n << " messages suppressed from " << (*it)->where();
+                write(Info, os.str());
+            }
+        }
+        sink().drain();
+    }
+
+
+
+    // ---------- Methods of Site ----------
+
+    Site::Site(const char* where)
+        : where_(where), window_start_(now()), count_(0), suppressed_(0)
+    {
+        sink().addSite(this);
+    }
+
+    bool Site::admit()
+    {
+        const int limit = sink().rate_limit_;
+        if (limit <= 0) {
+            return true;
+        }
+        int reported = 0;
+        bool admitted = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            const double t = now();
+            if (t - window_start_ >= sink().rate_window_) {
+                window_start_ = t;
+                count_ = 0;
+                reported = suppressed_;
+                suppressed_ = 0;
+            }
+            if (count_ < limit) {
+                ++count_;
+                admitted = true;
+            } else {
+                ++suppressed_;
+            }
+        }
+        if (reported > 0) {
+            std::ostringstream os;
+            os << reported << " messages suppressed from " << where_;
+            write(Info, os.str());
+        }
+        return admitted;
+    }
+
+    int Site::takeSuppressed()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const int n = suppressed_;
+        suppressed_ = 0;
+        return n;
+    }
+
+} // namespace PolymerLog
+} // namespace Opm
@@ -0,0 +1,139 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_POLYMERLOG_HEADER_INCLUDED
+#define OPM_POLYMERLOG_HEADER_INCLUDED
+
+#include <mutex>
+#include <sstream>
+#include <string>
+
+/// Messages below this level are removed at compile time.
+/// 0 = debug, 1 = info, 2 = warning, 3 = error. By default all
+/// messages are compiled in and the runtime level filters them.
+#ifndef OPM_POLYMER_LOG_LEVEL
+#define OPM_POLYMER_LOG_LEVEL 0
+#endif
+
+namespace Opm
+{
+
+    namespace parameter { class ParameterGroup; }
+
+    /// @brief Levelled, rate-limited logging for the polymer solvers.
+    ///
+    /// Messages are written to the terminal and forwarded to the
+    /// OpmLog backends, always on the calling thread. With
+    /// asynchronous output enabled, terminal output is handed to a
+    /// sink thread, so the caller never waits for console I/O. Use
+    /// the OPM_POLYMER_LOG_* macros rather than calling write()
+    /// directly: they compile out below OPM_POLYMER_LOG_LEVEL, skip
+    /// formatting below the runtime level and apply the per call
+    /// site rate limit.
+    namespace PolymerLog
+    {
+        enum Level { Debug = 0, Info = 1, Warning = 2, Error = 3, Off = 4 };
+
+        /// Set runtime threshold level.
+        void setLevel(const Level level);
+
+        /// Current runtime threshold level.
+        Level level();
+
+        /// True if messages at this level are written.
+        inline bool enabled(const Level l) { return l >= level(); }
+
+        /// Maximum number of messages written per call site within
+        /// each window of window_seconds, zero for no limit. The
+        /// number of suppressed messages is reported when the next
+        /// window of the call site opens.
+        void setRateLimit(const int max_per_window, const double window_seconds);
+
+        /// Enable or disable terminal output. OpmLog backends
+        /// receive messages regardless.
+        void setTerminalOutput(const bool on);
+
+        /// Start or stop the asynchronous sink thread. While it runs,
+        /// std::cout and std::cerr are redirected through it, so other
+        /// terminal output keeps its order relative to log messages.
+        /// Stopping drains all pending output first.
+        void setAsync(const bool on);
+
+        /// Configure from parameters log_level (debug, info, warning,
+        /// error or off), log_rate_limit, log_rate_window (seconds),
+        /// log_async and output_terminal.
+        /// Throws if log_level is below OPM_POLYMER_LOG_LEVEL, since
+        /// those messages are compiled out.
+        void init(const parameter::ParameterGroup& param);
+
+        /// Write a message, bypassing level and rate checks.
+        void write(const Level level, const std::string& message);
+
+        /// Wait until all pending messages are written, and report
+        /// call sites that have messages suppressed by the rate limit
+        /// since their last report.
+        void flush();
+
+        /// @brief A logging call site, counting its messages in the
+        /// current rate limit window.
+        class Site
+        {
+        public:
+            explicit Site(const char* where);
+            /// True if the rate limit admits another message.
+            bool admit();
+            const char* where() const { return where_; }
+            /// Number of messages suppressed since the last call.
+            int takeSuppressed();
+        private:
+            const char* where_;
+            std::mutex mutex_;
+            double window_start_;
+            int count_;
+            int suppressed_;
+        };
+
+    } // namespace PolymerLog
+
+} // namespace Opm
+
+
+#define OPM_POLYMER_LOG_STRINGIZE_(x) #x
+#define OPM_POLYMER_LOG_STRINGIZE(x) OPM_POLYMER_LOG_STRINGIZE_(x)
+
+#define OPM_POLYMER_LOG(level, message)                                              \
+    do {                                                                             \
+        if ((level) >= OPM_POLYMER_LOG_LEVEL && Opm::PolymerLog::enabled(level)) {   \
+            static Opm::PolymerLog::Site opm_log_site_(                              \
+                __FILE__ ":" OPM_POLYMER_LOG_STRINGIZE(__LINE__));                   \
+            if (opm_log_site_.admit()) {                                             \
+                std::ostringstream opm_log_os_;                                      \
+                opm_log_os_ << message;                                              \
+                Opm::PolymerLog::write(level, opm_log_os_.str());                    \
+            }                                                                        \
+        }                                                                            \
+    } while (false)
+
+#define OPM_POLYMER_LOG_DEBUG(message)   OPM_POLYMER_LOG(Opm::PolymerLog::Debug, message)
+#define OPM_POLYMER_LOG_INFO(message)    OPM_POLYMER_LOG(Opm::PolymerLog::Info, message)
+#define OPM_POLYMER_LOG_WARNING(message) OPM_POLYMER_LOG(Opm::PolymerLog::Warning, message)
+#define OPM_POLYMER_LOG_ERROR(message)   OPM_POLYMER_LOG(Opm::PolymerLog::Error, message)
+
+
+#endif // OPM_POLYMERLOG_HEADER_INCLUDED
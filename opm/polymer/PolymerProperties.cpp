@@ -20,6 +20,7 @@
 #include <config.h>
 
 #include <opm/polymer/PolymerProperties.hpp>
+#include <algorithm>
 #include <cmath>
 #include <vector>
 #include <opm/core/utility/linearInterpolation.hpp>
@@ -28,6 +29,112 @@
 
 namespace Opm
 {
+
+    namespace
+    {
+
+        // Slopes at the table points of the monotone piecewise cubic
+        // Hermite interpolant (Fritsch-Carlson, with the weighted
+        // harmonic mean of PCHIP). The end slopes are the end secants,
+        // so that extrapolation continues linearly as in
+        // linearInterpolation(), and the interpolant is C1 everywhere.
+        void monotoneSlopes(const std::vector<double>& x, const std::vector<double>& y,
+                            std::vector<double>& d)
+        {
+            const int n = x.size();
+            d.assign(n, 0.0);
+            if (n < 2) {
+                return;
+            }
+            d[0] = (y[1] - y[0])/(x[1] - x[0]);
+            d[n - 1] = (y[n - 1] - y[n - 2])/(x[n - 1] - x[n - 2]);
+            for (int k = 1; k < n - 1; ++k) {
+                const double h0 = x[k] - x[k - 1];
+                const double h1 = x[k + 1] - x[k];
+                const double delta0 = (y[k] - y[k - 1])/h0;
+                const double delta1 = (y[k + 1] - y[k])/h1;
+                if (delta0*delta1 > 0.0) {
+                    d[k] = 3.0*(h0 + h1)/((2.0*h1 + h0)/delta0 + (h1 + 2.0*h0)/delta1);
+                }
+            }
+        }
+
+        // Value and derivative of the monotone interpolant.
+        double monotoneInterpolation(const std::vector<double>& x, const std::vector<double>& y,
+                                     const std::vector<double>& d, const double xval, double& der)
+        {
+            const int n = x.size();
+            if (xval <= x[0]) {
+                der = d[0];
+                return y[0] + d[0]*(xval - x[0]);
+            }
+            if (xval >= x[n - 1]) {
+                der = d[n - 1];
+                return y[n - 1] + d[n - 1]*(xval - x[n - 1]);
+            }
+            const int k = std::upper_bound(x.begin(), x.end(), xval) - x.begin() - 1;
+            const double h = x[k + 1] - x[k];
+            const double t = (xval - x[k])/h;
+            const double t2 = t*t;
+            const double t3 = t2*t;
+            const double h00 = 2.0*t3 - 3.0*t2 + 1.0;
+            const double h10 = t3 - 2.0*t2 + t;
+            const double h01 = -2.0*t3 + 3.0*t2;
+            const double h11 = t3 - t2;
+            der = ((6.0*t2 - 6.0*t)*y[k] + (3.0*t2 - 4.0*t + 1.0)*h*d[k]
+                   + (-6.0*t2 + 6.0*t)*y[k + 1] + (3.0*t2 - 2.0*t)*h*d[k + 1])/h;
+            return h00*y[k] + h10*h*d[k] + h01*y[k + 1] + h11*h*d[k + 1];
+        }
+
+        // Largest difference between the monotone and the linear
+        // interpolant. On an interval the difference is
+        // h t (1 - t) ((d0 - delta)(1 - t) - (d1 - delta) t), bounded
+        // by 4/27 h (|d0 - delta| + |d1 - delta|).
+        double monotoneInterpolationError(const std::vector<double>& x, const std::vector<double>& y,
+                                          const std::vector<double>& d)
+        {
+            double error = 0.0;
+            for (int k = 0; k + 1 < int(x.size()); ++k) {
+                const double h = x[k + 1] - x[k];
+                const double delta = (y[k + 1] - y[k])/h;
+                error = std::max(error, 4.0/27.0*h*(std::fabs(d[k] - delta) + std::fabs(d[k + 1] - delta)));
+            }
+            return error;
+        }
+
+        // Largest slope of the monotone interpolant. Its derivative is
+        // quadratic on each interval, so the maximum is at an end or at
+        // the vertex.
+        double monotoneInterpolationMaxSlope(const std::vector<double>& x, const std::vector<double>& y,
+                                             const std::vector<double>& d)
+        {
+            double slope = 0.0;
+            for (int k = 0; k + 1 < int(x.size()); ++k) {
+                const double delta = (y[k + 1] - y[k])/(x[k + 1] - x[k]);
+                const double a = 3.0*(d[k] + d[k + 1]) - 6.0*delta;
+                const double b = 6.0*delta - 4.0*d[k] - 2.0*d[k + 1];
+                slope = std::max(slope, std::max(std::fabs(d[k]), std::fabs(d[k + 1])));
+                if (a != 0.0) {
+                    const double t = -b/(2.0*a);
+                    if (t > 0.0 && t < 1.0) {
+                        slope = std::max(slope, std::fabs(a*t*t + b*t + d[k]));
+                    }
+                }
+            }
+            return slope;
+        }
+
+        // Smooth maximum, exceeding max(a, b) by at most width/2, and
+        // its derivative with respect to a.
+        double smoothMax(const double a, const double b, const double width, double& dmax_da)
+        {
+            const double root = std::sqrt((a - b)*(a - b) + width*width);
+            dmax_da = 0.5*(1.0 + (a - b)/root);
+            return 0.5*(a + b + root);
+        }
+
+    } // anonymous namespace
+
     double PolymerProperties::cMax() const
     {
         return c_max_;
@@ -58,6 +165,49 @@ namespace Opm
         return c_max_ads_;
     }
 
+    void PolymerProperties::setSmoothing(const double width)
+    {
+        if (width < 0.0) {
+            OPM_THROW(std::runtime_error, "Smoothing width must be non-negative, got " << width);
+        }
+        smoothing_width_ = width;
+        updateSmoothing();
+    }
+
+    double PolymerProperties::smoothingWidth() const
+    {
+        return smoothing_width_;
+    }
+
+    double PolymerProperties::viscMultSmoothingError() const
+    {
+        return visc_mult_smoothing_error_;
+    }
+
+    double PolymerProperties::adsorptionSmoothingError() const
+    {
+        return ads_smoothing_error_;
+    }
+
+    void PolymerProperties::updateSmoothing()
+    {
+        if (smoothing_width_ == 0.0) {
+            visc_mult_slopes_.clear();
+            ads_slopes_.clear();
+            visc_mult_smoothing_error_ = 0.0;
+            ads_smoothing_error_ = 0.0;
+            return;
+        }
+        monotoneSlopes(c_vals_visc_, visc_mult_vals_, visc_mult_slopes_);
+        monotoneSlopes(c_vals_ads_, ads_vals_, ads_slopes_);
+        visc_mult_smoothing_error_ = monotoneInterpolationError(c_vals_visc_, visc_mult_vals_, visc_mult_slopes_);
+        ads_smoothing_error_ = monotoneInterpolationError(c_vals_ads_, ads_vals_, ads_slopes_);
+        if (ads_index_ == NoDesorption) {
+            ads_smoothing_error_ += 0.5*smoothing_width_
+                *monotoneInterpolationMaxSlope(c_vals_ads_, ads_vals_, ads_slopes_);
+        }
+    }
+
     int PolymerProperties::adsIndex() const
     {
         return ads_index_;
@@ -84,11 +234,18 @@ namespace Opm
 
     double PolymerProperties::viscMult(double c) const
     {
+        if (smoothing_width_ > 0.0) {
+            double der;
+            return monotoneInterpolation(c_vals_visc_, visc_mult_vals_, visc_mult_slopes_, c, der);
+        }
         return Opm::linearInterpolation(c_vals_visc_, visc_mult_vals_, c);
     }
 
     double PolymerProperties::viscMultWithDer(double c, double* der) const
     {
+        if (smoothing_width_ > 0.0) {
+            return monotoneInterpolation(c_vals_visc_, visc_mult_vals_, visc_mult_slopes_, c, *der);
+        }
         *der = Opm::linearInterpolationDerivative(c_vals_visc_, visc_mult_vals_, c);
         return Opm::linearInterpolation(c_vals_visc_, visc_mult_vals_, c);
     }
@@ -108,6 +265,12 @@ namespace Opm
     void PolymerProperties::simpleAdsorptionBoth(double c, double& c_ads,
                                                  double& dc_ads_dc, bool if_with_der) const
     {
+        if (smoothing_width_ > 0.0) {
+            double der;
+            c_ads = monotoneInterpolation(c_vals_ads_, ads_vals_, ads_slopes_, c, der);
+            dc_ads_dc = if_with_der ? der : 0.;
+            return;
+        }
         c_ads = Opm::linearInterpolation(c_vals_ads_, ads_vals_, c);;
         if (if_with_der) {
             dc_ads_dc = Opm::linearInterpolationDerivative(c_vals_ads_, ads_vals_, c);
@@ -135,6 +298,13 @@ namespace Opm
         if (ads_index_ == Desorption) {
             simpleAdsorptionBoth(c, c_ads, dc_ads_dc, if_with_der);
         } else if (ads_index_ == NoDesorption) {
+            if (smoothing_width_ > 0.0) {
+                double dmax_dc;
+                const double cmax_eff = smoothMax(c, cmax, smoothing_width_, dmax_dc);
+                simpleAdsorptionBoth(cmax_eff, c_ads, dc_ads_dc, if_with_der);
+                dc_ads_dc *= dmax_dc;
+                return;
+            }
             simpleAdsorptionBoth(std::max(c, cmax), c_ads, dc_ads_dc, if_with_der);
         } else {
             OPM_THROW(std::runtime_error, "Invalid Adsoption index");
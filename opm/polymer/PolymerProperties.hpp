@@ -34,6 +34,9 @@ namespace Opm
     {
     public:
         PolymerProperties()
+            : smoothing_width_(0.0),
+              visc_mult_smoothing_error_(0.0),
+              ads_smoothing_error_(0.0)
         {
         }
 
@@ -78,11 +81,17 @@ namespace Opm
               c_vals_ads_(c_vals_ads),
               ads_vals_(ads_vals),
               water_vel_vals_(water_vel_vals),
-              shear_vrf_vals_(shear_vrf_vals)
+              shear_vrf_vals_(shear_vrf_vals),
+              smoothing_width_(0.0),
+              visc_mult_smoothing_error_(0.0),
+              ads_smoothing_error_(0.0)
         {
         }
 
         PolymerProperties(Opm::DeckConstPtr deck, Opm::EclipseStateConstPtr eclipseState)
+            : smoothing_width_(0.0),
+              visc_mult_smoothing_error_(0.0),
+              ads_smoothing_error_(0.0)
         {
             readFromDeck(deck, eclipseState);
         }
@@ -115,6 +124,7 @@ namespace Opm
             ads_index_ = ads_index;
             water_vel_vals_ = water_vel_vals;
             shear_vrf_vals_ = shear_vrf_vals;
+            updateSmoothing();
         }
 
         void readFromDeck(Opm::DeckConstPtr deck, Opm::EclipseStateConstPtr eclipseState)
@@ -153,8 +163,30 @@ namespace Opm
 
             c_vals_ads_ = plyadsTable.getPolymerConcentrationColumn();
             ads_vals_ = plyadsTable.getAdsorbedPolymerColumn();
+            updateSmoothing();
         }
 
+        /// Evaluate the kinks of the model smoothly, which helps Newton
+        /// convergence: the viscosity multiplier and adsorption tables
+        /// are interpolated with monotone C1 cubics (Fritsch-Carlson)
+        /// instead of linearly, and adsorption without desorption uses
+        ///     smax(c, cmax) = (c + cmax + sqrt((c - cmax)^2 + width^2))/2
+        /// instead of max(c, cmax), exceeding it by at most width/2.
+        /// With width = 0 (the default) the model is evaluated exactly.
+        void setSmoothing(const double width);
+
+        /// Width of the smooth maximum, 0 if smoothing is off.
+        double smoothingWidth() const;
+
+        /// Bound on the difference between the smoothed and the exact
+        /// viscosity multiplier, 0 if smoothing is off.
+        double viscMultSmoothingError() const;
+
+        /// Bound on the difference between the smoothed and the exact
+        /// adsorption, including the smooth maximum, 0 if smoothing is
+        /// off.
+        double adsorptionSmoothingError() const;
+
         double cMax() const;
 
         double mixParam() const;
@@ -286,6 +318,13 @@ namespace Opm
         std::vector<double> ads_vals_;
         std::vector<double> water_vel_vals_;
         std::vector<double> shear_vrf_vals_;
+        // For smoothed evaluation.
+        double smoothing_width_;
+        std::vector<double> visc_mult_slopes_;
+        std::vector<double> ads_slopes_;
+        double visc_mult_smoothing_error_;
+        double ads_smoothing_error_;
+        void updateSmoothing();
         void simpleAdsorptionBoth(double c, double& c_ads,
                                   double& dc_ads_dc, bool if_with_der) const;
         void adsorptionBoth(double c, double cmax,
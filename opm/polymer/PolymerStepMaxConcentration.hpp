@@ -0,0 +1,73 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_POLYMERSTEPMAXCONCENTRATION_HEADER_INCLUDED
+#define OPM_POLYMERSTEPMAXCONCENTRATION_HEADER_INCLUDED
+
+#include <opm/polymer/PolymerBlackoilState.hpp>
+#include <vector>
+
+namespace Opm
+{
+
+    /// Max polymer concentrations that the accumulation terms of a
+    /// fully implicit time step are evaluated with.
+    ///
+    /// The end-of-step accumulation uses the max concentration the
+    /// step starts from. With a smoothed max in the adsorption, the
+    /// start-of-step accumulation of the next step only equals it if
+    /// it uses the same max concentration, i.e. the one the previous
+    /// step started from. Otherwise adsorbed polymer is created or
+    /// lost at every step.
+    class PolymerStepMaxConcentration
+    {
+    public:
+        /// Take the max concentrations from the state at the start of
+        /// a step.
+        void beginStep(const PolymerBlackoilState& state)
+        {
+            cmax_[1] = state.maxconcentration();
+            if (state.prevmaxconcentration().empty()) {
+                cmax_[0] = cmax_[1];
+            } else {
+                cmax_[0] = state.prevmaxconcentration();
+            }
+        }
+
+        /// Max concentration of the accumulation term aix, 0 for the
+        /// start and 1 for the end of the step.
+        const std::vector<double>& accumulation(const int aix) const
+        {
+            return cmax_[aix];
+        }
+
+        /// Update the max concentration of the state after the step
+        /// has converged.
+        static void endStep(PolymerBlackoilState& state)
+        {
+            state.updateMaxConcentration();
+        }
+
+    private:
+        std::vector<double> cmax_[2];
+    };
+
+} // namespace Opm
+
+#endif // OPM_POLYMERSTEPMAXCONCENTRATION_HEADER_INCLUDED
@@ -0,0 +1,195 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#include <opm/polymer/PolymerTrace.hpp>
+#include <opm/polymer/PolymerLog.hpp>
+#include <opm/core/utility/parameters/ParameterGroup.hpp>
+#include <opm/core/utility/ErrorMacros.hpp>
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Opm
+{
+namespace PolymerTrace
+{
+
+    namespace
+    {
+        struct Event
+        {
+            const char* name;
+            double begin;
+            double end; // Negative for instantaneous events.
+        };
+
+        /// Events of one thread. Only the owning thread appends.
+        struct Track
+        {
+            explicit Track(const int t)
+                : tid(t), name(0)
+            {
+            }
+
+            int tid;
+            const char* name;
+            std::vector<Event> events;
+        };
+
+        /// Owns the tracks, so that events survive their threads.
+        class Registry
+        {
+        public:
+            Registry()
+                : origin_(std::chrono::steady_clock::now())
+            {
+            }
+
+            Track& track()
+            {
+                thread_local Track* track = 0;
+                if (!track) {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    tracks_.emplace_back(new Track(tracks_.size()));
+                    track = tracks_.back().get();
+                }
+                return *track;
+            }
+
+            double now() const
+            {
+                const std::chrono::duration<double, std::micro> t
+                    = std::chrono::steady_clock::now() - origin_;
+                return t.count();
+            }
+
+            void write(std::ostream& os)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                os << "{\"traceEvents\":[\n";
+                const char* sep = "";
+                os << std::fixed << std::setprecision(3);
+                for (const auto& track : tracks_) {
+                    os << sep << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << track->tid
+                       << ",\"args\":{\"name\":\"";
+                    if (track->name) {
+                        os << track->name;
+                    } else {
+                        os << "thread " << track->tid;
+                    }
+                    os << "\"}}";
+                    sep = ",\n";
+                    for (const Event& e : track->events) {
+                        os << sep << "{\"name\":\"" << e.name << "\",\"cat\":\"polymer\",\"pid\":0,\"tid\":"
+                           << track->tid << ",\"ts\":" << e.begin;
+                        if (e.end < 0.0) {
+                            os << ",\"ph\":\"i\",\"s\":\"t\"}";
+                        } else {
+                            os << ",\"ph\":\"X\",\"dur\":" << e.end - e.begin << "}";
+                        }
+                    }
+                    track->events.clear();
+                }
+                os << "\n]}\n";
+            }
+
+            std::string filename_;
+
+        private:
+            std::chrono::steady_clock::time_point origin_;
+            std::mutex mutex_;
+            std::vector<std::unique_ptr<Track> > tracks_;
+        };
+
+        Registry& registry()
+        {
+            static Registry the_registry;
+            return the_registry;
+        }
+
+    } // anonymous namespace
+
+
+
+    namespace detail
+    {
+        std::atomic<bool> recording(false);
+
+        double now()
+        {
+            return registry().now();
+        }
+
+        void record(const char* name, const double begin, const double end)
+        {
+            const Event e = { name, begin, end };
+            registry().track().events.push_back(e);
+        }
+    } // namespace detail
+
+
+
+    void start(const std::string& filename)
+    {
+        registry().filename_ = filename;
+        registry().track();
+        detail::recording = true;
+    }
+
+    void init(const parameter::ParameterGroup& param)
+    {
+        const std::string filename = param.getDefault("trace_file", std::string(""));
+        if (!filename.empty()) {
+            start(filename);
+            setThreadName("main");
+        }
+    }
+
+    void setThreadName(const char* name)
+    {
+        registry().track().name = name;
+    }
+
+    void instant(const char* name)
+    {
+        detail::record(name, detail::now(), -1.0);
+    }
+
+    void write()
+    {
+        if (!detail::recording) {
+            return;
+        }
+        detail::recording = false;
+        std::ofstream os(registry().filename_.c_str());
+        if (!os) {
+            OPM_THROW(std::runtime_error, "Failed to open trace file " << registry().filename_);
+        }
+        registry().write(os);
+        OPM_POLYMER_LOG_INFO("Trace written to " << registry().filename_);
+    }
+
+} // namespace PolymerTrace
+} // namespace Opm
@@ -0,0 +1,126 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_POLYMERTRACE_HEADER_INCLUDED
+#define OPM_POLYMERTRACE_HEADER_INCLUDED
+
+#include <atomic>
+#include <string>
+
+/// Trace events are removed at compile time if this is 0.
+#ifndef OPM_POLYMER_TRACE
+#define OPM_POLYMER_TRACE 1
+#endif
+
+namespace Opm
+{
+
+    namespace parameter { class ParameterGroup; }
+
+    /// @brief Timeline of scoped events for the polymer simulators.
+    ///
+    /// Events are recorded in a buffer per thread, each becoming its
+    /// own track, and written as Chrome trace JSON, which can be
+    /// loaded in chrome://tracing or Perfetto. Use the
+    /// OPM_POLYMER_TRACE_* macros rather than the classes directly:
+    /// when tracing is disabled a scope costs one relaxed atomic load,
+    /// and with OPM_POLYMER_TRACE set to 0 nothing at all. Event names
+    /// must be string literals, they are stored by pointer.
+    namespace PolymerTrace
+    {
+        namespace detail
+        {
+            extern std::atomic<bool> recording;
+            double now();
+            void record(const char* name, const double begin, const double end);
+        } // namespace detail
+
+        /// True if events are recorded.
+        inline bool enabled()
+        {
+            return detail::recording.load(std::memory_order_relaxed);
+        }
+
+        /// Start recording, to be written to filename.
+        void start(const std::string& filename);
+
+        /// Configure from parameter trace_file. No file, the default,
+        /// leaves tracing disabled.
+        void init(const parameter::ParameterGroup& param);
+
+        /// Name the track of the calling thread.
+        void setThreadName(const char* name);
+
+        /// Record an instantaneous event, e.g. a well control switch.
+        void instant(const char* name);
+
+        /// Stop recording and write all events to the file given to
+        /// start(). Threads must not record events meanwhile.
+        void write();
+
+        /// @brief Records an event lasting for the lifetime of the
+        /// object.
+        class Scope
+        {
+        public:
+            explicit Scope(const char* name)
+                : name_(enabled() ? name : 0),
+                  begin_(name_ ? detail::now() : 0.0)
+            {
+            }
+
+            ~Scope()
+            {
+                if (name_) {
+                    detail::record(name_, begin_, detail::now());
+                }
+            }
+
+        private:
+            Scope(const Scope&);
+            Scope& operator=(const Scope&);
+
+            const char* name_;
+            double begin_;
+        };
+
+    } // namespace PolymerTrace
+
+} // namespace Opm
+
+
+#define OPM_POLYMER_TRACE_CONCAT_(a, b) a ## b
+#define OPM_POLYMER_TRACE_CONCAT(a, b) OPM_POLYMER_TRACE_CONCAT_(a, b)
+
+#if OPM_POLYMER_TRACE
+#define OPM_POLYMER_TRACE_SCOPE(name) \
+    const Opm::PolymerTrace::Scope OPM_POLYMER_TRACE_CONCAT(opm_trace_scope_, __LINE__)(name)
+#define OPM_POLYMER_TRACE_INSTANT(name)            \
+    do {                                           \
+        if (Opm::PolymerTrace::enabled()) {        \
+            Opm::PolymerTrace::instant(name);      \
+        }                                          \
+    } while (false)
+#else
+#define OPM_POLYMER_TRACE_SCOPE(name) do { } while (false)
+#define OPM_POLYMER_TRACE_INSTANT(name) do { } while (false)
+#endif
+
+
+#endif // OPM_POLYMERTRACE_HEADER_INCLUDED
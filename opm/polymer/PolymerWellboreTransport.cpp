@@ -0,0 +1,202 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#include <opm/polymer/PolymerWellboreTransport.hpp>
+#include <opm/polymer/WellNameIndex.hpp>
+#include <opm/core/wells.h>
+#include <opm/core/utility/ErrorMacros.hpp>
+#include <algorithm>
+
+namespace Opm
+{
+
+    PolymerWellboreTransport::PolymerWellboreTransport(const double segment_volume,
+                                                       const double decay_rate)
+        : segment_volume_(segment_volume),
+          decay_rate_(decay_rate),
+          dt_(0.0),
+          wells_(0)
+    {
+        if (segment_volume_ <= 0.0) {
+            OPM_THROW(std::runtime_error, "PolymerWellboreTransport: segment volume must be positive.");
+        }
+        if (decay_rate_ < 0.0) {
+            OPM_THROW(std::runtime_error, "PolymerWellboreTransport: negative decay rate.");
+        }
+    }
+
+
+
+    void PolymerWellboreTransport::beginStep(const Wells& wells,
+                                             const std::vector<double>& polymer_inflow,
+                                             const double dt)
+    {
+        wells_ = &wells;
+        dt_ = dt;
+        const int nw = wells.number_of_wells;
+        mapSegments(wells);
+        conc_ = conc0_;
+        // The polymer inflow is given per perforated cell, with the
+        // same value for all perforations of a well.
+        head_conc_.assign(nw, 0.0);
+        for (int w = 0; w < nw; ++w) {
+            if (wells.type[w] == INJECTOR && wells.well_connpos[w] < wells.well_connpos[w+1]) {
+                head_conc_[w] = polymer_inflow[wells.well_cells[wells.well_connpos[w]]];
+            }
+        }
+    }
+
+
+
+    void PolymerWellboreTransport::mapSegments(const Wells& wells)
+    {
+        const int nw = wells.number_of_wells;
+        const int nperf = wells.well_connpos[nw];
+        std::vector<double> conc(nperf, 0.0);
+        const WellNameIndex index(&wells);
+        for (int w0 = 0; w0 < int(well_names0_.size()); ++w0) {
+            const int w = index.index(well_names0_[w0]);
+            if (w < 0) {
+                continue;
+            }
+            for (int perf0 = connpos0_[w0]; perf0 < connpos0_[w0 + 1]; ++perf0) {
+                for (int perf = wells.well_connpos[w]; perf < wells.well_connpos[w + 1]; ++perf) {
+                    if (wells.well_cells[perf] == cells0_[perf0]) {
+                        conc[perf] = conc0_[perf0];
+                        break;
+                    }
+                }
+            }
+        }
+        conc0_.swap(conc);
+        well_names0_.resize(nw);
+        for (int w = 0; w < nw; ++w) {
+            well_names0_[w] = wells.name[w] ? wells.name[w] : "";
+        }
+        connpos0_.assign(wells.well_connpos, wells.well_connpos + nw + 1);
+        cells0_.assign(wells.well_cells, wells.well_cells + nperf);
+    }
+
+
+
+    void PolymerWellboreTransport::solve(const double* perf_water_rates,
+                                         std::vector<double>& perf_conc) const
+    {
+        if (wells_ == 0) {
+            OPM_THROW(std::logic_error, "PolymerWellboreTransport::solve() called before beginStep().");
+        }
+        const int nw = wells_->number_of_wells;
+        perf_conc.assign(wells_->well_connpos[nw], 0.0);
+        // Wells are independent, and each writes to its own
+        // perforation range only.
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (int w = 0; w < nw; ++w) {
+            if (wells_->type[w] == INJECTOR) {
+                solveWell(w, perf_water_rates, &perf_conc[0], 0);
+            }
+        }
+    }
+
+
+
+    void PolymerWellboreTransport::solve(const double* perf_water_rates,
+                                         std::vector<double>& perf_conc,
+                                         std::vector<double>& dconc_drate) const
+    {
+        if (wells_ == 0) {
+            OPM_THROW(std::logic_error, "PolymerWellboreTransport::solve() called before beginStep().");
+        }
+        const int nw = wells_->number_of_wells;
+        const int* const wpos = wells_->well_connpos;
+        std::vector<int> block_start(nw + 1, 0);
+        for (int w = 0; w < nw; ++w) {
+            const int n = wpos[w + 1] - wpos[w];
+            block_start[w + 1] = block_start[w] + n*n;
+        }
+        perf_conc.assign(wpos[nw], 0.0);
+        dconc_drate.assign(block_start[nw], 0.0);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (int w = 0; w < nw; ++w) {
+            if (wells_->type[w] == INJECTOR) {
+                solveWell(w, perf_water_rates, &perf_conc[0], &dconc_drate[0] + block_start[w]);
+            }
+        }
+    }
+
+
+
+    void PolymerWellboreTransport::solveWell(const int w,
+                                             const double* perf_water_rates,
+                                             double* perf_conc,
+                                             double* dconc_drate) const
+    {
+        const int begin = wells_->well_connpos[w];
+        const int end = wells_->well_connpos[w+1];
+        const int n = end - begin;
+
+        // Total rate entering the wellhead.
+        double q_in = 0.0;
+        for (int perf = begin; perf < end; ++perf) {
+            q_in += std::max(perf_water_rates[perf], 0.0);
+        }
+
+        // Forward substitution down the wellbore:
+        //   (V/dt + Q_i + k V) c_i = V/dt c_i^0 + Q_i c_{i-1},
+        // where Q_i is the rate entering segment i from upstream.
+        // Q_i is the sum of the injecting rates of segments i and
+        // below, so differentiating with respect to rate j gives
+        //   (V/dt + Q_i + k V) dc_i/dq_j = dQ_i/dq_j (c_{i-1} - c_i) + Q_i dc_{i-1}/dq_j.
+        // Row i of the well's derivative block is built from row i-1.
+        const double vdt = segment_volume_ / dt_;
+        const double kv = decay_rate_ * segment_volume_;
+        double c_up = head_conc_[w];
+        for (int i = 0; i < n; ++i) {
+            const int perf = begin + i;
+            const double denom = vdt + q_in + kv;
+            const double c =  (vdt*conc0_[perf] + q_in*c_up) / denom;
+            if (dconc_drate) {
+                double* row = dconc_drate + i*n;
+                const double* row_up = i > 0 ? row - n : 0;
+                for (int j = 0; j < n; ++j) {
+                    const double dq = (j >= i && perf_water_rates[begin + j] > 0.0 && q_in > 0.0) ? 1.0 : 0.0;
+                    const double dc_up = row_up ? row_up[j] : 0.0;
+                    row[j] = (dq*(c_up - c) + q_in*dc_up) / denom;
+                }
+            }
+            conc_[perf] = c;
+            perf_conc[perf] = c;
+            q_in = std::max(q_in - std::max(perf_water_rates[perf], 0.0), 0.0);
+            c_up = c;
+        }
+    }
+
+
+
+    void PolymerWellboreTransport::endStep()
+    {
+        conc0_ = conc_;
+    }
+
+} // namespace Opm
@@ -0,0 +1,123 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_POLYMERWELLBORETRANSPORT_HEADER_INCLUDED
+#define OPM_POLYMERWELLBORETRANSPORT_HEADER_INCLUDED
+
+#include <string>
+#include <vector>
+
+struct Wells;
+
+namespace Opm
+{
+
+    /// @brief Multi-segment model for polymer transport in injector wellbores.
+    ///
+    /// Each perforation of an injector is treated as one wellbore
+    /// segment, ordered from the well head along the connection
+    /// order of the Wells struct. Injected water enters the first
+    /// segment at the wellhead concentration and flows downstream,
+    /// leaving each segment partly through its perforation and partly
+    /// into the next segment. Polymer is held up in the segment
+    /// volume and degrades with a first order rate. With implicit
+    /// time discretisation and upwinding the segment equations of a
+    /// well form a lower bidiagonal system, solved by forward
+    /// substitution well by well.
+    ///
+    /// The fully implicit solvers call solve() on every Newton
+    /// iteration with the current perforation water rates, and use
+    /// the derivatives of the segment concentrations with respect to
+    /// those rates to couple the model into the reservoir Jacobian.
+    class PolymerWellboreTransport
+    {
+    public:
+        /// Constructor.
+        /// \param[in]  segment_volume  Wellbore volume per segment [m^3].
+        /// \param[in]  decay_rate      First order polymer degradation rate [1/s].
+        PolymerWellboreTransport(const double segment_volume,
+                                 const double decay_rate);
+
+        /// Prepare for a new time step. Segment concentrations are
+        /// kept from the previous step for perforations of the same
+        /// well (by name) in the same cell, so the Wells struct may be
+        /// rebuilt with wells added, removed or reordered. Other
+        /// segments start at zero.
+        /// \param[in]  wells           Wells structure.
+        /// \param[in]  polymer_inflow  Injected concentration, per cell.
+        /// \param[in]  dt              Time step size.
+        void beginStep(const Wells& wells,
+                       const std::vector<double>& polymer_inflow,
+                       const double dt);
+
+        /// Solve the segment equations for all injectors.
+        /// \param[in]  perf_water_rates  Water rates per perforation, positive
+        ///                               for flow into the reservoir.
+        /// \param[out] perf_conc         Polymer concentration of the water leaving
+        ///                               each perforation. Producer entries are zero.
+        void solve(const double* perf_water_rates,
+                   std::vector<double>& perf_conc) const;
+
+        /// Solve the segment equations for all injectors, with derivatives.
+        /// \param[in]  perf_water_rates  Water rates per perforation, positive
+        ///                               for flow into the reservoir.
+        /// \param[out] perf_conc         Polymer concentration of the water leaving
+        ///                               each perforation. Producer entries are zero.
+        /// \param[out] dconc_drate       Derivatives of perf_conc with respect to
+        ///                               perf_water_rates. For each well a dense
+        ///                               row-major block over its perforations,
+        ///                               the blocks stored in well order. Producer
+        ///                               blocks are zero.
+        void solve(const double* perf_water_rates,
+                   std::vector<double>& perf_conc,
+                   std::vector<double>& dconc_drate) const;
+
+        /// Accept the last solution as the start of the next step.
+        void endStep();
+
+        /// Segment concentrations at end of last accepted step.
+        const std::vector<double>& segmentConcentration() const { return conc0_; }
+
+    private:
+        void solveWell(const int w,
+                       const double* perf_water_rates,
+                       double* perf_conc,
+                       double* dconc_drate) const;
+        void mapSegments(const Wells& wells);
+
+        double segment_volume_;
+        double decay_rate_;
+        double dt_;
+        const Wells* wells_;
+        // Wellhead concentration, per well.
+        std::vector<double> head_conc_;
+        // Segment concentrations, per perforation.
+        std::vector<double> conc0_;
+        // Well names, connection offsets and perforation cells that
+        // conc0_ refers to.
+        std::vector<std::string> well_names0_;
+        std::vector<int> connpos0_;
+        std::vector<int> cells0_;
+        mutable std::vector<double> conc_;
+    };
+
+} // namespace Opm
+
+
+#endif // OPM_POLYMERWELLBORETRANSPORT_HEADER_INCLUDED
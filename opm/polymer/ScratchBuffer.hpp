@@ -0,0 +1,70 @@
+/*
+  Copyright 2014 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_SCRATCHBUFFER_HEADER_INCLUDED
+#define OPM_SCRATCHBUFFER_HEADER_INCLUDED
+
+#include <cstddef>
+#include <vector>
+
+namespace Opm
+{
+
+    /// @brief Scratch array reused across solver calls.
+    /// Storage is sized at construction when the size is known there,
+    /// otherwise by the first get(), and only grows if a larger size is
+    /// requested later. Every allocation is counted, so that solvers
+    /// can report whether their inner loops are allocation free.
+    template <typename T>
+    class ScratchBuffer
+    {
+    public:
+        /// Construct with storage for size elements.
+        explicit ScratchBuffer(const std::size_t size = 0)
+            : data_(size),
+              allocations_(size > 0 ? 1 : 0)
+        {
+        }
+
+        /// Storage for at least size elements. The contents are
+        /// whatever the previous user left there.
+        T* get(const std::size_t size)
+        {
+            if (size > data_.size()) {
+                data_.resize(size);
+                ++allocations_;
+            }
+            return data_.empty() ? 0 : &data_[0];
+        }
+
+        /// Number of allocations made by this buffer.
+        int allocations() const
+        {
+            return allocations_;
+        }
+
+    private:
+        std::vector<T> data_;
+        int allocations_;
+    };
+
+} // namespace Opm
+
+
+#endif // OPM_SCRATCHBUFFER_HEADER_INCLUDED
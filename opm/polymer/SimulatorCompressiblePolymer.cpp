@@ -43,14 +43,17 @@
 #include <opm/core/props/BlackoilPropertiesInterface.hpp>
 #include <opm/core/props/rock/RockCompressibility.hpp>
 
-#include <opm/core/grid/ColumnExtract.hpp>
 #include <opm/core/utility/Units.hpp>
 #include <opm/polymer/PolymerBlackoilState.hpp>
 #include <opm/core/simulator/WellState.hpp>
 #include <opm/polymer/TransportSolverTwophaseCompressiblePolymer.hpp>
+#include <opm/polymer/GravityColumns.hpp>
 #include <opm/polymer/PolymerInflow.hpp>
 #include <opm/polymer/PolymerProperties.hpp>
+#include <opm/polymer/CellRenumbering.hpp>
 #include <opm/polymer/polymerUtilities.hpp>
+#include <opm/polymer/PolymerLog.hpp>
+#include <opm/polymer/PolymerTrace.hpp>
 
 #include <boost/filesystem.hpp>
 #include <boost/scoped_ptr.hpp>
@@ -58,6 +61,7 @@
 
 #include <numeric>
 #include <fstream>
+#include <sstream>
 #include <iostream>
 
 
@@ -131,7 +135,7 @@ namespace Opm
         CompressibleTpfaPolymer psolver_;
         TransportSolverTwophaseCompressiblePolymer tsolver_;
         // Needed by column-based gravity segregation solver.
-        std::vector< std::vector<int> > columns_;
+        GravityColumns columns_;
         // Misc. data
         std::vector<int> allcells_;
     };
@@ -230,11 +234,20 @@ namespace Opm
             OPM_THROW(std::runtime_error, "Unknown method: " << method_string);
         }
         tsolver_.setPreferredMethod(method);
+        tsolver_.setAdaptiveTolerance(param.getDefault("nl_tolerance_adaptive_factor", 1.0));
         num_transport_substeps_ = param.getDefault("num_transport_substeps", 1);
         use_segregation_split_ = param.getDefault("use_segregation_split", false);
+        const bool gravity_in_sweep = param.getDefault("gravity_in_sweep", false);
+        if (use_segregation_split_ && gravity_in_sweep) {
+            OPM_THROW(std::runtime_error, "Parameters use_segregation_split and gravity_in_sweep cannot both be true.");
+        }
         if (gravity != 0 && use_segregation_split_) {
             tsolver_.initGravity(gravity);
-            extractColumn(grid_, columns_);
+            columns_ = GravityColumns(grid_);
+        }
+        if (gravity != 0 && gravity_in_sweep) {
+            tsolver_.initGravity(gravity);
+            tsolver_.setGravityInSweep(true);
         }
 
         // Misc init.
@@ -390,6 +403,7 @@ namespace Opm
 
         // Solve transport.
         transport_timer.start();
+        const long evaluations = tsolver_.residualEvaluations();
         if (num_transport_substeps_ != 1) {
             stepsize /= double(num_transport_substeps_);
             std::cout << "Making " << num_transport_substeps_ << " transport substeps." << std::endl;
@@ -427,7 +441,9 @@ namespace Opm
         }
         transport_timer.stop();
         double tt = transport_timer.secsSinceStart();
-        std::cout << "Transport solver took: " << tt << " seconds." << std::endl;
+        std::cout << "Transport solver took: " << tt << " seconds, "
+                  << tsolver_.residualEvaluations() - evaluations
+                  << " single-cell residual evaluations." << std::endl;
         ttime += tt;
 
         // Report volume balances.
@@ -441,48 +457,49 @@ namespace Opm
         tot_produced[1] += produced[1];
         tot_polyinj += polyinj;
         tot_polyprod += polyprod;
-        std::cout.precision(5);
+        std::ostringstream os;
+        os.precision(5);
         const int width = 18;
-        std::cout << "\nMass balance:        "
-            "                   water(surfvol)      oil(surfvol)       polymer(kg)\n";
-        std::cout << "    In-place:                       "
-                  << std::setw(width) << inplace_surfvol[0]
-                  << std::setw(width) << inplace_surfvol[1]
-                  << std::setw(width) << polymass << std::endl;
-        std::cout << "    Adsorbed:                       "
-                  << std::setw(width) << 0.0
-                  << std::setw(width) << 0.0
-                  << std::setw(width) << polymass_adsorbed << std::endl;
-        std::cout << "    Injected:                       "
-                  << std::setw(width) << injected[0]
-                  << std::setw(width) << injected[1]
-                  << std::setw(width) << polyinj << std::endl;
-        std::cout << "    Produced:                       "
-                  << std::setw(width) << produced[0]
-                  << std::setw(width) << produced[1]
-                  << std::setw(width) << polyprod << std::endl;
-        std::cout << "    Total inj:                      "
-                  << std::setw(width) << tot_injected[0]
-                  << std::setw(width) << tot_injected[1]
-                  << std::setw(width) << tot_polyinj << std::endl;
-        std::cout << "    Total prod:                     "
-                  << std::setw(width) << tot_produced[0]
-                  << std::setw(width) << tot_produced[1]
-                  << std::setw(width) << tot_polyprod << std::endl;
+        os << "\nMass balance:        "
+           "                   water(surfvol)      oil(surfvol)       polymer(kg)\n";
+        os << "    In-place:                       "
+           << std::setw(width) << inplace_surfvol[0]
+           << std::setw(width) << inplace_surfvol[1]
+           << std::setw(width) << polymass << '\n';
+        os << "    Adsorbed:                       "
+           << std::setw(width) << 0.0
+           << std::setw(width) << 0.0
+           << std::setw(width) << polymass_adsorbed << '\n';
+        os << "    Injected:                       "
+           << std::setw(width) << injected[0]
+           << std::setw(width) << injected[1]
+           << std::setw(width) << polyinj << '\n';
+        os << "    Produced:                       "
+           << std::setw(width) << produced[0]
+           << std::setw(width) << produced[1]
+           << std::setw(width) << polyprod << '\n';
+        os << "    Total inj:                      "
+           << std::setw(width) << tot_injected[0]
+           << std::setw(width) << tot_injected[1]
+           << std::setw(width) << tot_polyinj << '\n';
+        os << "    Total prod:                     "
+           << std::setw(width) << tot_produced[0]
+           << std::setw(width) << tot_produced[1]
+           << std::setw(width) << tot_polyprod << '\n';
         const double balance[3] = { init_surfvol[0] - inplace_surfvol[0] - tot_produced[0] + tot_injected[0],
                                     init_surfvol[1] - inplace_surfvol[1] - tot_produced[1] + tot_injected[1],
                                     init_polymass - polymass - tot_polyprod + tot_polyinj - polymass_adsorbed };
-        std::cout << "    Initial - inplace + inj - prod: "
-                  << std::setw(width) << balance[0]
-                  << std::setw(width) << balance[1]
-                  << std::setw(width) << balance[2]
-                  << std::endl;
-        std::cout << "    Relative mass error:            "
-                  << std::setw(width) << balance[0]/(init_surfvol[0] + tot_injected[0])
-                  << std::setw(width) << balance[1]/(init_surfvol[1] + tot_injected[1])
-                  << std::setw(width) << balance[2]/(init_polymass + tot_polyinj)
-                  << std::endl;
-        std::cout.precision(8);
+        os << "    Initial - inplace + inj - prod: "
+           << std::setw(width) << balance[0]
+           << std::setw(width) << balance[1]
+           << std::setw(width) << balance[2]
+           << '\n';
+        os << "    Relative mass error:            "
+           << std::setw(width) << balance[0]/(init_surfvol[0] + tot_injected[0])
+           << std::setw(width) << balance[1]/(init_surfvol[1] + tot_injected[1])
+           << std::setw(width) << balance[2]/(init_polymass + tot_polyinj)
+          ;
+        OPM_POLYMER_LOG_INFO(os.str());
 
         watercut.push(timer.simulationTimeElapsed() + timer.currentStepLength(),
                       produced[0]/(produced[0] + produced[1]),
@@ -527,6 +544,7 @@ namespace Opm
                             const int step,
                             const std::string& output_dir)
         {
+            OPM_POLYMER_TRACE_SCOPE("output");
             // Write data in VTK format.
             std::ostringstream vtkfilename;
             vtkfilename << output_dir << "/vtk_files";
@@ -559,6 +577,7 @@ namespace Opm
                                const int step,
                                const std::string& output_dir)
         {
+            OPM_POLYMER_TRACE_SCOPE("output");
             Opm::DataMap dm;
             dm["saturation"] = &state.saturation();
             dm["pressure"] = &state.pressure();
@@ -585,7 +604,9 @@ namespace Opm
                 if (!file) {
                     OPM_THROW(std::runtime_error, "Failed to open " << fname.str());
                 }
-                const std::vector<double>& d = *(it->second);
+                // Cell data in the original order if the grid was renumbered.
+                std::vector<double> d;
+                Opm::mapToOriginalOrdering(grid, *(it->second), d);
                 std::copy(d.begin(), d.end(), std::ostream_iterator<double>(file, "\n"));
             }
         }
@@ -593,6 +614,7 @@ namespace Opm
         void outputWaterCut(const Opm::Watercut& watercut,
                             const std::string& output_dir)
         {
+            OPM_POLYMER_TRACE_SCOPE("output");
             // Write water cut curve.
             std::string fname = output_dir  + "/watercut.txt";
             std::ofstream os(fname.c_str());
@@ -606,6 +628,7 @@ namespace Opm
         void outputWellReport(const Opm::WellReport& wellreport,
                               const std::string& output_dir)
         {
+            OPM_POLYMER_TRACE_SCOPE("output");
             // Write well report.
             std::string fname = output_dir  + "/wellreport.txt";
             std::ofstream os(fname.c_str());
@@ -57,9 +57,14 @@ namespace Opm
         ///     nl_pressure_maxiter (10)       max nonlinear iterations in pressure
         ///     nl_maxiter (30)                max nonlinear iterations in transport
         ///     nl_tolerance (1e-9)            transport solver absolute residual tolerance
+        ///     nl_tolerance_adaptive_factor (1.0) if above 1, scale nl_tolerance per cell
+        ///                                    by its throughput, by at most this factor
         ///     num_transport_substeps (1)     number of transport steps per pressure step
         ///     use_segregation_split (false)  solve for gravity segregation (if false,
         ///                                    segregation is ignored).
+        ///     gravity_in_sweep (false)       handle gravity within the reordered
+        ///                                    transport sweep, ordering cells by
+        ///                                    phase fluxes (excludes use_segregation_split).
         ///
         /// \param[in] grid             grid data structure
         /// \param[in] props            fluid and rock properties
@@ -44,14 +44,21 @@
 #include <opm/core/props/IncompPropertiesInterface.hpp>
 #include <opm/core/props/rock/RockCompressibility.hpp>
 
-#include <opm/core/grid/ColumnExtract.hpp>
+#include <opm/core/pressure/tpfa/trans_tpfa.h>
 #include <opm/core/utility/Units.hpp>
 #include <opm/polymer/PolymerState.hpp>
 #include <opm/core/simulator/WellState.hpp>
 #include <opm/polymer/TransportSolverTwophasePolymer.hpp>
+#include <opm/polymer/GravityColumns.hpp>
+#include <opm/polymer/ImplicitTransportSolverPolymer.hpp>
+#include <opm/polymer/SinglePointUpwindTwoPhasePolymer.hpp>
+#include <opm/polymer/TwophaseFluidPolymer.hpp>
 #include <opm/polymer/PolymerInflow.hpp>
 #include <opm/polymer/PolymerProperties.hpp>
+#include <opm/polymer/CellRenumbering.hpp>
 #include <opm/polymer/polymerUtilities.hpp>
+#include <opm/polymer/PolymerLog.hpp>
+#include <opm/polymer/PolymerTrace.hpp>
 
 #include <boost/filesystem.hpp>
 #include <boost/scoped_ptr.hpp>
@@ -59,6 +66,7 @@
 
 #include <numeric>
 #include <fstream>
+#include <sstream>
 #include <iostream>
 
 #ifdef HAVE_ERT
@@ -143,8 +151,13 @@ namespace Opm
         // Solvers
         IncompTpfaPolymer psolver_;
         TransportSolverTwophasePolymer tsolver_;
+        // Global implicit transport, used instead of tsolver_ if requested.
+        typedef SinglePointUpwindTwoPhasePolymer<TwophaseFluidPolymer> ImplicitFluxModel;
+        typedef ImplicitTransportSolverPolymer<ImplicitFluxModel, PolymerProperties> ImplicitTransportSolver;
+        boost::scoped_ptr<ImplicitFluxModel> implicit_fmodel_;
+        boost::scoped_ptr<ImplicitTransportSolver> implicit_tsolver_;
         // Needed by column-based gravity segregation solver.
-        std::vector< std::vector<int> > columns_;
+        GravityColumns columns_;
         // Misc. data
         std::vector<int> allcells_;
     };
@@ -245,15 +258,40 @@ namespace Opm
             method = Opm::TransportSolverTwophasePolymer::Bracketing;
         } else if (method_string == "Newton") {
             method = Opm::TransportSolverTwophasePolymer::Newton;
+        } else if (method_string == "TrustRegion") {
+            method = Opm::TransportSolverTwophasePolymer::TrustRegion;
         } else {
             OPM_THROW(std::runtime_error, "Unknown method: " << method_string);
         }
         tsolver_.setPreferredMethod(method);
+        tsolver_.setAdaptiveTolerance(param.getDefault("nl_tolerance_adaptive_factor", 1.0));
+        tsolver_.setAdaptiveImplicit(param.getDefault("aim_cfl_limit", 0.0));
+        tsolver_.setAndersonDepth(param.getDefault("anderson_depth", 0));
         num_transport_substeps_ = param.getDefault("num_transport_substeps", 1);
         use_segregation_split_ = param.getDefault("use_segregation_split", false);
         if (gravity != 0 && use_segregation_split_) {
             tsolver_.initGravity(gravity);
-            extractColumn(grid_, columns_);
+            columns_ = GravityColumns(grid_);
+        }
+        const std::string transport_solver = param.getDefault("transport_solver", std::string("reorder"));
+        if (transport_solver == "implicit") {
+            // The implicit flux model includes gravity, a segregation
+            // split would apply it a second time.
+            if (use_segregation_split_) {
+                OPM_THROW(std::runtime_error, "Parameter use_segregation_split cannot be true with transport_solver=implicit.");
+            }
+            std::vector<double> porevol;
+            computePorevolume(grid_, props_.porosity(), porevol);
+            implicit_fmodel_.reset(new ImplicitFluxModel(TwophaseFluidPolymer(props, poly_props),
+                                                         grid, porevol, gravity));
+            std::vector<double> htrans(grid.cell_facepos[grid.number_of_cells]);
+            tpfa_htrans_compute(const_cast<UnstructuredGrid*>(&grid), props.permeability(), &htrans[0]);
+            implicit_fmodel_->initGravityTrans(grid, htrans);
+            implicit_tsolver_.reset(new ImplicitTransportSolver(*implicit_fmodel_, poly_props, grid, linsolver,
+                                                                param.getDefault("implicit_transport_tolerance", 1e-8),
+                                                                param.getDefault("implicit_transport_maxit", 25)));
+        } else if (transport_solver != "reorder") {
+            OPM_THROW(std::runtime_error, "Unknown transport solver: " << transport_solver);
         }
 
         // Misc init.
@@ -414,6 +452,9 @@ namespace Opm
 
         // Solve transport.
         transport_timer.start();
+        const long evaluations = tsolver_.residualEvaluations();
+        int newton_its = 0;
+        int linear_its = 0;
         if (num_transport_substeps_ != 1) {
             stepsize /= double(num_transport_substeps_);
             std::cout << "Making " << num_transport_substeps_ << " transport substeps." << std::endl;
@@ -424,8 +465,15 @@ namespace Opm
         double substep_polyprod = 0.0;
         injected[0] = injected[1] = produced[0] = produced[1] = polyinj = polyprod = 0.0;
         for (int tr_substep = 0; tr_substep < num_transport_substeps_; ++tr_substep) {
-            tsolver_.solve(&state.faceflux()[0], &initial_porevol[0], &transport_src[0], &polymer_inflow_c[0], stepsize,
-                           state.saturation(), state.concentration(), state.maxconcentration());
+            if (implicit_tsolver_) {
+                implicit_tsolver_->solve(&state.faceflux()[0], &initial_porevol[0], &transport_src[0], &polymer_inflow_c[0], stepsize,
+                                         state.saturation(), state.concentration(), state.maxconcentration());
+                newton_its += implicit_tsolver_->newtonIterations();
+                linear_its += implicit_tsolver_->linearIterations();
+            } else {
+                tsolver_.solve(&state.faceflux()[0], &initial_porevol[0], &transport_src[0], &polymer_inflow_c[0], stepsize,
+                               state.saturation(), state.concentration(), state.maxconcentration());
+            }
             Opm::computeInjectedProduced(props_, poly_props_,
                                          state,
                                          transport_src, polymer_inflow_c, stepsize,
@@ -443,7 +491,15 @@ namespace Opm
         }
         transport_timer.stop();
         double tt = transport_timer.secsSinceStart();
-        std::cout << "Transport solver took: " << tt << " seconds." << std::endl;
+        if (implicit_tsolver_) {
+            std::cout << "Transport solver took: " << tt << " seconds, "
+                      << newton_its << " Newton iterations, "
+                      << linear_its << " linear iterations." << std::endl;
+        } else {
+            std::cout << "Transport solver took: " << tt << " seconds, "
+                      << tsolver_.residualEvaluations() - evaluations
+                      << " single-cell residual evaluations." << std::endl;
+        }
         ttime += tt;
 
         // Report volume balances.
@@ -456,44 +512,45 @@ namespace Opm
         tot_produced[1] += produced[1];
         tot_polyinj += polyinj;
         tot_polyprod += polyprod;
-        std::cout.precision(5);
+        std::ostringstream os;
+        os.precision(5);
         const int width = 18;
-        std::cout << "\nVolume and polymer mass balance: "
-            "   water(pv)           oil(pv)       polymer(kg)\n";
-        std::cout << "    Saturated volumes:     "
-                  << std::setw(width) << satvol[0]/tot_porevol_init
-                  << std::setw(width) << satvol[1]/tot_porevol_init
-                  << std::setw(width) << polymass << std::endl;
-        std::cout << "    Adsorbed volumes:      "
-                  << std::setw(width) << 0.0
-                  << std::setw(width) << 0.0
-                  << std::setw(width) << polymass_adsorbed << std::endl;
-        std::cout << "    Injected volumes:      "
-                  << std::setw(width) << injected[0]/tot_porevol_init
-                  << std::setw(width) << injected[1]/tot_porevol_init
-                  << std::setw(width) << polyinj << std::endl;
-        std::cout << "    Produced volumes:      "
-                  << std::setw(width) << produced[0]/tot_porevol_init
-                  << std::setw(width) << produced[1]/tot_porevol_init
-                  << std::setw(width) << polyprod << std::endl;
-        std::cout << "    Total inj volumes:     "
-                  << std::setw(width) << tot_injected[0]/tot_porevol_init
-                  << std::setw(width) << tot_injected[1]/tot_porevol_init
-                  << std::setw(width) << tot_polyinj << std::endl;
-        std::cout << "    Total prod volumes:    "
-                  << std::setw(width) << tot_produced[0]/tot_porevol_init
-                  << std::setw(width) << tot_produced[1]/tot_porevol_init
-                  << std::setw(width) << tot_polyprod << std::endl;
-        std::cout << "    In-place + prod - inj: "
-                  << std::setw(width) << (satvol[0] + tot_produced[0] - tot_injected[0])/tot_porevol_init
-                  << std::setw(width) << (satvol[1] + tot_produced[1] - tot_injected[1])/tot_porevol_init
-                  << std::setw(width) << (polymass + tot_polyprod - tot_polyinj + polymass_adsorbed) << std::endl;
-        std::cout << "    Init - now - pr + inj: "
-                  << std::setw(width) << (init_satvol[0] - satvol[0] - tot_produced[0] + tot_injected[0])/tot_porevol_init
-                  << std::setw(width) << (init_satvol[1] - satvol[1] - tot_produced[1] + tot_injected[1])/tot_porevol_init
-                  << std::setw(width) << (init_polymass - polymass - tot_polyprod + tot_polyinj - polymass_adsorbed)
-                  << std::endl;
-        std::cout.precision(8);
+        os << "\nVolume and polymer mass balance: "
+           "   water(pv)           oil(pv)       polymer(kg)\n";
+        os << "    Saturated volumes:     "
+           << std::setw(width) << satvol[0]/tot_porevol_init
+           << std::setw(width) << satvol[1]/tot_porevol_init
+           << std::setw(width) << polymass << '\n';
+        os << "    Adsorbed volumes:      "
+           << std::setw(width) << 0.0
+           << std::setw(width) << 0.0
+           << std::setw(width) << polymass_adsorbed << '\n';
+        os << "    Injected volumes:      "
+           << std::setw(width) << injected[0]/tot_porevol_init
+           << std::setw(width) << injected[1]/tot_porevol_init
+           << std::setw(width) << polyinj << '\n';
+        os << "    Produced volumes:      "
+           << std::setw(width) << produced[0]/tot_porevol_init
+           << std::setw(width) << produced[1]/tot_porevol_init
+           << std::setw(width) << polyprod << '\n';
+        os << "    Total inj volumes:     "
+           << std::setw(width) << tot_injected[0]/tot_porevol_init
+           << std::setw(width) << tot_injected[1]/tot_porevol_init
+           << std::setw(width) << tot_polyinj << '\n';
+        os << "    Total prod volumes:    "
+           << std::setw(width) << tot_produced[0]/tot_porevol_init
+           << std::setw(width) << tot_produced[1]/tot_porevol_init
+           << std::setw(width) << tot_polyprod << '\n';
+        os << "    In-place + prod - inj: "
+           << std::setw(width) << (satvol[0] + tot_produced[0] - tot_injected[0])/tot_porevol_init
+           << std::setw(width) << (satvol[1] + tot_produced[1] - tot_injected[1])/tot_porevol_init
+           << std::setw(width) << (polymass + tot_polyprod - tot_polyinj + polymass_adsorbed) << '\n';
+        os << "    Init - now - pr + inj: "
+           << std::setw(width) << (init_satvol[0] - satvol[0] - tot_produced[0] + tot_injected[0])/tot_porevol_init
+           << std::setw(width) << (init_satvol[1] - satvol[1] - tot_produced[1] + tot_injected[1])/tot_porevol_init
+           << std::setw(width) << (init_polymass - polymass - tot_polyprod + tot_polyinj - polymass_adsorbed)
+          ;
+        OPM_POLYMER_LOG_INFO(os.str());
 
         watercut.push(timer.simulationTimeElapsed() + timer.currentStepLength(),
                       produced[0]/(produced[0] + produced[1]),
@@ -541,6 +598,7 @@ namespace Opm
                             const int step,
                             const std::string& output_dir)
         {
+            OPM_POLYMER_TRACE_SCOPE("output");
             // Write data in VTK format.
             std::ostringstream vtkfilename;
             vtkfilename << output_dir << "/vtk_files";
@@ -572,6 +630,7 @@ namespace Opm
                                const int step,
                                const std::string& output_dir)
         {
+            OPM_POLYMER_TRACE_SCOPE("output");
             Opm::DataMap dm;
             dm["saturation"] = &state.saturation();
             dm["pressure"] = &state.pressure();
@@ -597,7 +656,9 @@ namespace Opm
                 if (!file) {
                     OPM_THROW(std::runtime_error, "Failed to open " << fname.str());
                 }
-                const std::vector<double>& d = *(it->second);
+                // Cell data in the original order if the grid was renumbered.
+                std::vector<double> d;
+                Opm::mapToOriginalOrdering(grid, *(it->second), d);
                 std::copy(d.begin(), d.end(), std::ostream_iterator<double>(file, "\n"));
             }
         }
@@ -607,6 +668,7 @@ namespace Opm
                                const SimulatorTimer& simtimer,
                                const std::string& output_dir)
         {
+            OPM_POLYMER_TRACE_SCOPE("output");
 #ifdef HAVE_ERT
             Opm::DataMap dm;
             dm["saturation"] = &state.saturation();
@@ -627,6 +689,7 @@ namespace Opm
         void outputWaterCut(const Opm::Watercut& watercut,
                             const std::string& output_dir)
         {
+            OPM_POLYMER_TRACE_SCOPE("output");
             // Write water cut curve.
             std::string fname = output_dir  + "/watercut.txt";
             std::ofstream os(fname.c_str());
@@ -640,6 +703,7 @@ namespace Opm
         void outputWellReport(const Opm::WellReport& wellreport,
                               const std::string& output_dir)
         {
+            OPM_POLYMER_TRACE_SCOPE("output");
             // Write well report.
             std::string fname = output_dir  + "/wellreport.txt";
             std::ofstream os(fname.c_str());
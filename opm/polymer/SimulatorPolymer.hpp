@@ -57,9 +57,21 @@ namespace Opm
         ///     nl_pressure_maxiter (10)       max nonlinear iterations in pressure
         ///     nl_maxiter (30)                max nonlinear iterations in transport
         ///     nl_tolerance (1e-9)            transport solver absolute residual tolerance
+        ///     nl_tolerance_adaptive_factor (1.0) if above 1, scale nl_tolerance per cell
+        ///                                    by its throughput, by at most this factor
+        ///     aim_cfl_limit (0.0)            if positive, update cells with a local CFL
+        ///                                    number below this limit explicitly
+        ///     anderson_depth (0)             if positive, Anderson acceleration depth for
+        ///                                    the Gauss-Seidel loops in transport
         ///     num_transport_substeps (1)     number of transport steps per pressure step
         ///     use_segregation_split (false)  solve for gravity segregation (if false,
         ///                                    segregation is ignored).
+        ///     transport_solver ("reorder")   "reorder" or "implicit" (global Newton, the
+        ///                                    linear systems are solved with linsolver,
+        ///                                    gravity is included, so use_segregation_split
+        ///                                    must be false)
+        ///     implicit_transport_tolerance (1e-8) implicit transport residual tolerance
+        ///     implicit_transport_maxit (25)  max Newton iterations in implicit transport
         ///
         /// \param[in] grid             grid data structure
         /// \param[in] props            fluid and rock properties
@@ -199,8 +199,12 @@ namespace Opm {
               store_   (g.number_of_cells,
 			g.cell_facepos[ g.number_of_cells ]),
 	      init_step_use_previous_sol_(guess_previous)   ,
-	      sat_tol_  (1e-5)
+	      sat_tol_  (1e-5)                              ,
+              allcells_ (g.number_of_cells)
         {
+            for (int c = 0; c < g.number_of_cells; ++c) {
+                allcells_[c] = c;
+            }
 
             if (gravity_) {
                 store_.drho() = fluid_.density(0) - fluid_.density(1);
@@ -272,24 +276,25 @@ namespace Opm {
 	    *Fc = 0.0;
         }
 
+        // Flux across face f, evaluated once for the face: F is the
+        // residual contribution of cell n[0] = g.face_cells[2*f], and
+        // dFd0, dFd1 its Jacobian with respect to the variables of
+        // n[0] and n[1], same layout as in fluxConnection().  The
+        // contributions to n[1] are the negated values.  Does not
+        // modify the model, so faces may be evaluated concurrently.
         template <class ReservoirState,
                   class Grid          >
         void
-        fluxConnection(const ReservoirState& state  ,
-                       const Grid&           g      ,
-                       const double          dt     ,
-                       const int             cell   ,
-                       const int             f      ,
-                       double* F                    , // F[0] = s-residual, F[1] = c-residual
-                       double* dFd1                 , //Jacobi matrix for residual with respect to variables in cell
-                       double* dFd2                   //Jacobi matrix for residual with respect to variables in OTHER cell
-                                                      //dFd1[0]= d(F[0])/d(s1), dFd1[1]= d(F[0])/d(c1), dFd1[2]= d(F[1])/d(s1), dFd1[3]= d(F[1])/d(c1),
-                                                      //dFd2[0]= d(F[0])/d(s2), dFd2[1]= d(F[0])/d(c2), dFd2[2]= d(F[1])/d(s2), dFd2[3]= d(F[1])/d(c2).
-
-		       ) const {
+        fluxFace(const ReservoirState& state  ,
+                 const Grid&           g      ,
+                 const double          dt     ,
+                 const int             f      ,
+                 double* F                    ,
+                 double* dFd0                 ,
+                 double* dFd1                 ) const {
 
             const int *n = g.face_cells + (2 * f);
-            double dflux = state.faceflux()[f];
+            const double dflux = state.faceflux()[f];
             double gflux = gravityFlux(f);
             double pcflux, dpcflux[2];
             capFlux(f, n, pcflux, dpcflux);
@@ -305,66 +310,74 @@ namespace Opm {
             double mt = m[0] + m[1];
             assert (mt >= 0.0);
 
-            double sgn  = 2.0*(n[0] == cell) - 1.0;
-            dflux      *= sgn;
-            gflux      *= sgn;
-
-
             double       f1 = m[0] / mt;
             const double v1 = dflux + m[1]*gflux;
 
-            // Assemble residual contributions
-            F[0] += dt * f1 * v1;
-            F[1] += dt * mc * f1 * v1;
-
-            // Assemble Jacobian (J1 <-> cell, J2 <-> other)
-            double *dFsds[2];
-            double *dFsdc[2];
-            double *dFcds[2];
-            double *dFcdc[2];
-            if (n[0] == cell) {
-                dFsds[0] = &dFd1[0]; dFsds[1] = &dFd2[0];
-                dFsdc[0] = &dFd1[1]; dFsdc[1] = &dFd2[1];
-                dFcds[0] = &dFd1[2]; dFcds[1] = &dFd2[2];
-                dFcdc[0] = &dFd1[3]; dFcdc[1] = &dFd2[3];
-                // sign is positive
-                dFd1[0] += sgn*dt * f1            * dpcflux[0] * m[1];
-                dFd2[0] += sgn*dt * f1            * dpcflux[1] * m[1];
-                dFd1[2] += sgn*dt * f1 * mc       * dpcflux[0] * m[1];
-                dFd2[2] += sgn*dt * f1 * mc       * dpcflux[1] * m[1];
-		// We assume that the capillary pressure is independent of the polymer concentration.
-                // Hence, no more contributions.
-            } else {
-                dFsds[0] = &dFd2[0]; dFsds[1] = &dFd1[0];
-                dFsdc[0] = &dFd2[1]; dFsdc[1] = &dFd1[1];
-                dFcds[0] = &dFd2[2]; dFcds[1] = &dFd1[2];
-                dFcdc[0] = &dFd2[3]; dFcdc[1] = &dFd1[3];
-                // sign is negative
-                dFd1[0] += sgn*dt * f1            * dpcflux[1] * m[1];
-                dFd2[0] += sgn*dt * f1            * dpcflux[0] * m[1];
-                dFd1[2] += sgn*dt * f1 * mc       * dpcflux[1] * m[1];
-                dFd2[2] += sgn*dt * f1 * mc       * dpcflux[0] * m[1];
-		// We assume that the capillary pressure is independent of the polymer concentration.
-                // Hence, no more contributions.
+            // Residual contributions
+            F[0] = dt * f1 * v1;
+            F[1] = dt * mc * f1 * v1;
+
+            // Jacobian, indexed by neighbour.  We assume that the
+            // capillary pressure is independent of the polymer
+            // concentration.
+            double* dF[2] = { dFd0, dFd1 };
+            for (int k = 0; k < 2; ++k) {
+                dF[k][0] = dt * f1      * dpcflux[k] * m[1];
+                dF[k][1] = 0.0;
+                dF[k][2] = dt * f1 * mc * dpcflux[k] * m[1];
+                dF[k][3] = 0.0;
             }
 
-            // dFs/dm_1 \cdot dm_1/ds
-            *dFsds[ pix[0] ] += dt * (1 - f1) / mt * v1      * dmds[0];
-            // dFc/dm_1 \cdot dm_1/ds
-            *dFcds[ pix[0] ] += dt * (1 - f1) / mt * v1 * mc * dmds[0];
-
-            // dFs/dm_2 \cdot dm_2/ds
-            *dFsds[ pix[1] ] -= dt * f1       / mt * v1    *      dmds[1];
-            *dFsds[ pix[1] ] += dt * f1            * gflux *      dmds[1];
-            // dFc/dm_2 \cdot dm_2/ds
-            *dFcds[ pix[1] ] -= dt * f1       / mt * v1    * mc * dmds[1];
-            *dFcds[ pix[1] ] += dt * f1            * gflux * mc * dmds[1];
-
-            // dFs/dm_1 \cdot dm_1/dc
-            *dFsdc[ pix[0] ] += dt * (1 - f1) / mt * v1      * dmobwatdc;
-            // dFc/dm_1 \cdot dm_1/dc
-            *dFcdc[ pix[0] ] += dt * (1 - f1) / mt * v1 * mc * dmobwatdc;
-            *dFcdc[ pix[0] ] += dt * f1 * v1 * dmcdc;                 // Polymer is only carried by water.
+            // dF/dm_1 \cdot dm_1/ds
+            dF[ pix[0] ][0] += dt * (1 - f1) / mt * v1      * dmds[0];
+            dF[ pix[0] ][2] += dt * (1 - f1) / mt * v1 * mc * dmds[0];
+
+            // dF/dm_2 \cdot dm_2/ds
+            dF[ pix[1] ][0] -= dt * f1       / mt * v1    *      dmds[1];
+            dF[ pix[1] ][0] += dt * f1            * gflux *      dmds[1];
+            dF[ pix[1] ][2] -= dt * f1       / mt * v1    * mc * dmds[1];
+            dF[ pix[1] ][2] += dt * f1            * gflux * mc * dmds[1];
+
+            // dF/dm_1 \cdot dm_1/dc
+            dF[ pix[0] ][1] += dt * (1 - f1) / mt * v1      * dmobwatdc;
+            dF[ pix[0] ][3] += dt * (1 - f1) / mt * v1 * mc * dmobwatdc;
+            dF[ pix[0] ][3] += dt * f1 * v1 * dmcdc;                 // Polymer is only carried by water.
+        }
+
+        template <class ReservoirState,
+                  class Grid          >
+        void
+        fluxConnection(const ReservoirState& state  ,
+                       const Grid&           g      ,
+                       const double          dt     ,
+                       const int             cell   ,
+                       const int             f      ,
+                       double* F                    , // F[0] = s-residual, F[1] = c-residual
+                       double* dFd1                 , //Jacobi matrix for residual with respect to variables in cell
+                       double* dFd2                   //Jacobi matrix for residual with respect to variables in OTHER cell
+                                                      //dFd1[0]= d(F[0])/d(s1), dFd1[1]= d(F[0])/d(c1), dFd1[2]= d(F[1])/d(s1), dFd1[3]= d(F[1])/d(c1),
+                                                      //dFd2[0]= d(F[0])/d(s2), dFd2[1]= d(F[0])/d(c2), dFd2[2]= d(F[1])/d(s2), dFd2[3]= d(F[1])/d(c2).
+
+		       ) const {
+
+            double Ff[2], J0[4], J1[4];
+            fluxFace(state, g, dt, f, Ff, J0, J1);
+
+            if (g.face_cells[2*f + 0] == cell) {
+                F[0] += Ff[0];
+                F[1] += Ff[1];
+                for (int k = 0; k < 4; ++k) {
+                    dFd1[k] += J0[k];
+                    dFd2[k] += J1[k];
+                }
+            } else {
+                F[0] -= Ff[0];
+                F[1] -= Ff[1];
+                for (int k = 0; k < 4; ++k) {
+                    dFd1[k] -= J1[k];
+                    dFd2[k] -= J0[k];
+                }
+            }
         }
 
         template <class Grid>
@@ -424,6 +437,61 @@ namespace Opm {
                 *J += dt * dflux * df;
             }
         }
+
+        // As sourceTerms(), but for both equations.  The source
+        // additionally provides ->concentration[], the polymer
+        // concentration of the inflowing water.  F[0] = s-residual,
+        // F[1] = c-residual, J as dFd1 in fluxConnection().
+        template <class Grid       ,
+                  class SourceTerms>
+        void
+        polymerSourceTerms(const Grid&        g  ,
+                           const SourceTerms* src,
+                           const int          i  ,
+                           const double       dt ,
+                           double*            J  ,
+                           double*            F  ) const {
+
+            (void) g;
+
+            double dflux = -src->flux[i]; // ->flux[] is rate of *inflow*
+
+            if (dflux < 0) {
+                // src -> cell, affects residual only.
+                const double qw = dt * dflux * src->saturation[2*i + 0];
+                F[0] += qw;
+                F[1] += qw * src->concentration[i];
+            } else {
+                // cell -> src
+                const int     cell  = src->cell[i];
+                const double* m  = store_.mob (cell);
+                const double* dm = store_.dmobds(cell);
+                const double  mc = store_.mc(cell);
+
+                const double  mt = m[0] + m[1];
+
+                assert (! ((m[0] < 0) || (m[1] < 0)));
+                assert (mt > 0);
+
+                const double f    = m[0] / mt;
+                const double dfds = ((1 - f)*dm[0] - f*dm[1]) / mt;
+                const double dfdc = (1 - f) * store_.dmobwatdc(cell) / mt;
+
+                F[0] += dt * dflux * f;
+                F[1] += dt * dflux * f * mc;
+                J[0] += dt * dflux * dfds;
+                J[1] += dt * dflux * dfdc;
+                J[2] += dt * dflux * dfds * mc;
+                J[3] += dt * dflux * (dfdc * mc + f * store_.dmcdc(cell));
+            }
+        }
+
+        template <class Grid>
+        void
+        setPoreVolume(const Grid& g, const double* porevol) {
+            std::copy(porevol, porevol + g.number_of_cells, store_.porevol());
+        }
+
         template <class Grid>
         void
         initGravityTrans(const Grid&  g    ,
@@ -495,14 +563,37 @@ namespace Opm {
         initIteration(const ReservoirState& state,
                       const Grid&           g    ,
                       JacobianSystem&       sys) {
+            return initIteration(state, g, sys, allcells_);
+        }
 
-            double s[2];
-            double mob[2];
-            double dmobds[4];
-            double dmobwatdc;
-            double c, cmax;
-            double mc, dmcdc;
-            double pc, dpc;
+        // As above, but only refresh the stored quantities of the given
+        // cells.  The cell state is gathered into contiguous arrays so
+        // that the saturation functions are evaluated in one batched
+        // call per iteration, and the results scattered back into the
+        // parameter storage.
+        template <class ReservoirState,
+                  class Grid          ,
+                  class JacobianSystem>
+        bool
+        initIteration(const ReservoirState&   state,
+                      const Grid&             g    ,
+                      JacobianSystem&         sys  ,
+                      const std::vector<int>& cells) {
+
+            (void) g;       // Suppress 'unused' warning.
+
+            const int n = cells.size();
+            if (n == 0) {
+                return true;
+            }
+            batch_s_        .resize(2*n);
+            batch_c_        .resize(n);
+            batch_cmax_     .resize(n);
+            batch_mob_      .resize(2*n);
+            batch_dmobds_   .resize(4*n);
+            batch_dmobwatdc_.resize(n);
+            batch_pc_       .resize(n);
+            batch_dpc_      .resize(n);
 
             const typename JacobianSystem::vector_type& x =
                 sys.vector().solution();
@@ -511,16 +602,17 @@ namespace Opm {
             const ::std::vector<double>& cmaxpoly = state.maxconcentration();
 
             bool in_range = true;
-            for (int cell = 0; cell < g.number_of_cells; ++cell) {
+            for (int i = 0; i < n; ++i) {
+                const int cell = cells[i];
                 // Store wat-sat, sat-change, cpoly, (sat * cpoly)-change for accumulation().
                 store_.ds(cell) = x[2*cell + 0];
-                s[0] = sat[cell*2 + 0] + x[2*cell + 0];
-                c = cpoly[cell] + x[2*cell + 1];
-                store_.sw(cell) = s[0];
+                double sw = sat[cell*2 + 0] + x[2*cell + 0];
+                const double c = cpoly[cell] + x[2*cell + 1];
+                store_.sw(cell) = sw;
                 store_.c(cell) = c;
-                cmax = std::max(c, cmaxpoly[cell]);
+                const double cmax = std::max(c, cmaxpoly[cell]);
                 store_.cmax(cell) = cmax;
-                store_.dsc(cell) = s[0]*c - sat[cell*2 + 0]*cpoly[cell];
+                store_.dsc(cell) = sw*c - sat[cell*2 + 0]*cpoly[cell];
                 double dcadsdc;
                 double cads;
                 fluid_.adsorption(cpoly[cell], cmaxpoly[cell], cads, dcadsdc);
@@ -528,35 +620,34 @@ namespace Opm {
                 fluid_.adsorption(c, cmax, cads, dcadsdc);
                 store_.dcads(cell) +=  cads;
                 store_.dcadsdc(cell) = dcadsdc;
-                double s_min = fluid_.s_min(cell);
-                double s_max = fluid_.s_max(cell);
+                fluid_.computeMc(c, store_.mc(cell), store_.dmcdc(cell));
 
-                if ( s[0] < (s_min - sat_tol_) || s[0] > (s_max + sat_tol_) ) {
-                    // if (s[0] < s_min){
-		    // 	std::cout << "Warning: s out of range, s-s_min = " << s_min-s[0] << std::endl;
-                    // }
-                    // if (s[0] > s_max){
-		    // 	std::cout << "Warning: s out of range, s-s_max = " << s[0]-s_max << std::endl;
-                    // }
+                const double s_min = fluid_.s_min(cell);
+                const double s_max = fluid_.s_max(cell);
+                if ( sw < (s_min - sat_tol_) || sw > (s_max + sat_tol_) ) {
                     in_range = false; //line search fails
                 }
-                s[0] = std::max(s_min, s[0]);
-                s[0] = std::min(s_max, s[0]);
-                s[1] = 1 - s[0];
-
-                fluid_.mobility(cell, s, c, cmax, mob, dmobds, dmobwatdc);
-                fluid_.computeMc(c, mc, dmcdc);
-                fluid_.pc(cell, s, pc, dpc);
-
-                store_.mob (cell)[0]   =  mob [0];
-                store_.mob (cell)[1]   =  mob [1];
-                store_.dmobds(cell)[0] =  dmobds[0*2 + 0];
-                store_.dmobds(cell)[1] = -dmobds[1*2 + 1];
-                store_.dmobwatdc(cell) =  dmobwatdc;
-                store_.mc(cell)        = mc;
-                store_.dmcdc(cell)     = dmcdc;
-                store_.pc(cell)        = pc;
-                store_.dpc(cell)       = dpc;
+                sw = std::max(s_min, sw);
+                sw = std::min(s_max, sw);
+                batch_s_[2*i + 0] = sw;
+                batch_s_[2*i + 1] = 1 - sw;
+                batch_c_[i]       = c;
+                batch_cmax_[i]    = cmax;
+            }
+
+            fluid_.mobility(n, &cells[0], &batch_s_[0], &batch_c_[0], &batch_cmax_[0],
+                            &batch_mob_[0], &batch_dmobds_[0], &batch_dmobwatdc_[0]);
+            fluid_.pc(n, &cells[0], &batch_s_[0], &batch_pc_[0], &batch_dpc_[0]);
+
+            for (int i = 0; i < n; ++i) {
+                const int cell = cells[i];
+                store_.mob (cell)[0]   =  batch_mob_[2*i + 0];
+                store_.mob (cell)[1]   =  batch_mob_[2*i + 1];
+                store_.dmobds(cell)[0] =  batch_dmobds_[4*i + 0*2 + 0];
+                store_.dmobds(cell)[1] = -batch_dmobds_[4*i + 1*2 + 1];
+                store_.dmobwatdc(cell) =  batch_dmobwatdc_[i];
+                store_.pc(cell)        =  batch_pc_[i];
+                store_.dpc(cell)       =  batch_dpc_[i];
             }
 	    if (!in_range) {
 		std::cout << "Warning: initIteration() - s was clamped in some cells.\n";
@@ -708,6 +799,16 @@ namespace Opm {
         polymer_reorder::ModelParameterStorage store_  ;
 	bool init_step_use_previous_sol_;
 	double sat_tol_;
+        std::vector<int>              allcells_;
+        // Gathered cell data for the batched property evaluation in initIteration().
+        std::vector<double>           batch_s_;
+        std::vector<double>           batch_c_;
+        std::vector<double>           batch_cmax_;
+        std::vector<double>           batch_mob_;
+        std::vector<double>           batch_dmobds_;
+        std::vector<double>           batch_dmobwatdc_;
+        std::vector<double>           batch_pc_;
+        std::vector<double>           batch_dpc_;
     };
 }
 #endif  /* OPM_SINGLEPOINTUPWINDTWOPHASE_HPP_HEADER */
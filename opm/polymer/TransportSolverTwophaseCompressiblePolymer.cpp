@@ -23,11 +23,15 @@
 #include <opm/core/props/BlackoilPropertiesInterface.hpp>
 #include <opm/core/grid.h>
 #include <opm/core/transport/reorder/reordersequence.h>
+#include <opm/core/transport/reorder/tarjan.h>
 #include <opm/core/utility/RootFinders.hpp>
 #include <opm/core/utility/miscUtilities.hpp>
 #include <opm/core/utility/miscUtilitiesBlackoil.hpp>
 #include <opm/core/pressure/tpfa/trans_tpfa.h>
 #include <opm/core/utility/ErrorMacros.hpp>
+#include <opm/core/utility/Units.hpp>
+#include <opm/polymer/PolymerLog.hpp>
+#include <opm/polymer/PolymerTrace.hpp>
 #include <cmath>
 #include <list>
 #include <iostream>
@@ -71,6 +75,7 @@ public:
 
 
 private:
+    void computeFaceFluxes(const double s, const double c, double& water_out, double& polymer_out) const;
     void computeResAndJacobi(const double* x, const bool if_res_s, const bool if_res_c,
                              const bool if_dres_s_dsdc, const bool if_dres_c_dsdc,
                              double* res, double* dres_s_dsdc,
@@ -95,7 +100,8 @@ public:
     mutable double last_s;
 
     ResidualCGrav(const TransportSolverTwophaseCompressiblePolymer& tmodel,
-                  const std::vector<int>& cells,
+                  const int num_cells,
+                  const int* cells,
                   const int pos,
                   const double* gravflux);
 
@@ -124,6 +130,48 @@ namespace
         return std::max(std::abs(res[0]), std::abs(res[1]));
     }
 
+    // Phase fluxes across a face with phase-wise upwinding, seen from
+    // one of its cells. The total flux v and the gravity flux g are
+    // oriented out of the cell, and the water and oil fluxes out of the
+    // cell are
+    //     flux[0] = lw*(v - g*lo)/(lw + lo),
+    //     flux[1] = lo*(v + g*lw)/(lw + lo),
+    // with lw and lo taken from the upwind cell of each phase. One of
+    // the phases always flows in the direction of v, which gives the
+    // mobility needed to find the direction of the other.
+    void phaseFluxes(const double v, const double g,
+                     const double* mob_cell, const double* mob_other,
+                     double* flux)
+    {
+        double lw;
+        double lo;
+        if (v >= 0.0) {
+            if (g <= 0.0) {
+                lw = mob_cell[0];
+                lo = (v + g*lw > 0.0) ? mob_cell[1] : mob_other[1];
+            } else {
+                lo = mob_cell[1];
+                lw = (v - g*lo > 0.0) ? mob_cell[0] : mob_other[0];
+            }
+        } else {
+            if (g >= 0.0) {
+                lw = mob_other[0];
+                lo = (v + g*lw > 0.0) ? mob_cell[1] : mob_other[1];
+            } else {
+                lo = mob_other[1];
+                lw = (v - g*lo > 0.0) ? mob_cell[0] : mob_other[0];
+            }
+        }
+        const double lt = lw + lo;
+        if (lt > 0.0) {
+            flux[0] = lw*(v - g*lo)/lt;
+            flux[1] = lo*(v + g*lw)/lt;
+        } else {
+            flux[0] = 0.0;
+            flux[1] = 0.0;
+        }
+    }
+
     // Define a piecewise linear curve along which we will look for zero of the "s" or "r" residual.
     // The curve starts at "x", goes along the direction "direction" until it hits the boundary of the box of
     // admissible values for "s" and "x" (which is given by "[x_min[0], x_max[0]]x[x_min[1], x_max[1]]").
@@ -160,6 +208,7 @@ namespace Opm
                                                                          const double tol,
                                                                          const int maxit)
         : grid_(grid),
+          stencil_(grid),
           props_(props),
           polyprops_(polyprops),
           darcyflux_(0),
@@ -177,11 +226,26 @@ namespace Opm
           fractionalflow_(grid.number_of_cells, -1.0),
           mc_(grid.number_of_cells, -1.0),
           gravity_(0),
+          gravity_in_sweep_(false),
           mob_(2*grid.number_of_cells, -1.0),
+          s0_(grid.number_of_cells),
+          c0_(grid.number_of_cells),
+          col_gravflux_(grid.number_of_cells),
           ia_upw_(grid.number_of_cells + 1, -1),
-          ja_upw_(grid.number_of_faces, -1),
+          ja_upw_(grid.cell_facepos[grid.number_of_cells], -1),
+          upw_edge_(grid.cell_facepos[grid.number_of_cells], 0),
+          cell_comp_(grid.number_of_cells, -1),
           ia_downw_(grid.number_of_cells + 1, -1),
-          ja_downw_(grid.number_of_faces, -1)
+          ja_downw_(grid.number_of_faces, -1),
+          multi_s0_(grid.number_of_cells),
+          multi_c0_(grid.number_of_cells),
+          multi_cmax0_(grid.number_of_cells),
+          seq_(grid.number_of_cells),
+          comp_(grid.number_of_cells + 1),
+          tarjan_work_(3*grid.number_of_cells),
+          neg_darcyflux_(grid.number_of_faces),
+          adaptive_tol_factor_(1.0),
+          residual_evaluations_(0)
 
     {
         const int np = props.numPhases();
@@ -199,6 +263,19 @@ namespace Opm
             allcells_[i] = i;
         }
         props.satRange(num_cells, &allcells_[0], &smin_[0], &smax_[0]);
+        if (stencil_.isCartesian()) {
+            OPM_POLYMER_LOG_DEBUG("Cartesian grid detected, using the structured face stencil.");
+        }
+
+        // Check immiscibility requirement (only done for first cell,
+        // at standard conditions).
+        const double p_std = unit::atm;
+        const double T_std = 288.15;
+        double A_std[4];
+        props.matrix(1, &p_std, &T_std, NULL, &allcells_[0], A_std, NULL);
+        if (A_std[1] != 0.0 || A_std[2] != 0.0) {
+            OPM_THROW(std::runtime_error, "TransportCompressibleSolverTwophaseCompressibleTwophase requires a property object without miscibility.");
+        }
     }
 
 
@@ -212,6 +289,28 @@ namespace Opm
 
 
 
+    void TransportSolverTwophaseCompressiblePolymer::setGravityInSweep(const bool in_sweep)
+    {
+        if (in_sweep && gravity_ == 0) {
+            OPM_THROW(std::runtime_error, "setGravityInSweep() requires initGravity() to be called first.");
+        }
+        gravity_in_sweep_ = in_sweep;
+    }
+
+
+
+
+    void TransportSolverTwophaseCompressiblePolymer::setAdaptiveTolerance(const double max_factor)
+    {
+        if (max_factor < 1.0) {
+            OPM_THROW(std::runtime_error, "Adaptive tolerance factor must be at least 1, got " << max_factor);
+        }
+        adaptive_tol_factor_ = max_factor;
+    }
+
+
+
+
     void TransportSolverTwophaseCompressiblePolymer::solve(const double* darcyflux,
                                                   const std::vector<double>& initial_pressure,
                                                   const std::vector<double>& pressure,
@@ -226,6 +325,7 @@ namespace Opm
                                                   std::vector<double>& concentration,
                                                   std::vector<double>& cmax)
     {
+        OPM_POLYMER_TRACE_SCOPE("reorder transport");
         darcyflux_ = darcyflux;
         porevolume0_ = porevolume0;
         porevolume_ = porevolume;
@@ -240,31 +340,240 @@ namespace Opm
         res_counts.clear();
 #endif
 
-        props_.viscosity(grid_.number_of_cells, &pressure[0], &temperature[0], NULL, &allcells_[0], &visc_[0], NULL);
-        props_.matrix(grid_.number_of_cells, &initial_pressure[0], &temperature[0], NULL, &allcells_[0], &A0_[0], NULL);
-        props_.matrix(grid_.number_of_cells, &pressure[0], &temperature[0], NULL, &allcells_[0], &A_[0], NULL);
+        updatePvt(initial_pressure, pressure, temperature);
 
-        // Check immiscibility requirement (only done for first cell).
-        if (A_[1] != 0.0 || A_[2] != 0.0) {
-            OPM_THROW(std::runtime_error, "TransportCompressibleSolverTwophaseCompressibleTwophase requires a property object without miscibility.");
+        const long evaluations = residual_evaluations_;
+        if (gravity_in_sweep_) {
+            reorderAndTransportWithGravity();
+        } else {
+            int* seq = seq_.get(grid_.number_of_cells);
+            int* comp = comp_.get(grid_.number_of_cells + 1);
+            int ncomp;
+            compute_sequence_graph(&grid_, darcyflux_,
+                                   seq, comp, &ncomp,
+                                   &ia_upw_[0], &ja_upw_[0]);
+            const int nf = grid_.number_of_faces;
+            double* neg_darcyflux = neg_darcyflux_.get(nf);
+            std::transform(darcyflux, darcyflux + nf, neg_darcyflux, std::negate<double>());
+            compute_sequence_graph(&grid_, neg_darcyflux,
+                                   seq, comp, &ncomp,
+                                   &ia_downw_[0], &ja_downw_[0]);
+            reorderAndTransport(grid_, darcyflux);
         }
-        std::vector<int> seq(grid_.number_of_cells);
-        std::vector<int> comp(grid_.number_of_cells + 1);
-        int ncomp;
-        compute_sequence_graph(&grid_, darcyflux_,
-                               &seq[0], &comp[0], &ncomp,
-                               &ia_upw_[0], &ja_upw_[0]);
-        const int nf = grid_.number_of_faces;
-        std::vector<double> neg_darcyflux(nf);
-        std::transform(darcyflux, darcyflux + nf, neg_darcyflux.begin(), std::negate<double>());
-        compute_sequence_graph(&grid_, &neg_darcyflux[0],
-                               &seq[0], &comp[0], &ncomp,
-                               &ia_downw_[0], &ja_downw_[0]);
-        reorderAndTransport(grid_, darcyflux);
+        OPM_POLYMER_LOG_DEBUG("Single-cell residual evaluations: "
+                              << residual_evaluations_ - evaluations);
         toBothSat(saturation_, saturation);
 
         // Compute surface volume as a postprocessing step from saturation and A_
         computeSurfacevol(grid_.number_of_cells, props_.numPhases(), &A_[0], &saturation[0], &surfacevol[0]);
+        OPM_POLYMER_LOG_DEBUG("Scratch allocations: " << scratchAllocations());
+        typedef std::map<int, std::pair<int, int> >::const_iterator StatsIt;
+        for (StatsIt it = multicell_iterations_.begin(); it != multicell_iterations_.end(); ++it) {
+            OPM_POLYMER_LOG_DEBUG("Multi-cell components of size " << it->first << ": " << it->second.first
+                                  << " solved, " << double(it->second.second)/double(it->second.first)
+                                  << " passes on average.");
+        }
+    }
+
+
+
+
+    const std::map<int, std::pair<int, int> >& TransportSolverTwophaseCompressiblePolymer::multiCellIterations() const
+    {
+        return multicell_iterations_;
+    }
+
+
+
+
+    long TransportSolverTwophaseCompressiblePolymer::residualEvaluations() const
+    {
+        return residual_evaluations_;
+    }
+
+
+
+
+    double TransportSolverTwophaseCompressiblePolymer::cellTolerance(const int cell) const
+    {
+        if (adaptive_tol_factor_ <= 1.0) {
+            return tol_;
+        }
+        double influx = std::max(source_[cell], 0.0);
+        double outflux = std::max(-source_[cell], 0.0);
+        stencil_.forEachInteriorFace(cell, [&](const int f, const int, const bool first) {
+            const double flux = first ? darcyflux_[f] : -darcyflux_[f];
+            if (flux < 0.0) {
+                influx -= flux;
+            } else {
+                outflux += flux;
+            }
+        });
+        const double throughput = dt_*std::max(influx, outflux)/porevolume_[cell];
+        const double factor = (throughput > 0.0) ? 1.0/throughput : adaptive_tol_factor_;
+        return tol_*std::min(std::max(factor, 1.0/adaptive_tol_factor_), adaptive_tol_factor_);
+    }
+
+
+
+
+    int TransportSolverTwophaseCompressiblePolymer::scratchAllocations() const
+    {
+        return s0_.allocations() + c0_.allocations() + col_gravflux_.allocations()
+            + multi_s0_.allocations() + multi_c0_.allocations() + multi_cmax0_.allocations()
+            + seq_.allocations() + comp_.allocations() + tarjan_work_.allocations()
+            + neg_darcyflux_.allocations();
+    }
+
+
+
+
+    /// Evaluate visc_ and A_ at pressure, and A0_ at initial_pressure,
+    /// unless they were already evaluated at these pressures. Within a
+    /// step (transport substeps) nothing is recomputed, and on the next
+    /// step A0_ is taken from the previous step's A_.
+    void TransportSolverTwophaseCompressiblePolymer::updatePvt(const std::vector<double>& initial_pressure,
+                                                               const std::vector<double>& pressure,
+                                                               const std::vector<double>& temperature)
+    {
+        const int nc = grid_.number_of_cells;
+        const bool A_current = (pressure == A_pressure_ && temperature == A_temperature_);
+        if (!(initial_pressure == A0_pressure_ && temperature == A0_temperature_)) {
+            if (initial_pressure == A_pressure_ && temperature == A_temperature_) {
+                A0_ = A_;
+            } else {
+                props_.matrix(nc, &initial_pressure[0], &temperature[0], NULL, &allcells_[0], &A0_[0], NULL);
+            }
+            A0_pressure_ = initial_pressure;
+            A0_temperature_ = temperature;
+        }
+        if (!A_current) {
+            props_.viscosity(nc, &pressure[0], &temperature[0], NULL, &allcells_[0], &visc_[0], NULL);
+            props_.matrix(nc, &pressure[0], &temperature[0], NULL, &allcells_[0], &A_[0], NULL);
+            A_pressure_ = pressure;
+            A_temperature_ = temperature;
+        }
+    }
+
+
+
+
+    /// Single reordered sweep with gravity. Cells are ordered by the
+    /// phase fluxes (total and gravity flux, phase-wise upwinded) of the
+    /// state at the start of the step: a cell depends on every neighbour
+    /// it receives water or oil from. Counter-current faces then give
+    /// cycles in the graph, so only those cells end up in multi-cell
+    /// blocks, and no separate segregation pass is needed.
+    ///
+    /// The single-cell residuals upwind with the current mobilities, so
+    /// a phase may change direction during the sweep. After the sweep
+    /// the upwind directions are recomputed from the final state. If a
+    /// cell then receives water or oil from a neighbour that was solved
+    /// after it, the new edges are added to the graph and the step is
+    /// swept again from the start state. Edges are only ever added, so
+    /// cells with conflicting directions end up in a common block.
+    void TransportSolverTwophaseCompressiblePolymer::reorderAndTransportWithGravity()
+    {
+        const int nc = grid_.number_of_cells;
+        const int max_sweeps = 5;
+        initGravityDynamic();
+        cmax0_.assign(cmax_, cmax_ + nc);
+        double* s0 = s0_.get(nc);
+        double* c0 = c0_.get(nc);
+        std::copy(saturation_.begin(), saturation_.end(), s0);
+        std::copy(concentration_, concentration_ + nc, c0);
+        std::fill(upw_edge_.begin(), upw_edge_.end(), 0);
+
+        int* seq = seq_.get(nc);
+        int* comp = comp_.get(nc + 1);
+        int ncomp = 0;
+        int num_multicell = 0;
+        int max_size = 0;
+        int sweep = 0;
+        bool consistent = false;
+        while (!consistent && sweep < max_sweeps) {
+            if (sweep > 0) {
+                std::copy(s0, s0 + nc, saturation_.begin());
+                std::copy(c0, c0 + nc, concentration_);
+                std::copy(cmax0_.begin(), cmax0_.end(), cmax_);
+            }
+            for (int cell = 0; cell < nc; ++cell) {
+                mobility(saturation_[cell], concentration_[cell], cell, &mob_[2*cell]);
+                computeMc(concentration_[cell], mc_[cell]);
+            }
+            if (sweep == 0) {
+                addUpwindEdges(false);
+            }
+
+            // Upwind graph, a counter-current face is an edge both ways.
+            ia_upw_[0] = 0;
+            int pos = 0;
+            for (int cell = 0; cell < nc; ++cell) {
+                int k = grid_.cell_facepos[cell];
+                stencil_.forEachInteriorFace(cell, [&](const int, const int other, const bool) {
+                    if (upw_edge_[k++]) {
+                        ja_upw_[pos++] = other;
+                    }
+                });
+                ia_upw_[cell + 1] = pos;
+            }
+            tarjan(nc, &ia_upw_[0], &ja_upw_[0], seq, comp, &ncomp, tarjan_work_.get(3*nc));
+
+            num_multicell = 0;
+            max_size = 0;
+            for (int comp_ix = 0; comp_ix < ncomp; ++comp_ix) {
+                const int comp_size = comp[comp_ix + 1] - comp[comp_ix];
+                for (int i = comp[comp_ix]; i < comp[comp_ix + 1]; ++i) {
+                    cell_comp_[seq[i]] = comp_ix;
+                }
+                if (comp_size == 1) {
+                    solveSingleCell(seq[comp[comp_ix]]);
+                } else {
+                    solveMultiCell(comp_size, &seq[comp[comp_ix]]);
+                    ++num_multicell;
+                    max_size = std::max(max_size, comp_size);
+                }
+            }
+            consistent = !addUpwindEdges(true);
+            ++sweep;
+        }
+        if (!consistent) {
+            OPM_POLYMER_LOG_WARNING("Gravity sweep: upwind directions still differ from the ordering after "
+                                    << max_sweeps << " sweeps.");
+        }
+        OPM_POLYMER_LOG_DEBUG("Gravity sweep: " << ncomp << " blocks, " << num_multicell
+                              << " multi-cell blocks, largest has " << max_size << " cells, "
+                              << sweep << " sweeps.");
+    }
+
+
+
+
+    /// Mark the upwind edges given by the current mobilities in
+    /// upw_edge_, one flag per cell face position: cell depends on a
+    /// neighbour it receives water or oil from. Edges already marked
+    /// are kept. With check_order, return true if a cell receives from
+    /// a neighbour in a later component of the last sweep.
+    bool TransportSolverTwophaseCompressiblePolymer::addUpwindEdges(const bool check_order)
+    {
+        bool out_of_order = false;
+        for (int cell = 0; cell < grid_.number_of_cells; ++cell) {
+            int k = grid_.cell_facepos[cell];
+            stencil_.forEachInteriorFace(cell, [&](const int f, const int other, const bool first) {
+                const double v = first ? darcyflux_[f] : -darcyflux_[f];
+                const double g = first ? gravflux_[f] : -gravflux_[f];
+                double flux[2];
+                phaseFluxes(v, g, &mob_[2*cell], &mob_[2*other], flux);
+                if (flux[0] < 0.0 || flux[1] < 0.0) {
+                    upw_edge_[k] = 1;
+                    if (check_order && cell_comp_[other] > cell_comp_[cell]) {
+                        out_of_order = true;
+                    }
+                }
+                ++k;
+            });
+        }
+        return out_of_order;
     }
 
 
@@ -305,8 +614,10 @@ namespace Opm
     {
         mutable double s; // Mutable in order to change it with every operator() call to be the last computed s value.
         TransportSolverTwophaseCompressiblePolymer::ResidualEquation& res_eq_;
-        explicit ResidualC(TransportSolverTwophaseCompressiblePolymer::ResidualEquation& res_eq)
-            : res_eq_(res_eq)
+        const double tol_; // Tolerance of the inner saturation solve.
+        ResidualC(TransportSolverTwophaseCompressiblePolymer::ResidualEquation& res_eq, const double tol)
+            : res_eq_(res_eq),
+              tol_(tol)
         {}
 
         void computeBothResiduals(const double s_arg, const double c_arg, double& res_s, double& res_c, double& mc, double& ff) const
@@ -328,7 +639,7 @@ namespace Opm
             // s = modifiedRegulaFalsi(res_s, std::max(tm.smin_[2*cell], dps), tm.smax_[2*cell],
             //                      tm.maxit_, tm.tol_, iters_used);
             s = RootFinder::solve(res_s, res_eq_.s0, 0.0, 1.0,
-                                  res_eq_.tm.maxit_, res_eq_.tm.tol_, iters_used);
+                                  res_eq_.tm.maxit_, tol_, iters_used);
             double x[2];
             x[0] = s;
             x[1] = c;
@@ -352,7 +663,8 @@ namespace Opm
     TransportSolverTwophaseCompressiblePolymer::ResidualEquation::ResidualEquation(TransportSolverTwophaseCompressiblePolymer& tmodel, int cell_index)
         : tm(tmodel)
     {
-        gradient_method = Analytic;
+        // The face fluxes with gravity have no analytic derivatives.
+        gradient_method = tm.gravity_in_sweep_ ? FinDif : Analytic;
         cell    = cell_index;
         const int np = tm.props_.numPhases();
         s0      = tm.saturation_[cell];
@@ -376,20 +688,12 @@ namespace Opm
         double mc;
         tm.computeMc(tm.polymer_inflow_c_[cell_index], mc);
         influx_polymer = src_is_inflow ? src_flux*mc : 0.0;
-        for (int i = tm.grid_.cell_facepos[cell]; i < tm.grid_.cell_facepos[cell+1]; ++i) {
-            int f = tm.grid_.cell_faces[i];
-            double flux;
-            int other;
-            // Compute cell flux
-            if (cell == tm.grid_.face_cells[2*f]) {
-                flux  = tm.darcyflux_[f];
-                other = tm.grid_.face_cells[2*f+1];
-            } else {
-                flux  =-tm.darcyflux_[f];
-                other = tm.grid_.face_cells[2*f];
-            }
-            // Add flux to influx or outflux, if interior.
-            if (other != -1) {
+        // Add flux to influx or outflux, over the interior faces. With
+        // gravity the face fluxes depend on the phase upwind directions
+        // and are instead evaluated in computeFaceFluxes().
+        if (!tm.gravity_in_sweep_) {
+            tm.stencil_.forEachInteriorFace(cell, [&](const int f, const int other, const bool first) {
+                const double flux = first ? tm.darcyflux_[f] : -tm.darcyflux_[f];
                 if (flux < 0.0) {
                     const double b_face =tm.A_[np*np*other+ 0];
                     influx  += B_cell*b_face*flux*tm.fractionalflow_[other];
@@ -397,7 +701,7 @@ namespace Opm
                 } else {
                     outflux += flux; // Because B_cell*b_face = 1 for outflow faces
                 }
-            }
+            });
         }
     }
 
@@ -475,6 +779,7 @@ namespace Opm
                                                                                   double* res, double* dres_s_dsdc,
                                                                                   double* dres_c_dsdc, double& mc, double& ff) const
     {
+        ++tm.residual_evaluations_;
         if ((if_dres_s_dsdc || if_dres_c_dsdc) && gradient_method == Analytic) {
             double s = x[0];
             double c = x[1];
@@ -520,8 +825,13 @@ namespace Opm
             double s = x[0];
             double c = x[1];
             tm.fracFlow(s, c, cmax0, cell, ff);
+            double water_out = 0.0;
+            double polymer_out = 0.0;
+            if (tm.gravity_in_sweep_) {
+                computeFaceFluxes(s, c, water_out, polymer_out);
+            }
             if (if_res_s) {
-                res[0] = s - B_cell/B_cell0*porosity0/porosity*s0 + dtpv*(outflux*ff + influx);
+                res[0] = s - B_cell/B_cell0*porosity0/porosity*s0 + dtpv*(outflux*ff + influx + water_out);
 #if PROFILING
                 tm.res_counts.push_back(Newton_Iter(true, cell, x[0], x[1]));
 #endif
@@ -532,7 +842,7 @@ namespace Opm
                 tm.polyprops_.adsorption(c, cmax0, ads);
                 res[1] = (1 - dps)*s*c - (1 - dps)*B_cell/B_cell0*porosity0/porosity*s0*c0
                     + rhor*B_cell/porosity*((1.0 - porosity)*ads - (1.0 - porosity0)*ads0)
-                    + dtpv*(outflux*ff*mc + influx_polymer);
+                    + dtpv*(outflux*ff*mc + influx_polymer + polymer_out);
 #if PROFILING
                 tm.res_counts.push_back(Newton_Iter(false, cell, x[0], x[1]));
 #endif
@@ -568,6 +878,36 @@ namespace Opm
         }
     }
 
+    // Net water and polymer outflux over the interior faces, with total
+    // and gravity fluxes phase-wise upwinded (see phaseFluxes()). As for
+    // the total flux, water received from a neighbour is converted with
+    // B_cell*b_face.
+    void TransportSolverTwophaseCompressiblePolymer::ResidualEquation::computeFaceFluxes(const double s, const double c,
+                                                                                   double& water_out, double& polymer_out) const
+    {
+        const int np = tm.props_.numPhases();
+        double mob[2];
+        double mc;
+        tm.mobility(s, c, cell, mob);
+        tm.computeMc(c, mc);
+        water_out = 0.0;
+        polymer_out = 0.0;
+        tm.stencil_.forEachInteriorFace(cell, [&](const int f, const int other, const bool first) {
+            const double v = first ? tm.darcyflux_[f] : -tm.darcyflux_[f];
+            const double g = first ? tm.gravflux_[f] : -tm.gravflux_[f];
+            double flux[2];
+            phaseFluxes(v, g, mob, &tm.mob_[2*other], flux);
+            if (flux[0] < 0.0) {
+                const double b_face = tm.A_[np*np*other + 0];
+                water_out += B_cell*b_face*flux[0];
+                polymer_out += flux[0]*tm.mc_[other];
+            } else {
+                water_out += flux[0];
+                polymer_out += flux[0]*mc;
+            }
+        });
+    }
+
     // Compute the "s" residual along the curve "curve" for a given residual equation "res_eq".
     // The operator() is sent to a root solver.
     class TransportSolverTwophaseCompressiblePolymer::ResSOnCurve
@@ -624,30 +964,34 @@ namespace Opm
 
     void TransportSolverTwophaseCompressiblePolymer::solveSingleCell(const int cell)
     {
+        const double tol = cellTolerance(cell);
         switch (method_) {
         case Bracketing:
-            solveSingleCellBracketing(cell);
+            solveSingleCellBracketing(cell, tol);
             break;
         case Newton:
-            solveSingleCellNewton(cell, true);
+            solveSingleCellNewton(cell, true, tol);
             break;
         case NewtonC:
-            solveSingleCellNewton(cell, false);
+            solveSingleCellNewton(cell, false, tol);
             break;
         case Gradient:
-            solveSingleCellGradient(cell);
+            solveSingleCellGradient(cell, tol);
             break;
         default:
             OPM_THROW(std::runtime_error, "Unknown method " << method_);
         }
+        if (gravity_in_sweep_) {
+            mobility(saturation_[cell], concentration_[cell], cell, &mob_[2*cell]);
+        }
     }
 
 
-    void TransportSolverTwophaseCompressiblePolymer::solveSingleCellBracketing(int cell)
+    void TransportSolverTwophaseCompressiblePolymer::solveSingleCellBracketing(int cell, const double tol)
     {
 
         ResidualEquation res_eq(*this, cell);
-        ResidualC res(res_eq);
+        ResidualC res(res_eq, tol);
         const double a = 0.0;
         const double b = polyprops_.cMax()*adhoc_safety_; // Add 10% to account for possible non-monotonicity of hyperbolic system.
         int iters_used;
@@ -656,13 +1000,13 @@ namespace Opm
         double res_sc[2];
         double mc, ff;
         res.computeBothResiduals(saturation_[cell], concentration_[cell], res_sc[0], res_sc[1], mc, ff);
-        if (norm(res_sc) < tol_) {
+        if (norm(res_sc) < tol) {
             fractionalflow_[cell] = ff;
             mc_[cell] = mc;
             return;
         }
 
-        concentration_[cell] = RootFinder::solve(res, a, b, maxit_, tol_, iters_used);
+        concentration_[cell] = RootFinder::solve(res, a, b, maxit_, tol, iters_used);
         cmax_[cell] = std::max(cmax_[cell], concentration_[cell]);
         saturation_[cell] = res.lastSaturation();
         fracFlow(saturation_[cell], concentration_[cell], cmax_[cell], cell,
@@ -675,7 +1019,7 @@ namespace Opm
     // Newton method, where we first try a Newton step. Then, if it does not work well, we look for
     // the zero of either the residual in s or the residual in c along a specified piecewise linear
     // curve. In these cases, we can use a robust 1d solver.
-    void TransportSolverTwophaseCompressiblePolymer::solveSingleCellGradient(int cell)
+    void TransportSolverTwophaseCompressiblePolymer::solveSingleCellGradient(int cell, const double tol)
     {
         int iters_used_falsi = 0;
         const int max_iters_split = maxit_;
@@ -690,7 +1034,7 @@ namespace Opm
         double x_c[2];
         scToc(x, x_c);
         res_eq.computeResidual(x_c, res, mc, ff);
-        if (norm(res) <= tol_) {
+        if (norm(res) <= tol) {
             cmax_[cell] = std::max(cmax_[cell], concentration_[cell]);
             fractionalflow_[cell] = ff;
             mc_[cell] = mc;
@@ -713,13 +1057,13 @@ namespace Opm
         ResCOnCurve res_c_on_curve(res_eq);
         bool if_res_s;
 
-        while ((norm(res) > tol_) && (iters_used_split < max_iters_split)) {
+        while ((norm(res) > tol) && (iters_used_split < max_iters_split)) {
             if (std::abs(res[0]) < std::abs(res[1])) {
-                if (res[0] < -tol_) {
+                if (res[0] < -tol) {
                     direction[0] = x_max_res_s[0] - x[0];
                     direction[1] = x_max_res_s[1] - x[1];
                     if_res_s = true;
-                } else if (res[0] > tol_) {
+                } else if (res[0] > tol) {
                     direction[0] = x_min_res_s[0] - x[0];
                     direction[1] = x_min_res_s[1] - x[1];
                     if_res_s = true;
@@ -728,7 +1072,7 @@ namespace Opm
                     res_eq.computeGradientResS(x_c, res, gradient);
                     // dResS/d(s_) = dResS/ds - c/s*dResS/ds
                     // dResS/d(sc_) = -1/s*dResS/dc
-                    if (x[0] > 1e-2*tol_) {
+                    if (x[0] > 1e-2*tol) {
                         // With s,c variables, we should have
                         // direction[0] = -gradient[1];
                         // direction[1] = gradient[0];
@@ -744,11 +1088,11 @@ namespace Opm
                     if_res_s = false;
                 }
             } else {
-                if (res[1] < -tol_) {
+                if (res[1] < -tol) {
                     direction[0] = x_max_res_sc[0] - x[0];
                     direction[1] = x_max_res_sc[1] - x[1];
                     if_res_s = false;
-                } else if (res[1] > tol_) {
+                } else if (res[1] > tol) {
                     direction[0] = x_min_res_sc[0] - x[0];
                     direction[1] = x_min_res_sc[1] - x[1];
                     if_res_s = false;
@@ -756,7 +1100,7 @@ namespace Opm
                     res_eq.computeGradientResC(x, res, gradient);
                     // dResC/d(s_) = dResC/ds - c/s*dResC/ds
                     // dResC/d(sc_) = -1/s*dResC/dc
-                    if (x[0] > 1e-2*tol_) {
+                    if (x[0] > 1e-2*tol) {
                         // With s,c variables, we should have
                         // direction[0] = -gradient[1];
                         // direction[1] = gradient[0];
@@ -777,38 +1121,38 @@ namespace Opm
                 if (res[0] < 0) {
                     end_point[0] = x_max_res_s[0];
                     end_point[1] = x_max_res_s[1];
-                    res_s_on_curve.curve.setup(x, direction, end_point, x_min, x_max, tol_, t_max, t_out);
+                    res_s_on_curve.curve.setup(x, direction, end_point, x_min, x_max, tol, t_max, t_out);
                     if (res_s_on_curve(t_out) >= 0) {
                         t_max = t_out;
                     }
                 } else {
                     end_point[0] = x_min_res_s[0];
                     end_point[1] = x_min_res_s[1];
-                    res_s_on_curve.curve.setup(x, direction, end_point, x_min, x_max, tol_, t_max, t_out);
+                    res_s_on_curve.curve.setup(x, direction, end_point, x_min, x_max, tol, t_max, t_out);
                     if (res_s_on_curve(t_out) <= 0) {
                         t_max = t_out;
                     }
                 }
                 // Note: In some experiments modifiedRegularFalsi does not yield a result under the given tolerance.
-                t = RootFinder::solve(res_s_on_curve, 0., t_max, maxit_, tol_, iters_used_falsi);
+                t = RootFinder::solve(res_s_on_curve, 0., t_max, maxit_, tol, iters_used_falsi);
                 res_s_on_curve.curve.computeXOfT(x, t);
             } else {
                 if (res[1] < 0) {
                     end_point[0] = x_max_res_sc[0];
                     end_point[1] = x_max_res_sc[1];
-                    res_c_on_curve.curve.setup(x, direction, end_point, x_min, x_max, tol_, t_max, t_out);
+                    res_c_on_curve.curve.setup(x, direction, end_point, x_min, x_max, tol, t_max, t_out);
                     if (res_c_on_curve(t_out) >= 0) {
                         t_max = t_out;
                     }
                 } else {
                     end_point[0] = x_min_res_sc[0];
                     end_point[1] = x_min_res_sc[1];
-                    res_c_on_curve.curve.setup(x, direction, end_point, x_min, x_max, tol_, t_max, t_out);
+                    res_c_on_curve.curve.setup(x, direction, end_point, x_min, x_max, tol, t_max, t_out);
                     if (res_c_on_curve(t_out) <= 0) {
                         t_max = t_out;
                     }
                 }
-                t = RootFinder::solve(res_c_on_curve, 0., t_max, maxit_, tol_, iters_used_falsi);
+                t = RootFinder::solve(res_c_on_curve, 0., t_max, maxit_, tol, iters_used_falsi);
                 res_c_on_curve.curve.computeXOfT(x, t);
 
             }
@@ -819,9 +1163,9 @@ namespace Opm
 
 
 
-        if ((iters_used_split >=  max_iters_split) && (norm(res) > tol_)) {
+        if ((iters_used_split >=  max_iters_split) && (norm(res) > tol)) {
             OPM_MESSAGE("Newton for single cell did not work in cell number " << cell);
-            solveSingleCellBracketing(cell);
+            solveSingleCellBracketing(cell, tol);
         } else {
             scToc(x, x_c);
             concentration_[cell] = x_c[1];
@@ -833,6 +1177,7 @@ namespace Opm
     }
 
     void TransportSolverTwophaseCompressiblePolymer::solveSingleCellNewton(int cell, bool use_sc,
+                                                                  const double tol,
                                                                   bool use_explicit_step)
     {
         const int max_iters_split = maxit_;
@@ -845,7 +1190,7 @@ namespace Opm
         double mc;
         double ff;
         res_eq.computeResidual(x, res, mc, ff);
-        if (norm(res) <= tol_) {
+        if (norm(res) <= tol) {
             cmax_[cell] = std::max(cmax_[cell], concentration_[cell]);
             fractionalflow_[cell] = ff;
             mc_[cell] = mc;
@@ -900,7 +1245,7 @@ namespace Opm
         double dFy_dx;
         double dFy_dy;
 
-        while ((norm(res) > tol_) &&
+        while ((norm(res) > tol) &&
                (iters_used_split < max_iters_split)  &&
                successfull_newton_step) {
             double dres_s_dsdc[2];
@@ -912,8 +1257,8 @@ namespace Opm
                 // The computation of the Jacobi fails for s=0 (we have an undetermined fraction 0/0).
                 // When s is close to zero we replace x_c with x_c_app as defined now.
                 x_c_app[1] = x_c[1];
-                if (x_c[0] < 1e-2*tol_) {
-                    x_c_app[0] = 1e-2*tol_;
+                if (x_c[0] < 1e-2*tol) {
+                    x_c_app[0] = 1e-2*tol;
                 } else {
                     x_c_app[0] = x_c[0];
                 }
@@ -965,9 +1310,9 @@ namespace Opm
             }
         }
 
-        if ((iters_used_split >=  max_iters_split) && (norm(res) > tol_)) {
+        if ((iters_used_split >=  max_iters_split) && (norm(res) > tol)) {
             OPM_MESSAGE("Newton for single cell did not work in cell number " << cell);
-            solveSingleCellBracketing(cell);
+            solveSingleCellBracketing(cell, tol);
         } else {
             concentration_[cell] = x[1];
             cmax_[cell] = std::max(cmax_[cell], concentration_[cell]);
@@ -984,9 +1329,9 @@ namespace Opm
         double max_c_change = 0.0;
         int num_iters = 0;
         // Must store state variables before we start.
-        std::vector<double> s0(num_cells);
-        std::vector<double> c0(num_cells);
-        std::vector<double> cmax0(num_cells);
+        double* s0 = multi_s0_.get(num_cells);
+        double* c0 = multi_c0_.get(num_cells);
+        double* cmax0 = multi_cmax0_.get(num_cells);
         // Must set initial fractional flows etc. before we start.
         for (int i = 0; i < num_cells; ++i) {
             const int cell = cells[i];
@@ -995,7 +1340,7 @@ namespace Opm
             computeMc(concentration_[cell], mc_[cell]);
             s0[i] = saturation_[cell];
             c0[i] = concentration_[cell];
-            cmax0[i] = cmax_[i];
+            cmax0[i] = cmax_[cell];
         }
         do {
             // int max_s_change_cell = -1;
@@ -1023,6 +1368,9 @@ namespace Opm
             // std::cout << "Iter = " << num_iters << "    max_s_change = " << max_s_change
             //        << "    in cell " << max_change_cell << std::endl;
         } while (((max_s_change > tol_) || (max_c_change > tol_)) && ++num_iters < maxit_);
+        std::pair<int, int>& stats = multicell_iterations_[num_cells];
+        ++stats.first;
+        stats.second += std::min(num_iters + 1, int(maxit_));
         if (max_s_change > tol_) {
             OPM_THROW(std::runtime_error, "In solveMultiCell(), we did not converge after "
                   << num_iters << " iterations. Delta s = " << max_s_change);
@@ -1117,7 +1465,8 @@ namespace Opm
     // Influxes are negative, outfluxes positive.
 
     TransportSolverTwophaseCompressiblePolymer::ResidualCGrav::ResidualCGrav(const TransportSolverTwophaseCompressiblePolymer& tmodel,
-                                                                    const std::vector<int>& cells,
+                                                                    const int num_cells,
+                                                                    const int* cells,
                                                                     const int pos,
                                                                     const double* gravflux) // Always oriented towards next in column. Size = colsize - 1.
         : tm(tmodel),
@@ -1141,7 +1490,7 @@ namespace Opm
         }
         nbcell[1] = -1;
         gf[1] = 0.0;
-        if (pos < int(cells.size() - 1)) {
+        if (pos < num_cells - 1) {
             nbcell[1] = cells[pos + 1];
             gf[1] = gravflux[pos];
         }
@@ -1279,12 +1628,13 @@ namespace Opm
     }
 
 
-    void TransportSolverTwophaseCompressiblePolymer::solveSingleCellGravity(const std::vector<int>& cells,
+    void TransportSolverTwophaseCompressiblePolymer::solveSingleCellGravity(const int num_cells,
+                                                                   const int* cells,
                                                                    const int pos,
                                                                    const double* gravflux)
     {
         const int cell = cells[pos];
-        ResidualCGrav res_c(*this, cells, pos, gravflux);
+        ResidualCGrav res_c(*this, num_cells, cells, pos, gravflux);
 
         // Check if current state is an acceptable solution.
         double res_sc[2];
@@ -1306,31 +1656,27 @@ namespace Opm
         mobility(saturation_[cell], concentration_[cell], cell, &mob_[2*cell]);
     }
 
-    int TransportSolverTwophaseCompressiblePolymer::solveGravityColumn(const std::vector<int>& cells)
+    int TransportSolverTwophaseCompressiblePolymer::solveGravityColumn(const int nc, const int* cells)
     {
         // Set up column gravflux.
-        const int nc = cells.size();
-        std::vector<double> col_gravflux(nc - 1);
+        double* col_gravflux = col_gravflux_.get(nc);
         for (int ci = 0; ci < nc - 1; ++ci) {
             const int cell = cells[ci];
             const int next_cell = cells[ci + 1];
-            for (int j = grid_.cell_facepos[cell]; j < grid_.cell_facepos[cell+1]; ++j) {
-                const int face = grid_.cell_faces[j];
-                const int c1 = grid_.face_cells[2*face + 0];
-                const int c2 = grid_.face_cells[2*face + 1];
-                if (c1 == next_cell || c2 == next_cell) {
+            stencil_.forEachInteriorFace(cell, [&](const int face, const int other, const bool first) {
+                if (other == next_cell) {
                     const double gf = gravflux_[face];
-                    col_gravflux[ci] = (c1 == cell) ? gf : -gf;
+                    col_gravflux[ci] = first ? gf : -gf;
                 }
-            }
+            });
         }
 
         // Store initial saturation s0
-        s0_.resize(nc);
-        c0_.resize(nc);
+        double* s0 = s0_.get(nc);
+        double* c0 = c0_.get(nc);
         for (int ci = 0; ci < nc; ++ci) {
-            s0_[ci] = saturation_[cells[ci]];
-            c0_[ci] = concentration_[cells[ci]];
+            s0[ci] = saturation_[cells[ci]];
+            c0[ci] = concentration_[cells[ci]];
         }
 
         // Solve single cell problems, repeating if necessary.
@@ -1344,12 +1690,12 @@ namespace Opm
                                     saturation_[cells[ci2]] };
                 double old_c[2] = { concentration_[cells[ci]],
                                     concentration_[cells[ci2]] };
-                saturation_[cells[ci]] = s0_[ci];
-                concentration_[cells[ci]] = c0_[ci];
-                solveSingleCellGravity(cells, ci, &col_gravflux[0]);
-                saturation_[cells[ci2]] = s0_[ci2];
-                concentration_[cells[ci2]] = c0_[ci2];
-                solveSingleCellGravity(cells, ci2, &col_gravflux[0]);
+                saturation_[cells[ci]] = s0[ci];
+                concentration_[cells[ci]] = c0[ci];
+                solveSingleCellGravity(nc, cells, ci, col_gravflux);
+                saturation_[cells[ci2]] = s0[ci2];
+                concentration_[cells[ci2]] = c0[ci2];
+                solveSingleCellGravity(nc, cells, ci2, col_gravflux);
                 max_sc_change = std::max(max_sc_change, 0.25*(std::fabs(saturation_[cells[ci]] - old_s[0]) +
                                                               std::fabs(concentration_[cells[ci]] - old_c[0]) +
                                                               std::fabs(saturation_[cells[ci2]] - old_s[1]) +
@@ -1366,13 +1712,14 @@ namespace Opm
     }
 
 
-    void TransportSolverTwophaseCompressiblePolymer::solveGravity(const std::vector<std::vector<int> >& columns,
+    void TransportSolverTwophaseCompressiblePolymer::solveGravity(const GravityColumns& columns,
                                                          const double dt,
                                                          std::vector<double>& saturation,
                                                          std::vector<double>& surfacevol,
                                                          std::vector<double>& concentration,
                                                          std::vector<double>& cmax)
     {
+        OPM_POLYMER_TRACE_SCOPE("gravity split");
 
         // Assume that solve() has already been called, so that A_ and
         // porosity_ are current.
@@ -1398,13 +1745,13 @@ namespace Opm
 
         // Solve on all columns.
         int num_iters = 0;
-        // std::cout << "Gauss-Seidel column solver # columns: " << columns.size() << std::endl;
-        for (std::vector<std::vector<int> >::size_type i = 0; i < columns.size(); i++) {
-            // std::cout << "==== new column" << std::endl;
-            num_iters += solveGravityColumn(columns[i]);
+        const int num_columns = columns.numColumns();
+        for (int i = 0; i < num_columns; ++i) {
+            num_iters += solveGravityColumn(columns.columnSize(i), columns.columnCells(i));
         }
-        std::cout << "Gauss-Seidel column solver average iterations: "
-                  << double(num_iters)/double(columns.size()) << std::endl;
+        OPM_POLYMER_LOG_INFO("Gauss-Seidel column solver average iterations: "
+                             << double(num_iters)/double(num_columns));
+        OPM_POLYMER_LOG_DEBUG("Scratch allocations: " << scratchAllocations());
 
         toBothSat(saturation_, saturation);
         // Compute surface volume as a postprocessing step from saturation and A_
@@ -21,10 +21,14 @@
 #define OPM_TRANSPORTSOLVERTWOPHASECOMPRESSIBLEPOLYMER_HEADER_INCLUDED
 
 #include <opm/polymer/PolymerProperties.hpp>
+#include <opm/polymer/CellStencil.hpp>
+#include <opm/polymer/GravityColumns.hpp>
+#include <opm/polymer/ScratchBuffer.hpp>
 #include <opm/core/transport/reorder/ReorderSolverInterface.hpp>
 #include <opm/core/utility/linearInterpolation.hpp>
 #include <vector>
 #include <list>
+#include <map>
 
 struct UnstructuredGrid;
 
@@ -69,6 +73,22 @@ namespace Opm
 	/// Set the preferred method, Bracketing or Newton.
         void setPreferredMethod(SingleCellMethod method);
 
+        /// Handle gravity within the reordered sweep of solve(), instead
+        /// of with a separate solveGravity() pass. Cells are then ordered
+        /// by phase-wise upwinded fluxes including gravity, and only
+        /// cells coupled by counter-current flow are solved together.
+        /// Requires initGravity() to have been called.
+        void setGravityInSweep(const bool in_sweep);
+
+        /// Use a per-cell tolerance in the single-cell solves: the
+        /// tolerance divided by the cell's throughput (dt times its
+        /// in- or outflux over its pore volume), kept within
+        /// [tol/max_factor, tol*max_factor]. Cells with little flow
+        /// through them get a looser tolerance, cells with high
+        /// throughput, such as near injectors, a tighter one. With
+        /// max_factor = 1 (the default) tol is used everywhere.
+        void setAdaptiveTolerance(const double max_factor);
+
 	/// Solve for saturation, concentration and cmax at next timestep.
 	/// Using implicit Euler scheme, reordered.
 	/// \param[in] darcyflux           Array of signed face fluxes.
@@ -112,26 +132,38 @@ namespace Opm
         /// It assumes that the input columns contain cells in a single
         /// vertical stack, that do not interact with other columns (for
         /// gravity segregation.
-	/// \param[in] columns             Vector of cell-columns.
+	/// \param[in] columns             Cell columns.
 	/// \param[in] dt                  Time step.
 	/// \param[in, out] saturation     Phase saturations.
 	/// \param[in, out] surfacevol     Surface volumes.
 	/// \param[in, out] concentration  Polymer concentration.
 	/// \param[in, out] cmax           Highest concentration that has occured in a given cell.
-        void solveGravity(const std::vector<std::vector<int> >& columns,
+        void solveGravity(const GravityColumns& columns,
                           const double dt,
                           std::vector<double>& saturation,
                           std::vector<double>& surfacevol,
                           std::vector<double>& concentration,
                           std::vector<double>& cmax);
 
-        
+        /// Number of scratch buffer allocations made so far, including
+        /// the initial ones at construction. Stays constant over calls
+        /// to solve() and solveGravity().
+        int scratchAllocations() const;
+
+        /// Multi-cell component statistics since construction: for each
+        /// component size, the number of components solved and their
+        /// total number of Gauss-Seidel passes.
+        const std::map<int, std::pair<int, int> >& multiCellIterations() const;
+
+        /// Number of single-cell residual evaluations since construction.
+        long residualEvaluations() const;
 
 
 
     private: 
 
 	const UnstructuredGrid& grid_;
+	CellStencil stencil_;
 	const BlackoilPropertiesInterface& props_;
 	const PolymerProperties& polyprops_;
 	const double* darcyflux_;   // one flux per grid face
@@ -154,11 +186,17 @@ namespace Opm
         std::vector<double> visc_; // viscosity (without polymer, for given pressure)
         std::vector<double> A_;
         std::vector<double> A0_;
+        // Pressures and temperatures visc_, A_ and A0_ were evaluated at.
+        std::vector<double> A_pressure_;
+        std::vector<double> A_temperature_;
+        std::vector<double> A0_pressure_;
+        std::vector<double> A0_temperature_;
 	std::vector<double> smin_;
 	std::vector<double> smax_;
 	
         // For gravity segregation.
         const double* gravity_;
+        bool gravity_in_sweep_;
         std::vector<double> trans_;
         std::vector<double> density_;
         std::vector<double> gravflux_;
@@ -166,14 +204,33 @@ namespace Opm
         std::vector<double> cmax0_;
 
         // For gravity segregation, column variables
-        std::vector<double> s0_;
-        std::vector<double> c0_;
-
-        // Storing the upwind and downwind graphs for experiments.
+        ScratchBuffer<double> s0_;
+        ScratchBuffer<double> c0_;
+        ScratchBuffer<double> col_gravflux_;
+
+        // Upwind and downwind graphs. With gravity in the sweep, the
+        // upwind graph is the one used for ordering, built from a flag
+        // per cell face position (see addUpwindEdges()), and the
+        // component of each cell is kept to check the order.
         std::vector<int> ia_upw_;
         std::vector<int> ja_upw_;
+        std::vector<char> upw_edge_;
+        std::vector<int> cell_comp_;
         std::vector<int> ia_downw_;
         std::vector<int> ja_downw_;
+        // For multi-cell components, state at start of iteration
+        ScratchBuffer<double> multi_s0_;
+        ScratchBuffer<double> multi_c0_;
+        ScratchBuffer<double> multi_cmax0_;
+        std::map<int, std::pair<int, int> > multicell_iterations_;
+        // For ordering
+        ScratchBuffer<int> seq_;
+        ScratchBuffer<int> comp_;
+        ScratchBuffer<int> tarjan_work_;
+        ScratchBuffer<double> neg_darcyflux_;
+        // For adaptive tolerances.
+        double adaptive_tol_factor_;
+        long residual_evaluations_;
         
 	struct ResidualC;
 	struct ResidualS;
@@ -192,15 +249,23 @@ namespace Opm
 
 	virtual void solveSingleCell(const int cell);
 	virtual void solveMultiCell(const int num_cells, const int* cells);
-	void solveSingleCellBracketing(int cell);
-	void solveSingleCellNewton(int cell, bool use_sc, bool use_explicit_step = false);
-	void solveSingleCellGradient(int cell);
-        void solveSingleCellGravity(const std::vector<int>& cells,
+	// The single-cell solvers take the tolerance of the cell, see
+	// cellTolerance().
+	void solveSingleCellBracketing(int cell, const double tol);
+	void solveSingleCellNewton(int cell, bool use_sc, const double tol, bool use_explicit_step = false);
+	void solveSingleCellGradient(int cell, const double tol);
+        void solveSingleCellGravity(const int num_cells,
+                                    const int* cells,
                                     const int pos,
                                     const double* gravflux);
-        int solveGravityColumn(const std::vector<int>& cells);
+        int solveGravityColumn(const int num_cells, const int* cells);
 
         void initGravityDynamic();
+        void reorderAndTransportWithGravity();
+        bool addUpwindEdges(const bool check_order);
+        void updatePvt(const std::vector<double>& initial_pressure,
+                       const std::vector<double>& pressure,
+                       const std::vector<double>& temperature);
 
 	void fracFlow(double s, double c, double cmax, int cell, double& ff) const;
 	void fracFlowWithDer(double s, double c, double cmax, int cell, double& ff,
@@ -210,6 +275,7 @@ namespace Opm
 	void computeMc(double c, double& mc) const;
 	void computeMcWithDer(double c, double& mc, double& dmc_dc) const;
         void mobility(double s, double c, int cell, double* mob) const;
+        double cellTolerance(const int cell) const;
         void scToc(const double* x, double* x_c) const;
         #ifdef PROFILING
         class Newton_Iter {
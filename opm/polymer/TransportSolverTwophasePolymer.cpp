@@ -27,6 +27,8 @@
 #include <opm/core/utility/miscUtilities.hpp>
 #include <opm/core/pressure/tpfa/trans_tpfa.h>
 #include <opm/core/utility/ErrorMacros.hpp>
+#include <opm/polymer/PolymerLog.hpp>
+#include <opm/polymer/PolymerTrace.hpp>
 #include <cmath>
 #include <list>
 #include <iostream>
@@ -87,7 +89,8 @@ public:
     mutable double last_s;
 
     ResidualCGrav(const TransportSolverTwophasePolymer& tmodel,
-                  const std::vector<int>& cells,
+                  const int num_cells,
+                  const int* cells,
                   const int pos,
                   const double* gravflux);
 
@@ -184,6 +187,7 @@ namespace Opm
 						 const double tol,
 						 const int maxit)
 	: grid_(grid),
+	  stencil_(grid),
 	  porosity_(props.porosity()),
 	  porevolume_(NULL),
 	  props_(props),
@@ -199,12 +203,34 @@ namespace Opm
 	  fractionalflow_(grid.number_of_cells, -1.0),
 	  mc_(grid.number_of_cells, -1.0),
 	  method_(method),
-	  adhoc_safety_(1.1) 
+	  adhoc_safety_(1.1),
+	  s0_(grid.number_of_cells),
+	  c0_(grid.number_of_cells),
+	  col_gravflux_(grid.number_of_cells),
+	  multi_s0_(grid.number_of_cells),
+	  multi_c0_(grid.number_of_cells),
+	  multi_cmax0_(grid.number_of_cells),
+	  adaptive_tol_factor_(1.0),
+	  residual_evaluations_(0),
+	  trust_region_solves_(0),
+	  trust_region_failures_(0),
+	  polymer_mass_error_(0.0),
+	  aim_cfl_limit_(0.0),
+	  explicit_cells_(0),
+	  old_s_(grid.number_of_cells),
+	  old_c_(grid.number_of_cells),
+	  old_cmax_(grid.number_of_cells),
+	  anderson_(0, 2*grid.number_of_cells),
+	  anderson_x_(2*grid.number_of_cells),
+	  anderson_gx_(2*grid.number_of_cells)
     {
 	if (props.numPhases() != 2) {
 	    OPM_THROW(std::runtime_error, "Property object must have 2 phases");
 	}
 	visc_ = props.viscosity();
+        if (stencil_.isCartesian()) {
+            OPM_POLYMER_LOG_DEBUG("Cartesian grid detected, using the structured face stencil.");
+        }
 
 #ifdef PROFILING
         res_counts.clear();
@@ -232,6 +258,36 @@ namespace Opm
 
 
 
+    void TransportSolverTwophasePolymer::setAdaptiveTolerance(const double max_factor)
+    {
+        if (max_factor < 1.0) {
+            OPM_THROW(std::runtime_error, "Adaptive tolerance factor must be at least 1, got " << max_factor);
+        }
+        adaptive_tol_factor_ = max_factor;
+    }
+
+
+
+
+    void TransportSolverTwophasePolymer::setAdaptiveImplicit(const double cfl_limit)
+    {
+        if (cfl_limit < 0.0 || cfl_limit > 1.0) {
+            OPM_THROW(std::runtime_error, "Adaptive-implicit CFL limit must be in [0, 1], got " << cfl_limit);
+        }
+        aim_cfl_limit_ = cfl_limit;
+    }
+
+
+
+
+    void TransportSolverTwophasePolymer::setAndersonDepth(const int depth)
+    {
+        anderson_.setDepth(depth);
+    }
+
+
+
+
     void TransportSolverTwophasePolymer::solve(const double* darcyflux,
                                       const double* porevolume,
 				      const double* source,
@@ -241,6 +297,7 @@ namespace Opm
 				      std::vector<double>& concentration,
 				      std::vector<double>& cmax)
     {
+        OPM_POLYMER_TRACE_SCOPE("reorder transport");
 	darcyflux_ = darcyflux;
         porevolume_ = porevolume;
 	source_ = source;
@@ -252,8 +309,176 @@ namespace Opm
 #if PROFILING
         res_counts.clear();
 #endif
+        const int nc = grid_.number_of_cells;
+        const long evaluations = residual_evaluations_;
+        const long tr_solves = trust_region_solves_;
+        const long tr_failures = trust_region_failures_;
+        explicit_cells_ = 0;
+        // The mass balance takes extra passes over the grid, so it is
+        // only computed to judge adaptive tolerances or for debug output.
+        const bool check_mass = adaptive_tol_factor_ > 1.0 || PolymerLog::enabled(PolymerLog::Debug);
+        double mass0 = 0.0;
+        if (check_mass) {
+            std::copy(saturation_.begin(), saturation_.end(), old_s_.get(nc));
+            std::copy(cmax_, cmax_ + nc, old_cmax_.get(nc));
+            std::copy(concentration_, concentration_ + nc, old_c_.get(nc));
+            mass0 = polymerMass(old_s_.get(nc), old_c_.get(nc), old_cmax_.get(nc));
+        }
         reorderAndTransport(grid_, darcyflux);
+        polymer_mass_error_ = 0.0;
+        if (check_mass) {
+            // Adsorption is evaluated with cmax from the start of the
+            // step, as in the residuals.
+            polymer_mass_error_ = polymerMass(&saturation_[0], concentration_, old_cmax_.get(nc))
+                - mass0 - polymerSourceMass(old_cmax_.get(nc));
+            OPM_POLYMER_LOG_DEBUG("Single-cell residual evaluations: " << residual_evaluations_ - evaluations
+                                  << ", polymer mass balance error: " << polymer_mass_error_
+                                  << " (initial mass " << mass0 << ")");
+        }
+        if (trust_region_solves_ > tr_solves) {
+            OPM_POLYMER_LOG_DEBUG("Trust-region single-cell solves: " << trust_region_solves_ - tr_solves
+                                  << ", fallbacks to bracketing: " << trust_region_failures_ - tr_failures);
+        }
+        if (aim_cfl_limit_ > 0.0) {
+            OPM_POLYMER_LOG_DEBUG("Explicitly updated cells: " << explicit_cells_
+                                  << " of " << nc);
+        }
         toBothSat(saturation_, saturation);
+        OPM_POLYMER_LOG_DEBUG("Scratch allocations: " << scratchAllocations());
+        typedef std::map<int, std::pair<int, int> >::const_iterator StatsIt;
+        for (StatsIt it = multicell_iterations_.begin(); it != multicell_iterations_.end(); ++it) {
+            OPM_POLYMER_LOG_DEBUG("Multi-cell components of size " << it->first << ": " << it->second.first
+                                  << " solved, " << double(it->second.second)/double(it->second.first)
+                                  << " passes on average.");
+        }
+        logAnderson();
+    }
+
+
+
+
+    const std::map<int, std::pair<int, int> >& TransportSolverTwophasePolymer::multiCellIterations() const
+    {
+        return multicell_iterations_;
+    }
+
+
+
+
+    long TransportSolverTwophasePolymer::residualEvaluations() const
+    {
+        return residual_evaluations_;
+    }
+
+
+
+
+    std::pair<long, long> TransportSolverTwophasePolymer::trustRegionSolves() const
+    {
+        return std::make_pair(trust_region_solves_, trust_region_failures_);
+    }
+
+
+
+
+    double TransportSolverTwophasePolymer::polymerMassError() const
+    {
+        return polymer_mass_error_;
+    }
+
+
+
+
+    int TransportSolverTwophasePolymer::explicitCells() const
+    {
+        return explicit_cells_;
+    }
+
+
+
+
+    double TransportSolverTwophasePolymer::cellTolerance(const int cell) const
+    {
+        if (adaptive_tol_factor_ <= 1.0) {
+            return tol_;
+        }
+        double influx = std::max(source_[cell], 0.0);
+        double outflux = std::max(-source_[cell], 0.0);
+        stencil_.forEachInteriorFace(cell, [&](const int f, const int, const bool first) {
+            const double flux = first ? darcyflux_[f] : -darcyflux_[f];
+            if (flux < 0.0) {
+                influx -= flux;
+            } else {
+                outflux += flux;
+            }
+        });
+        const double throughput = dt_*std::max(influx, outflux)/porevolume_[cell];
+        const double factor = (throughput > 0.0) ? 1.0/throughput : adaptive_tol_factor_;
+        return tol_*std::min(std::max(factor, 1.0/adaptive_tol_factor_), adaptive_tol_factor_);
+    }
+
+
+
+
+    /// Dissolved and adsorbed polymer mass.
+    double TransportSolverTwophasePolymer::polymerMass(const double* s, const double* c, const double* cmax) const
+    {
+        const double dps = polyprops_.deadPoreVol();
+        const double rhor = polyprops_.rockDensity();
+        double mass = 0.0;
+        for (int cell = 0; cell < grid_.number_of_cells; ++cell) {
+            double ads;
+            polyprops_.adsorption(c[cell], cmax[cell], ads);
+            mass += porevolume_[cell]*((1.0 - dps)*s[cell]*c[cell]
+                                       + rhor*((1.0 - porosity_[cell])/porosity_[cell])*ads);
+        }
+        return mass;
+    }
+
+
+
+
+    /// Net polymer inflow over the step, with the same terms as the
+    /// residuals: injected and produced polymer, and the flux
+    /// divergence (comp_term) correction, with adsorption evaluated
+    /// at the given cmax.
+    double TransportSolverTwophasePolymer::polymerSourceMass(const double* cmax) const
+    {
+        const double dps = polyprops_.deadPoreVol();
+        const double rhor = polyprops_.rockDensity();
+        double mass = 0.0;
+        for (int cell = 0; cell < grid_.number_of_cells; ++cell) {
+            const double q = source_[cell];
+            double mc;
+            if (q > 0.0) {
+                computeMc(polymer_inflow_c_[cell], mc);
+                mass += dt_*q*mc;
+            } else {
+                mass += dt_*q*fractionalflow_[cell]*mc_[cell];
+            }
+            double comp_term = q;
+            stencil_.forEachInteriorFace(cell, [&](const int f, const int, const bool first) {
+                comp_term -= first ? darcyflux_[f] : -darcyflux_[f];
+            });
+            if (comp_term != 0.0) {
+                const double s = saturation_[cell];
+                const double c = concentration_[cell];
+                double ads;
+                polyprops_.adsorption(c, cmax[cell], ads);
+                mass -= dt_*(s*c*(1.0 - dps) - rhor*ads)*comp_term;
+            }
+        }
+        return mass;
+    }
+
+
+
+
+    int TransportSolverTwophasePolymer::scratchAllocations() const
+    {
+        return s0_.allocations() + c0_.allocations() + col_gravflux_.allocations()
+            + multi_s0_.allocations() + multi_c0_.allocations() + multi_cmax0_.allocations()
+            + anderson_x_.allocations() + anderson_gx_.allocations() + anderson_.scratchAllocations();
     }
 
 
@@ -294,8 +519,10 @@ namespace Opm
     {
 	mutable double s; // Mutable in order to change it with every operator() call to be the last computed s value.
         TransportSolverTwophasePolymer::ResidualEquation& res_eq_;
-	explicit ResidualC(TransportSolverTwophasePolymer::ResidualEquation& res_eq)
-	    : res_eq_(res_eq)
+	const double tol_; // Tolerance of the inner saturation solve.
+	ResidualC(TransportSolverTwophasePolymer::ResidualEquation& res_eq, const double tol)
+	    : res_eq_(res_eq),
+	      tol_(tol)
 	{}
 
 	void computeBothResiduals(const double s_arg, const double c_arg, double& res_s, double& res_c, double& mc, double& ff) const
@@ -317,7 +544,7 @@ namespace Opm
 	    // s = modifiedRegulaFalsi(res_s, std::max(tm.smin_[2*cell], dps), tm.smax_[2*cell],
 	    //     		    tm.maxit_, tm.tol_, iters_used);
 	    s = RootFinder::solve(res_s, res_eq_.s0, 0.0, 1.0,
-                                  res_eq_.tm.maxit_, res_eq_.tm.tol_, iters_used);
+                                  res_eq_.tm.maxit_, tol_, iters_used);
             double x[2];
             x[0] = s;
             x[1] = c;
@@ -359,29 +586,17 @@ namespace Opm
 	comp_term = tm.source_[cell];   // Note: this assumes that all source flux is water.
 	dtpv    = tm.dt_/tm.porevolume_[cell];
 	porosity = tm.porosity_[cell];
-	for (int i = tm.grid_.cell_facepos[cell]; i < tm.grid_.cell_facepos[cell+1]; ++i) {
-	    int f = tm.grid_.cell_faces[i];
-	    double flux;
-	    int other;
-	    // Compute cell flux
-	    if (cell == tm.grid_.face_cells[2*f]) {
-		flux  = tm.darcyflux_[f];
-		other = tm.grid_.face_cells[2*f+1];
+	// Add flux to influx or outflux, over the interior faces.
+	tm.stencil_.forEachInteriorFace(cell, [&](const int f, const int other, const bool first) {
+	    const double flux = first ? tm.darcyflux_[f] : -tm.darcyflux_[f];
+	    if (flux < 0.0) {
+		influx  += flux*tm.fractionalflow_[other];
+		influx_polymer += flux*tm.fractionalflow_[other]*tm.mc_[other];
 	    } else {
-		flux  =-tm.darcyflux_[f];
-		other = tm.grid_.face_cells[2*f];
-	    }
-	    // Add flux to influx or outflux, if interior.
-	    if (other != -1) {
-		if (flux < 0.0) {
-		    influx  += flux*tm.fractionalflow_[other];
-		    influx_polymer += flux*tm.fractionalflow_[other]*tm.mc_[other];
-		} else {
-		    outflux += flux;
-		}
-		comp_term -= flux;
+		outflux += flux;
 	    }
-	}
+	    comp_term -= flux;
+	});
     }
 
 
@@ -458,6 +673,7 @@ namespace Opm
                                                                       double* res, double* dres_s_dsdc,
                                                                       double* dres_c_dsdc, double& mc, double& ff) const
     {
+        ++tm.residual_evaluations_;
         if ((if_dres_s_dsdc || if_dres_c_dsdc) && gradient_method == Analytic) {
             double s = x[0];
             double c = x[1];
@@ -555,33 +771,128 @@ namespace Opm
 
     void TransportSolverTwophasePolymer::solveSingleCell(const int cell)
     {
+	const double tol = cellTolerance(cell);
+	if (aim_cfl_limit_ > 0.0 && solveSingleCellExplicit(cell, tol)) {
+	    ++explicit_cells_;
+	    return;
+	}
 	switch (method_) {
 	case Bracketing:
-	    solveSingleCellBracketing(cell);
+	    solveSingleCellBracketing(cell, tol);
 	    break;
 	case Newton:
-	    solveSingleCellNewton(cell);
+	    solveSingleCellNewton(cell, tol);
 	    break;
 	case Gradient:
-	    solveSingleCellGradient(cell);
+	    solveSingleCellGradient(cell, tol);
 	    break;
 	case NewtonSimpleSC:
-	    solveSingleCellNewtonSimple(cell,true);
+	    solveSingleCellNewtonSimple(cell, true, tol);
 	    break;
 	case NewtonSimpleC:
-	    solveSingleCellNewtonSimple(cell,false);
+	    solveSingleCellNewtonSimple(cell, false, tol);
 	    break;	    
+	case TrustRegion:
+	    if (!solveSingleCellTrustRegion(cell, tol)) {
+		solveSingleCellBracketing(cell, tol);
+	    }
+	    break;
 	default:
 	    OPM_THROW(std::runtime_error, "Unknown method " << method_);
 	}
     }
 
 
-    void TransportSolverTwophasePolymer::solveSingleCellBracketing(int cell)
+    // Explicit update of a cell with a local CFL number below the
+    // adaptive-implicit limit. The outflux uses the fractional flow at
+    // the start of the step, the influx the new values of the upstream
+    // cells, which are already solved. The saturation update is then
+    // direct, and the concentration only needs a scalar solve for the
+    // adsorption term, without fractional flow evaluations. Returns
+    // false, leaving the cell untouched, if the cell is not stable
+    // enough or the update falls outside the admissible range.
+    bool TransportSolverTwophasePolymer::solveSingleCellExplicit(int cell, const double tol)
+    {
+	ResidualEquation res_eq(*this, cell);
+	const double s0 = res_eq.s0;
+	const double c0 = res_eq.c0;
+	const double cmax0 = res_eq.cmax0;
+	const double dps = res_eq.dps;
+	const double dtpv = res_eq.dtpv;
+	const double outflux = res_eq.outflux;
+	const double comp_term = res_eq.comp_term;
+	const double rock = res_eq.rhor*((1.0 - res_eq.porosity)/res_eq.porosity);
+	double ff0;
+	double dff_dsdc[2];
+	double mc0;
+	double dmc_dc;
+	double ads;
+	double ads_dc;
+	fracFlowWithDer(s0, c0, cmax0, cell, ff0, dff_dsdc);
+	computeMcWithDer(c0, mc0, dmc_dc);
+	polyprops_.adsorptionWithDer(c0, cmax0, ads, ads_dc);
+
+	// Local CFL numbers of the saturation and concentration waves.
+	const double holdup = (1.0 - dps)*s0 + rock*ads_dc;
+	if (holdup <= 0.0) {
+	    return false;
+	}
+	const double cfl_s = dtpv*outflux*std::fabs(dff_dsdc[0]);
+	const double cfl_c = dtpv*outflux*std::fabs(dff_dsdc[1]*mc0 + ff0*dmc_dc)/holdup;
+	if (std::max(cfl_s, cfl_c) >= aim_cfl_limit_) {
+	    return false;
+	}
+
+	const double sdenom = 1.0 + dtpv*comp_term;
+	if (sdenom <= 0.0) {
+	    return false;
+	}
+	const double s = (s0 - dtpv*(outflux*ff0 + res_eq.influx))/sdenom;
+	if (s < smin_[2*cell] || s > smax_[2*cell]) {
+	    return false;
+	}
+
+	// Concentration residual with the explicit fluxes, linear in c
+	// apart from the adsorption.
+	const double rhs = (1.0 - dps)*s0*c0 + rock*res_eq.ads0
+	    - dtpv*(outflux*ff0*mc0 + res_eq.influx_polymer);
+	const double ads_coeff = rock - dtpv*res_eq.rhor*comp_term;
+	double c = c0;
+	bool converged = false;
+	for (int iter = 0; iter < maxit_; ++iter) {
+	    polyprops_.adsorptionWithDer(c, cmax0, ads, ads_dc);
+	    const double g = (1.0 - dps)*s*c*sdenom + ads_coeff*ads - rhs;
+	    if (std::fabs(g) < tol) {
+		converged = true;
+		break;
+	    }
+	    const double dg_dc = (1.0 - dps)*s*sdenom + ads_coeff*ads_dc;
+	    if (dg_dc <= 0.0) {
+		return false;
+	    }
+	    c -= g/dg_dc;
+	}
+	if (!converged || c < 0.0) {
+	    return false;
+	}
+
+	saturation_[cell] = s;
+	concentration_[cell] = c;
+	cmax_[cell] = std::max(cmax_[cell], c);
+	// Downstream cells import exactly the flux exported here.
+	fractionalflow_[cell] = ff0;
+	mc_[cell] = mc0;
+	return true;
+    }
+
+
+
+
+    void TransportSolverTwophasePolymer::solveSingleCellBracketing(int cell, const double tol)
     {
         
 	ResidualEquation res_eq(*this, cell);
-	ResidualC res(res_eq);
+	ResidualC res(res_eq, tol);
 	const double a = 0.0;
 	const double b = polyprops_.cMax()*adhoc_safety_; // Add 10% to account for possible non-monotonicity of hyperbolic system.
 	int iters_used;
@@ -590,13 +901,13 @@ namespace Opm
 	double res_sc[2];
 	double mc, ff;
 	res.computeBothResiduals(saturation_[cell], concentration_[cell], res_sc[0], res_sc[1], mc, ff);
-	if (norm(res_sc) < tol_) {
+	if (norm(res_sc) < tol) {
 	    fractionalflow_[cell] = ff;
 	    mc_[cell] = mc;
 	    return;
 	}
 
-	concentration_[cell] = RootFinder::solve(res, a, b, maxit_, tol_, iters_used);
+	concentration_[cell] = RootFinder::solve(res, a, b, maxit_, tol, iters_used);
 	cmax_[cell] = std::max(cmax_[cell], concentration_[cell]);
 	saturation_[cell] = res.lastSaturation();
 	fracFlow(saturation_[cell], concentration_[cell], cmax_[cell], cell,
@@ -609,7 +920,7 @@ namespace Opm
     // Newton method, where we first try a Newton step. Then, if it does not work well, we look for
     // the zero of either the residual in s or the residual in c along a specified piecewise linear
     // curve. In these cases, we can use a robust 1d solver.
-    void TransportSolverTwophasePolymer::solveSingleCellGradient(int cell)
+    void TransportSolverTwophasePolymer::solveSingleCellGradient(int cell, const double tol)
     {
 	int iters_used_falsi = 0;
 	const int max_iters_split = maxit_;
@@ -624,7 +935,7 @@ namespace Opm
         double x_c[2];
         scToc(x, x_c);
 	res_eq.computeResidual(x_c, res, mc, ff);
-	if (norm(res) <= tol_) {
+	if (norm(res) <= tol) {
 	    cmax_[cell] = std::max(cmax_[cell], concentration_[cell]);
  	    fractionalflow_[cell] = ff;
 	    mc_[cell] = mc;
@@ -647,13 +958,13 @@ namespace Opm
 	ResCOnCurve res_c_on_curve(res_eq);
 	bool if_res_s;
 
- 	while ((norm(res) > tol_) && (iters_used_split < max_iters_split)) {
+ 	while ((norm(res) > tol) && (iters_used_split < max_iters_split)) {
             if (std::abs(res[0]) < std::abs(res[1])) {
-                if (res[0] < -tol_) {
+                if (res[0] < -tol) {
                     direction[0] = x_max_res_s[0] - x[0];
                     direction[1] = x_max_res_s[1] - x[1];
                     if_res_s = true;
-                } else if (res[0] > tol_) {
+                } else if (res[0] > tol) {
                     direction[0] = x_min_res_s[0] - x[0];
                     direction[1] = x_min_res_s[1] - x[1];
                     if_res_s = true;
@@ -662,7 +973,7 @@ namespace Opm
                     res_eq.computeGradientResS(x_c, res, gradient);
                     // dResS/d(s_) = dResS/ds - c/s*dResS/ds
                     // dResS/d(sc_) = -1/s*dResS/dc
-                    if (x[0] > 1e-2*tol_) {
+                    if (x[0] > 1e-2*tol) {
                         // With s,c variables, we should have
                         // direction[0] = -gradient[1];
                         // direction[1] = gradient[0];
@@ -678,11 +989,11 @@ namespace Opm
                     if_res_s = false;
                 }
             } else {
-                if (res[1] < -tol_) {
+                if (res[1] < -tol) {
                     direction[0] = x_max_res_sc[0] - x[0];
                     direction[1] = x_max_res_sc[1] - x[1];
                     if_res_s = false;
-                } else if (res[1] > tol_) {
+                } else if (res[1] > tol) {
                     direction[0] = x_min_res_sc[0] - x[0];
                     direction[1] = x_min_res_sc[1] - x[1];
                     if_res_s = false;
@@ -690,7 +1001,7 @@ namespace Opm
                     res_eq.computeGradientResC(x, res, gradient);
                     // dResC/d(s_) = dResC/ds - c/s*dResC/ds
                     // dResC/d(sc_) = -1/s*dResC/dc
-                    if (x[0] > 1e-2*tol_) {
+                    if (x[0] > 1e-2*tol) {
                         // With s,c variables, we should have
                         // direction[0] = -gradient[1];
                         // direction[1] = gradient[0];
@@ -711,38 +1022,38 @@ namespace Opm
                 if (res[0] < 0) {
                     end_point[0] = x_max_res_s[0];
                     end_point[1] = x_max_res_s[1];
-                    res_s_on_curve.curve.setup(x, direction, end_point, x_min, x_max, tol_, t_max, t_out);
+                    res_s_on_curve.curve.setup(x, direction, end_point, x_min, x_max, tol, t_max, t_out);
                     if (res_s_on_curve(t_out) >= 0) {
                         t_max = t_out;
                     }
                 } else {
                     end_point[0] = x_min_res_s[0];
                     end_point[1] = x_min_res_s[1];
-                    res_s_on_curve.curve.setup(x, direction, end_point, x_min, x_max, tol_, t_max, t_out);
+                    res_s_on_curve.curve.setup(x, direction, end_point, x_min, x_max, tol, t_max, t_out);
                     if (res_s_on_curve(t_out) <= 0) {
                         t_max = t_out;
                     }
                 }
                 // Note: In some experiments modifiedRegularFalsi does not yield a result under the given tolerance.
-                t = RootFinder::solve(res_s_on_curve, 0., t_max, maxit_, tol_, iters_used_falsi);
+                t = RootFinder::solve(res_s_on_curve, 0., t_max, maxit_, tol, iters_used_falsi);
                 res_s_on_curve.curve.computeXOfT(x, t);
             } else {
                 if (res[1] < 0) {
                     end_point[0] = x_max_res_sc[0];
                     end_point[1] = x_max_res_sc[1];
-                    res_c_on_curve.curve.setup(x, direction, end_point, x_min, x_max, tol_, t_max, t_out);
+                    res_c_on_curve.curve.setup(x, direction, end_point, x_min, x_max, tol, t_max, t_out);
                     if (res_c_on_curve(t_out) >= 0) {
                         t_max = t_out;
                     }
                 } else {
                     end_point[0] = x_min_res_sc[0];
                     end_point[1] = x_min_res_sc[1];
-                    res_c_on_curve.curve.setup(x, direction, end_point, x_min, x_max, tol_, t_max, t_out);
+                    res_c_on_curve.curve.setup(x, direction, end_point, x_min, x_max, tol, t_max, t_out);
                     if (res_c_on_curve(t_out) <= 0) {
                         t_max = t_out;
                     }
                 }
-                t = RootFinder::solve(res_c_on_curve, 0., t_max, maxit_, tol_, iters_used_falsi);
+                t = RootFinder::solve(res_c_on_curve, 0., t_max, maxit_, tol, iters_used_falsi);
                 res_c_on_curve.curve.computeXOfT(x, t);
 
             }
@@ -753,9 +1064,9 @@ namespace Opm
 	    
 
 
-        if ((iters_used_split >=  max_iters_split) && (norm(res) > tol_)) {
+        if ((iters_used_split >=  max_iters_split) && (norm(res) > tol)) {
             OPM_MESSAGE("Newton for single cell did not work in cell number " << cell);
-            solveSingleCellBracketing(cell);
+            solveSingleCellBracketing(cell, tol);
         } else {
             scToc(x, x_c);
             concentration_[cell] = x_c[1];
@@ -766,7 +1077,7 @@ namespace Opm
         }
     }
     
-    void TransportSolverTwophasePolymer::solveSingleCellNewton(int cell)
+    void TransportSolverTwophasePolymer::solveSingleCellNewton(int cell, const double tol)
     {
         const int max_iters_split = maxit_;
 	int iters_used_split = 0;
@@ -778,7 +1089,7 @@ namespace Opm
 	double mc;
 	double ff;
 	res_eq.computeResidual(x, res, mc, ff);
-	if (norm(res) <= tol_) {
+	if (norm(res) <= tol) {
 	    cmax_[cell] = std::max(cmax_[cell], concentration_[cell]);
  	    fractionalflow_[cell] = ff;
 	    mc_[cell] = mc;
@@ -803,7 +1114,7 @@ namespace Opm
         // x_c will contain the s-c variable 
         double x_c[2];
 	
- 	while ((norm(res) > tol_) &&
+ 	while ((norm(res) > tol) &&
 	       (iters_used_split < max_iters_split)  &&
 	       successfull_newton_step) {
             double dres_s_dsdc[2];
@@ -812,14 +1123,14 @@ namespace Opm
             res_eq.computeJacobiRes(x_c, dres_s_dsdc, dres_c_dsdc);
             double dFx_dx = (dres_s_dsdc[0]-x_c[1]*dres_s_dsdc[1]);
             double dFx_dy;
-            if (x[0] < 1e-2*tol_) {
+            if (x[0] < 1e-2*tol) {
                 dFx_dy = 0.0;
             } else {
                 dFx_dy = (dres_s_dsdc[1]/x[0]);
             }
             double dFy_dx = (dres_c_dsdc[0]-x_c[1]*dres_c_dsdc[1]);
             double dFy_dy;
-            if (x[0] < 1e-2*tol_) {
+            if (x[0] < 1e-2*tol) {
                 dFy_dy = 1.0 - res_eq.dps;
             } else {
                 dFy_dy = (dres_c_dsdc[1]/x[0]);
@@ -852,9 +1163,12 @@ namespace Opm
             }
 	}
 		
-	if ((iters_used_split >=  max_iters_split) && (norm(res) > tol_)) {
-	    OPM_MESSAGE("Newton for single cell did not work in cell number " << cell);
-	    solveSingleCellBracketing(cell);
+	if (norm(res) > tol) {
+	    // Either out of iterations or the line search failed.
+	    if (!solveSingleCellTrustRegion(cell, tol)) {
+		OPM_MESSAGE("Newton for single cell did not work in cell number " << cell);
+		solveSingleCellBracketing(cell, tol);
+	    }
 	} else {
 	    concentration_[cell] = x[1];
 	    cmax_[cell] = std::max(cmax_[cell], concentration_[cell]);
@@ -864,7 +1178,131 @@ namespace Opm
 	}
     }
 
-    void TransportSolverTwophasePolymer::solveSingleCellNewtonSimple(int cell,bool use_sc)
+    // Dogleg trust-region method for the (s, c) residual, with the
+    // analytic Jacobian. The merit function is 0.5*|res|^2, steps are
+    // projected onto the box [0, 1] x [0, cmax*adhoc_safety_], and c is
+    // scaled by the box size so that the trust region is round in both
+    // variables. Every iteration costs one Jacobian and one residual
+    // evaluation, without nested scalar solves. Returns false, leaving
+    // the cell untouched, if it does not converge within maxit_
+    // iterations.
+    bool TransportSolverTwophasePolymer::solveSingleCellTrustRegion(int cell, const double tol)
+    {
+	++trust_region_solves_;
+	ResidualEquation res_eq(*this, cell);
+	const double c_scale = polyprops_.cMax()*adhoc_safety_;
+	// Scaled variables y = (s, c/c_scale) live in the unit square.
+	double y[2] = { std::min(std::max(saturation_[cell], 0.0), 1.0),
+			std::min(std::max(concentration_[cell]/c_scale, 0.0), 1.0) };
+	double x[2] = { y[0], y[1]*c_scale };
+	double res[2];
+	double mc;
+	double ff;
+	res_eq.computeResidual(x, res, mc, ff);
+	double merit = 0.5*(res[0]*res[0] + res[1]*res[1]);
+	double radius = 0.5;
+	const double min_radius = 1e-14;
+	bool converged = norm(res) <= tol;
+	for (int iter = 0; iter < maxit_ && !converged && radius > min_radius; ++iter) {
+	    // Jacobian with respect to the scaled variables.
+	    double dres_s[2];
+	    double dres_c[2];
+	    res_eq.computeJacobiRes(x, dres_s, dres_c);
+	    const double j00 = dres_s[0];
+	    const double j01 = dres_s[1]*c_scale;
+	    const double j10 = dres_c[0];
+	    const double j11 = dres_c[1]*c_scale;
+
+	    // Steepest descent direction and Cauchy point.
+	    const double g[2] = { j00*res[0] + j10*res[1], j01*res[0] + j11*res[1] };
+	    const double gnorm = std::sqrt(g[0]*g[0] + g[1]*g[1]);
+	    if (gnorm == 0.0) {
+		break;
+	    }
+	    const double jg[2] = { j00*g[0] + j01*g[1], j10*g[0] + j11*g[1] };
+	    const double jg2 = jg[0]*jg[0] + jg[1]*jg[1];
+	    const double tau = (jg2 > 0.0) ? gnorm*gnorm/jg2 : radius/gnorm;
+	    const double p_cauchy[2] = { -tau*g[0], -tau*g[1] };
+	    const double cauchy_norm = tau*gnorm;
+
+	    // Dogleg step: Newton if inside the region, otherwise the
+	    // point on the Cauchy-Newton path at the boundary.
+	    double p[2];
+	    const double det = j00*j11 - j01*j10;
+	    const bool have_newton = std::fabs(det) > 1e-14*(std::fabs(j00*j11) + std::fabs(j01*j10));
+	    double p_newton[2] = { 0.0, 0.0 };
+	    if (have_newton) {
+		p_newton[0] = -(res[0]*j11 - res[1]*j01)/det;
+		p_newton[1] = -(res[1]*j00 - res[0]*j10)/det;
+	    }
+	    const double newton_norm = std::sqrt(p_newton[0]*p_newton[0] + p_newton[1]*p_newton[1]);
+	    if (have_newton && newton_norm <= radius) {
+		p[0] = p_newton[0];
+		p[1] = p_newton[1];
+	    } else if (!have_newton || cauchy_norm >= radius) {
+		p[0] = -radius*g[0]/gnorm;
+		p[1] = -radius*g[1]/gnorm;
+	    } else {
+		// Solve |p_cauchy + t*(p_newton - p_cauchy)| = radius for t in [0, 1].
+		const double d[2] = { p_newton[0] - p_cauchy[0], p_newton[1] - p_cauchy[1] };
+		const double a = d[0]*d[0] + d[1]*d[1];
+		const double b = 2.0*(p_cauchy[0]*d[0] + p_cauchy[1]*d[1]);
+		const double c = cauchy_norm*cauchy_norm - radius*radius;
+		const double t = (-b + std::sqrt(std::max(b*b - 4.0*a*c, 0.0)))/(2.0*a);
+		p[0] = p_cauchy[0] + t*d[0];
+		p[1] = p_cauchy[1] + t*d[1];
+	    }
+
+	    // Project onto the box, and compare actual and predicted decrease.
+	    double y_new[2] = { std::min(std::max(y[0] + p[0], 0.0), 1.0),
+				std::min(std::max(y[1] + p[1], 0.0), 1.0) };
+	    const double step[2] = { y_new[0] - y[0], y_new[1] - y[1] };
+	    const double step_norm = std::sqrt(step[0]*step[0] + step[1]*step[1]);
+	    if (step_norm == 0.0) {
+		radius *= 0.25;
+		continue;
+	    }
+	    const double lin[2] = { res[0] + j00*step[0] + j01*step[1],
+				    res[1] + j10*step[0] + j11*step[1] };
+	    const double predicted = merit - 0.5*(lin[0]*lin[0] + lin[1]*lin[1]);
+	    double x_new[2] = { y_new[0], y_new[1]*c_scale };
+	    double res_new[2];
+	    double mc_new;
+	    double ff_new;
+	    res_eq.computeResidual(x_new, res_new, mc_new, ff_new);
+	    const double merit_new = 0.5*(res_new[0]*res_new[0] + res_new[1]*res_new[1]);
+	    const double rho = (predicted > 0.0) ? (merit - merit_new)/predicted : -1.0;
+	    if (rho < 0.25) {
+		radius = 0.25*step_norm;
+	    } else if (rho > 0.75 && step_norm > 0.99*radius) {
+		radius = std::min(2.0*radius, 1.0);
+	    }
+	    if (rho > 1e-4 || norm(res_new) <= tol) {
+		y[0] = y_new[0];
+		y[1] = y_new[1];
+		x[0] = x_new[0];
+		x[1] = x_new[1];
+		res[0] = res_new[0];
+		res[1] = res_new[1];
+		mc = mc_new;
+		ff = ff_new;
+		merit = merit_new;
+		converged = norm(res) <= tol;
+	    }
+	}
+	if (!converged) {
+	    ++trust_region_failures_;
+	    return false;
+	}
+	saturation_[cell] = x[0];
+	concentration_[cell] = x[1];
+	cmax_[cell] = std::max(cmax_[cell], concentration_[cell]);
+	fractionalflow_[cell] = ff;
+	mc_[cell] = mc;
+	return true;
+    }
+
+    void TransportSolverTwophasePolymer::solveSingleCellNewtonSimple(int cell, bool use_sc, const double tol)
     {
 	const int max_iters_split = maxit_;
 	int iters_used_split = 0;
@@ -876,7 +1314,7 @@ namespace Opm
 	double mc;
 	double ff;
 	res_eq.computeResidual(x, res, mc, ff);
-	if (norm(res) <= tol_) {
+	if (norm(res) <= tol) {
 	    cmax_[cell] = std::max(cmax_[cell], concentration_[cell]);
  	    fractionalflow_[cell] = ff;
 	    mc_[cell] = mc;
@@ -915,13 +1353,13 @@ namespace Opm
 	ResSOnCurve res_s_on_curve(res_eq);
 	ResCOnCurve res_c_on_curve(res_eq);
 	
- 	while ((norm(res) > tol_) &&
+ 	while ((norm(res) > tol) &&
 	       (iters_used_split < max_iters_split)  &&
 	       successfull_newton_step) {
 	    // We first try a Newton step
 	    double dres_s_dsdc[2];
 	    double dres_c_dsdc[2];
-	    double dx=tol_;
+	    double dx=tol;
 	    double tmp_x[2];
 	    if(!(x[0]>0)){
 		tmp_x[0]=dx;
@@ -999,9 +1437,9 @@ namespace Opm
 	    //	    std::cout << "Nonlinear " << iters_used_split << "  " << norm(res) << std::endl;
 	}
 		
-	if ((iters_used_split >=  max_iters_split) || (norm(res) > tol_)) {
+	if ((iters_used_split >=  max_iters_split) || (norm(res) > tol)) {
 	    OPM_MESSAGE("NewtonSimple for single cell did not work in cell number " << cell);
-	    solveSingleCellBracketing(cell);
+	    solveSingleCellBracketing(cell, tol);
 	} else {
 	    concentration_[cell] = x[1];
 	    cmax_[cell] = std::max(cmax_[cell], concentration_[cell]);
@@ -1019,9 +1457,9 @@ namespace Opm
 	double max_c_change = 0.0;
 	int num_iters = 0;
 	// Must store state variables before we start.
-	std::vector<double> s0(num_cells);
-	std::vector<double> c0(num_cells);
-	std::vector<double> cmax0(num_cells);
+	double* s0 = multi_s0_.get(num_cells);
+	double* c0 = multi_c0_.get(num_cells);
+	double* cmax0 = multi_cmax0_.get(num_cells);
 	// Must set initial fractional flows etc. before we start.
 	for (int i = 0; i < num_cells; ++i) {
 	    const int cell = cells[i];
@@ -1030,13 +1468,23 @@ namespace Opm
             computeMc(concentration_[cell], mc_[cell]);
 	    s0[i] = saturation_[cell];
 	    c0[i] = concentration_[cell];
-	    cmax0[i] = cmax_[i];
+	    cmax0[i] = cmax_[cell];
 	}
+	const bool accelerate = anderson_.depth() > 0;
+	double* x = anderson_x_.get(2*num_cells);
+	double* gx = anderson_gx_.get(2*num_cells);
+	anderson_.reset(2*num_cells);
 	do {
 	    // int max_s_change_cell = -1;
 	    // int max_c_change_cell = -1;
 	    max_s_change = 0.0;
 	    max_c_change = 0.0;
+	    if (accelerate) {
+		for (int i = 0; i < num_cells; ++i) {
+		    x[2*i] = saturation_[cells[i]];
+		    x[2*i + 1] = concentration_[cells[i]];
+		}
+	    }
 	    for (int i = 0; i < num_cells; ++i) {
 		const int cell = cells[i];
 		const double old_s = saturation_[cell];
@@ -1057,7 +1505,28 @@ namespace Opm
 	    }
 	    // std::cout << "Iter = " << num_iters << "    max_s_change = " << max_s_change
 	    // 	      << "    in cell " << max_change_cell << std::endl;
+	    if (accelerate && ((max_s_change > tol_) || (max_c_change > tol_))) {
+		for (int i = 0; i < num_cells; ++i) {
+		    gx[2*i] = saturation_[cells[i]];
+		    gx[2*i + 1] = concentration_[cells[i]];
+		}
+		anderson_.accelerate(x, gx);
+		// Accept the accelerated iterate, with the fractional flows
+		// seen by the downstream cells of the next pass.
+		for (int i = 0; i < num_cells; ++i) {
+		    const int cell = cells[i];
+		    saturation_[cell] = std::min(std::max(gx[2*i], smin_[2*cell]), smax_[2*cell]);
+		    concentration_[cell] = std::max(gx[2*i + 1], 0.0);
+		    cmax_[cell] = std::max(cmax0[i], concentration_[cell]);
+		    fracFlow(saturation_[cell], concentration_[cell], cmax0[i],
+			     cell, fractionalflow_[cell]);
+		    computeMc(concentration_[cell], mc_[cell]);
+		}
+	    }
 	} while (((max_s_change > tol_) || (max_c_change > tol_)) && ++num_iters < maxit_);
+	std::pair<int, int>& stats = multicell_iterations_[num_cells];
+	++stats.first;
+	stats.second += std::min(num_iters + 1, int(maxit_));
 	if (max_s_change > tol_) {
 	    OPM_THROW(std::runtime_error, "In solveMultiCell(), we did not converge after "
 		  << num_iters << " iterations. Delta s = " << max_s_change);
@@ -1066,8 +1535,8 @@ namespace Opm
 	    OPM_THROW(std::runtime_error, "In solveMultiCell(), we did not converge after "
 		  << num_iters << " iterations. Delta c = " << max_c_change);
 	}
-	std::cout << "Solved " << num_cells << " cell multicell problem in "
-		  << num_iters << " iterations." << std::endl;
+	OPM_POLYMER_LOG_DEBUG("Solved " << num_cells << " cell multicell problem in "
+			      << num_iters << " iterations.");
     }
 
     void TransportSolverTwophasePolymer::fracFlow(double s, double c, double cmax,
@@ -1149,7 +1618,8 @@ namespace Opm
     // Influxes are negative, outfluxes positive.
 
     TransportSolverTwophasePolymer::ResidualCGrav::ResidualCGrav(const TransportSolverTwophasePolymer& tmodel,
-                                                        const std::vector<int>& cells,
+                                                        const int num_cells,
+                                                        const int* cells,
                                                         const int pos,
                                                         const double* gravflux) // Always oriented towards next in column. Size = colsize - 1.
         : tm(tmodel),
@@ -1172,7 +1642,7 @@ namespace Opm
         }
         nbcell[1] = -1;
         gf[1] = 0.0;
-        if (pos < int(cells.size() - 1)) {
+        if (pos < num_cells - 1) {
             nbcell[1] = cells[pos + 1];
             gf[1] = gravflux[pos];
         }
@@ -1288,12 +1758,13 @@ namespace Opm
     }
 
 
-    void TransportSolverTwophasePolymer::solveSingleCellGravity(const std::vector<int>& cells,
+    void TransportSolverTwophasePolymer::solveSingleCellGravity(const int num_cells,
+                                                       const int* cells,
                                                        const int pos,
                                                        const double* gravflux)
     {
         const int cell = cells[pos];
-        ResidualCGrav res_c(*this, cells, pos, gravflux);
+        ResidualCGrav res_c(*this, num_cells, cells, pos, gravflux);
 
         // Check if current state is an acceptable solution.
 	double res_sc[2];
@@ -1315,56 +1786,77 @@ namespace Opm
         mobility(saturation_[cell], concentration_[cell], cell, &mob_[2*cell]);
     }
 
-    int TransportSolverTwophasePolymer::solveGravityColumn(const std::vector<int>& cells)
+    int TransportSolverTwophasePolymer::solveGravityColumn(const int nc, const int* cells)
     {
         // Set up column gravflux.
-        const int nc = cells.size();
-        std::vector<double> col_gravflux(nc - 1);
+        double* col_gravflux = col_gravflux_.get(nc);
         for (int ci = 0; ci < nc - 1; ++ci) {
 	    const int cell = cells[ci];
 	    const int next_cell = cells[ci + 1];
-	    for (int j = grid_.cell_facepos[cell]; j < grid_.cell_facepos[cell+1]; ++j) {
-		const int face = grid_.cell_faces[j];
-		const int c1 = grid_.face_cells[2*face + 0];
-                const int c2 = grid_.face_cells[2*face + 1];
-		if (c1 == next_cell || c2 == next_cell) {
+	    stencil_.forEachInteriorFace(cell, [&](const int face, const int other, const bool first) {
+		if (other == next_cell) {
                     const double gf = gravflux_[face];
-                    col_gravflux[ci] = (c1 == cell) ? gf : -gf;
+                    col_gravflux[ci] = first ? gf : -gf;
 		}
-	    }
+	    });
         }
 
         // Store initial saturation s0
-        s0_.resize(nc);
-        c0_.resize(nc);
+        double* s0 = s0_.get(nc);
+        double* c0 = c0_.get(nc);
         for (int ci = 0; ci < nc; ++ci) {
-            s0_[ci] = saturation_[cells[ci]];
-            c0_[ci] = concentration_[cells[ci]];
+            s0[ci] = saturation_[cells[ci]];
+            c0[ci] = concentration_[cells[ci]];
         }
 
         // Solve single cell problems, repeating if necessary.
 	double max_sc_change = 0.0;
         int num_iters = 0;
+        const bool accelerate = anderson_.depth() > 0;
+        double* x = anderson_x_.get(2*nc);
+        double* gx = anderson_gx_.get(2*nc);
+        anderson_.reset(2*nc);
         do {
             max_sc_change = 0.0;
+            if (accelerate) {
+                for (int ci = 0; ci < nc; ++ci) {
+                    x[2*ci] = saturation_[cells[ci]];
+                    x[2*ci + 1] = concentration_[cells[ci]];
+                }
+            }
             for (int ci = 0; ci < nc; ++ci) {
                 const int ci2 = nc - ci - 1;
                 double old_s[2] = { saturation_[cells[ci]],
                                     saturation_[cells[ci2]] };
                 double old_c[2] = { concentration_[cells[ci]],
                                     concentration_[cells[ci2]] };
-                saturation_[cells[ci]] = s0_[ci];
-                concentration_[cells[ci]] = c0_[ci];
-                solveSingleCellGravity(cells, ci, &col_gravflux[0]);
-                saturation_[cells[ci2]] = s0_[ci2];
-                concentration_[cells[ci2]] = c0_[ci2];
-                solveSingleCellGravity(cells, ci2, &col_gravflux[0]);
+                saturation_[cells[ci]] = s0[ci];
+                concentration_[cells[ci]] = c0[ci];
+                solveSingleCellGravity(nc, cells, ci, col_gravflux);
+                saturation_[cells[ci2]] = s0[ci2];
+                concentration_[cells[ci2]] = c0[ci2];
+                solveSingleCellGravity(nc, cells, ci2, col_gravflux);
                 max_sc_change = std::max(max_sc_change, 0.25*(std::fabs(saturation_[cells[ci]] - old_s[0]) + 
                                                               std::fabs(concentration_[cells[ci]] - old_c[0]) +
                                                               std::fabs(saturation_[cells[ci2]] - old_s[1]) +
                                                               std::fabs(concentration_[cells[ci2]] - old_c[1])));
             }
             // std::cout << "Iter = " << num_iters << "    max_s_change = " << max_s_change << std::endl;
+            if (accelerate && max_sc_change > tol_) {
+                for (int ci = 0; ci < nc; ++ci) {
+                    gx[2*ci] = saturation_[cells[ci]];
+                    gx[2*ci + 1] = concentration_[cells[ci]];
+                }
+                anderson_.accelerate(x, gx);
+                for (int ci = 0; ci < nc; ++ci) {
+                    const int cell = cells[ci];
+                    saturation_[cell] = std::min(std::max(gx[2*ci], smin_[2*cell]), smax_[2*cell]);
+                    concentration_[cell] = std::max(gx[2*ci + 1], 0.0);
+                    cmax_[cell] = std::max(cmax0_[cell], concentration_[cell]);
+                    computeMc(concentration_[cell], mc_[cell]);
+                    mobility(saturation_[cell], concentration_[cell], cell, &mob_[2*cell]);
+                }
+            }
 	} while (max_sc_change > tol_ && ++num_iters < maxit_);
 
 	if (max_sc_change > tol_) {
@@ -1375,13 +1867,14 @@ namespace Opm
     }
 
 
-    void TransportSolverTwophasePolymer::solveGravity(const std::vector<std::vector<int> >& columns,
+    void TransportSolverTwophasePolymer::solveGravity(const GravityColumns& columns,
                                              const double* porevolume,
                                              const double dt,
                                              std::vector<double>& saturation,
                                              std::vector<double>& concentration,
                                              std::vector<double>& cmax)
     {
+        OPM_POLYMER_TRACE_SCOPE("gravity split");
         // initialize variables.
         porevolume_ = porevolume;
         dt_ = dt;
@@ -1402,17 +1895,27 @@ namespace Opm
 
         // Solve on all columns.
         int num_iters = 0;
-        // std::cout << "Gauss-Seidel column solver # columns: " << columns.size() << std::endl;
-        for (std::vector<std::vector<int> >::size_type i = 0; i < columns.size(); i++) {
-            // std::cout << "==== new column" << std::endl;
-            num_iters += solveGravityColumn(columns[i]);
+        const int num_columns = columns.numColumns();
+        for (int i = 0; i < num_columns; ++i) {
+            num_iters += solveGravityColumn(columns.columnSize(i), columns.columnCells(i));
         }
-        std::cout << "Gauss-Seidel column solver average iterations: "
-                  << double(num_iters)/double(columns.size()) << std::endl;
+        OPM_POLYMER_LOG_INFO("Gauss-Seidel column solver average iterations: "
+                             << double(num_iters)/double(num_columns));
+        logAnderson();
+        OPM_POLYMER_LOG_DEBUG("Scratch allocations: " << scratchAllocations());
 
         toBothSat(saturation_, saturation);
     }
 
+    void TransportSolverTwophasePolymer::logAnderson() const
+    {
+        if (anderson_.depth() > 0) {
+            OPM_POLYMER_LOG_DEBUG("Anderson acceleration (depth " << anderson_.depth() << "): "
+                                  << anderson_.acceleratedSteps() << " accelerated steps, "
+                                  << anderson_.restarts() << " restarts since construction.");
+        }
+    }
+
     void TransportSolverTwophasePolymer::scToc(const double* x, double* x_c) const {
         x_c[0] = x[0];
         if (x[0] < 1e-2*tol_) {
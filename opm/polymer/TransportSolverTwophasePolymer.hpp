@@ -21,10 +21,15 @@
 #define OPM_TRANSPORTSOLVERTWOPHASEPOLYMER_HEADER_INCLUDED
 
 #include <opm/polymer/PolymerProperties.hpp>
+#include <opm/polymer/AndersonAcceleration.hpp>
+#include <opm/polymer/CellStencil.hpp>
+#include <opm/polymer/GravityColumns.hpp>
+#include <opm/polymer/ScratchBuffer.hpp>
 #include <opm/core/transport/reorder/ReorderSolverInterface.hpp>
 #include <opm/core/utility/linearInterpolation.hpp>
 #include <vector>
 #include <list>
+#include <map>
 
 struct UnstructuredGrid;
 
@@ -40,7 +45,7 @@ namespace Opm
     {
     public:
 
-	enum SingleCellMethod { Bracketing, Newton, Gradient, NewtonSimpleSC, NewtonSimpleC};
+	enum SingleCellMethod { Bracketing, Newton, Gradient, NewtonSimpleSC, NewtonSimpleC, TrustRegion };
         enum GradientMethod { Analytic, FinDif }; // Analytic is chosen (hard-coded)
 
 	/// Construct solver.
@@ -50,7 +55,10 @@ namespace Opm
 	/// \param[in] method     Bracketing: solve for c in outer loop, s in inner loop,
         ///                                   each solve being bracketed for robustness.
 	///                       Newton: solve simultaneously for c and s with Newton's method.
-        ///                               (using gradient variant and bracketing as fallbacks).
+        ///                               (using trust region and bracketing as fallbacks).
+        ///                       TrustRegion: solve simultaneously for s and c with a
+        ///                               dogleg trust-region method on the (s, c) box
+        ///                               (using bracketing as fallback).
 	/// \param[in] tol        Tolerance used in the solver.
 	/// \param[in] maxit      Maximum number of non-linear iterations used.
 	TransportSolverTwophasePolymer(const UnstructuredGrid& grid,
@@ -63,6 +71,33 @@ namespace Opm
 	/// Set the preferred method, Bracketing or Newton.
         void setPreferredMethod(SingleCellMethod method);
 
+        /// Use a per-cell tolerance in the single-cell solves: the
+        /// tolerance divided by the cell's throughput (dt times its
+        /// in- or outflux over its pore volume), kept within
+        /// [tol/max_factor, tol*max_factor]. Cells with little flow
+        /// through them get a looser tolerance, cells with high
+        /// throughput, such as near injectors, a tighter one. With
+        /// max_factor = 1 (the default) tol is used everywhere.
+        /// Compare polymerMassError() and residualEvaluations() with
+        /// and without to assess the trade-off.
+        void setAdaptiveTolerance(const double max_factor);
+
+        /// Adaptive-implicit mode: cells whose local CFL number, from
+        /// the step-start saturation and concentration and the
+        /// derivatives of the fractional flow, is below cfl_limit are
+        /// updated explicitly, the others with the implicit
+        /// single-cell solve. An explicit cell exports the same flux
+        /// to its downstream cells as it removes from its own mass
+        /// balance, so the scheme stays conservative. With
+        /// cfl_limit = 0 (the default) all cells are implicit.
+        void setAdaptiveImplicit(const double cfl_limit);
+
+        /// Use Anderson acceleration with the given memory depth for
+        /// the nonlinear Gauss-Seidel iterations over multi-cell
+        /// components and gravity columns. With depth 0 (the default)
+        /// the plain Gauss-Seidel iteration is used.
+        void setAndersonDepth(const int depth);
+
 	/// Solve for saturation, concentration and cmax at next timestep.
 	/// Using implicit Euler scheme, reordered.
 	/// \param[in] darcyflux           Array of signed face fluxes.
@@ -91,33 +126,67 @@ namespace Opm
         /// It assumes that the input columns contain cells in a single
         /// vertical stack, that do not interact with other columns (for
         /// gravity segregation.
-	/// \param[in] columns             Vector of cell-columns.
+	/// \param[in] columns             Cell columns.
 	/// \param[in] porevolume          Array of pore volumes.
 	/// \param[in] dt                  Time step.
 	/// \param[in, out] saturation     Phase saturations.
 	/// \param[in, out] concentration  Polymer concentration.
 	/// \param[in, out] cmax           Highest concentration that has occured in a given cell.
-        void solveGravity(const std::vector<std::vector<int> >& columns,
+        void solveGravity(const GravityColumns& columns,
                           const double* porevolume,
                           const double dt,
                           std::vector<double>& saturation,
                           std::vector<double>& concentration,
                           std::vector<double>& cmax);
 
+        /// Number of scratch buffer allocations made so far, including
+        /// the initial ones at construction and in setAndersonDepth().
+        /// Stays constant over calls to solve() and solveGravity().
+        int scratchAllocations() const;
+
+        /// Multi-cell component statistics since construction: for each
+        /// component size, the number of components solved and their
+        /// total number of Gauss-Seidel passes.
+        const std::map<int, std::pair<int, int> >& multiCellIterations() const;
+
+        /// Number of single-cell residual evaluations since construction.
+        long residualEvaluations() const;
+
+        /// Number of trust-region single-cell solves since
+        /// construction, and the number of those that did not converge
+        /// and fell back to bracketing.
+        std::pair<long, long> trustRegionSolves() const;
+
+        /// Polymer mass balance error of the last solve(), that is the
+        /// change in polymer mass (dissolved and adsorbed) minus the net
+        /// inflow from sources. Only computed with adaptive tolerances
+        /// or with debug logging enabled, zero otherwise.
+        double polymerMassError() const;
+
+        /// Number of cells updated explicitly in the last solve(), in
+        /// adaptive-implicit mode.
+        int explicitCells() const;
+
     public: // But should be made private...
 	virtual void solveSingleCell(const int cell);
 	virtual void solveMultiCell(const int num_cells, const int* cells);
-	void solveSingleCellBracketing(int cell);
-	void solveSingleCellNewton(int cell);
-	void solveSingleCellGradient(int cell);
-	void solveSingleCellNewtonSimple(int cell,bool use_sc);
+	// The single-cell solvers take the tolerance of the cell, see
+	// cellTolerance().
+	bool solveSingleCellExplicit(int cell, const double tol);
+	void solveSingleCellBracketing(int cell, const double tol);
+	void solveSingleCellNewton(int cell, const double tol);
+	void solveSingleCellGradient(int cell, const double tol);
+	void solveSingleCellNewtonSimple(int cell, bool use_sc, const double tol);
+	bool solveSingleCellTrustRegion(int cell, const double tol);
 	class ResidualEquation;
 
         void initGravity(const double* grav);
-        void solveSingleCellGravity(const std::vector<int>& cells,
+        void solveSingleCellGravity(const int num_cells,
+                                    const int* cells,
                                     const int pos,
                                     const double* gravflux);
-        int solveGravityColumn(const std::vector<int>& cells);
+        int solveGravityColumn(const int num_cells, const int* cells);
+        void logAnderson() const;
         void scToc(const double* x, double* x_c) const;
 
         #ifdef PROFILING
@@ -142,6 +211,7 @@ namespace Opm
 
     private:
 	const UnstructuredGrid& grid_;
+	CellStencil stencil_;
 	const double* porosity_;
 	const double* porevolume_;  // one volume per cell
 	const IncompPropertiesInterface& props_;
@@ -169,8 +239,30 @@ namespace Opm
         std::vector<double> mob_;
         std::vector<double> cmax0_;
         // For gravity segregation, column variables
-        std::vector<double> s0_;
-        std::vector<double> c0_;
+        ScratchBuffer<double> s0_;
+        ScratchBuffer<double> c0_;
+        ScratchBuffer<double> col_gravflux_;
+        // For multi-cell components, state at start of iteration
+        ScratchBuffer<double> multi_s0_;
+        ScratchBuffer<double> multi_c0_;
+        ScratchBuffer<double> multi_cmax0_;
+        std::map<int, std::pair<int, int> > multicell_iterations_;
+        // For adaptive tolerances.
+        double adaptive_tol_factor_;
+        long residual_evaluations_;
+        long trust_region_solves_;
+        long trust_region_failures_;
+        double polymer_mass_error_;
+        // For adaptive-implicit mode.
+        double aim_cfl_limit_;
+        int explicit_cells_;
+        ScratchBuffer<double> old_s_;
+        ScratchBuffer<double> old_c_;
+        ScratchBuffer<double> old_cmax_;
+        // For Anderson acceleration of the Gauss-Seidel iterations.
+        AndersonAcceleration anderson_;
+        ScratchBuffer<double> anderson_x_;
+        ScratchBuffer<double> anderson_gx_;
 
 	struct ResidualC;
 	struct ResidualS;
@@ -187,6 +279,9 @@ namespace Opm
 	void computeMc(double c, double& mc) const;
 	void computeMcWithDer(double c, double& mc, double& dmc_dc) const;
         void mobility(double s, double c, int cell, double* mob) const;
+        double cellTolerance(const int cell) const;
+        double polymerMass(const double* s, const double* c, const double* cmax) const;
+        double polymerSourceMass(const double* cmax) const;
     };
 
 } // namespace Opm
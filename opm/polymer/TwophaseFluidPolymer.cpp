@@ -0,0 +1,147 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+#include <opm/polymer/TwophaseFluidPolymer.hpp>
+#include <opm/polymer/PolymerProperties.hpp>
+#include <opm/core/props/IncompPropertiesInterface.hpp>
+#include <opm/core/utility/ErrorMacros.hpp>
+
+namespace Opm
+{
+
+    TwophaseFluidPolymer::TwophaseFluidPolymer(const IncompPropertiesInterface& props,
+                                               const PolymerProperties& polyprops)
+        : props_(&props),
+          polyprops_(&polyprops),
+          kr_(2*props.numCells()),
+          dkr_(4*props.numCells()),
+          pcow_(2*props.numCells()),
+          dpcds_(4*props.numCells())
+    {
+        if (props.numPhases() != 2) {
+            OPM_THROW(std::runtime_error, "Property object must have 2 phases");
+        }
+        const int num_cells = props.numCells();
+        std::vector<int> cells(num_cells);
+        for (int i = 0; i < num_cells; ++i) {
+            cells[i] = i;
+        }
+        smin_.resize(2*num_cells);
+        smax_.resize(2*num_cells);
+        props.satRange(num_cells, &cells[0], &smin_[0], &smax_[0]);
+    }
+
+
+
+
+    double TwophaseFluidPolymer::density(int phase) const
+    {
+        return props_->density()[phase];
+    }
+
+
+
+
+    const double* TwophaseFluidPolymer::porosity() const
+    {
+        return props_->porosity();
+    }
+
+
+
+
+    double TwophaseFluidPolymer::rockdensity() const
+    {
+        return polyprops_->rockDensity();
+    }
+
+
+
+
+    double TwophaseFluidPolymer::deadporespace() const
+    {
+        return polyprops_->deadPoreVol();
+    }
+
+
+
+
+    double TwophaseFluidPolymer::s_min(int cell) const
+    {
+        return smin_[2*cell + 0];
+    }
+
+
+
+
+    double TwophaseFluidPolymer::s_max(int cell) const
+    {
+        return smax_[2*cell + 0];
+    }
+
+
+
+
+    void TwophaseFluidPolymer::mobility(const int n, const int* cells, const double* s,
+                                        const double* c, const double* cmax,
+                                        double* mob, double* dmobds, double* dmobwatdc) const
+    {
+        double* relperm = kr_.get(2*n);
+        double* drelperm_ds = dkr_.get(4*n);
+        props_->relperm(n, s, cells, relperm, drelperm_ds);
+        const double* visc = props_->viscosity();
+        for (int i = 0; i < n; ++i) {
+            polyprops_->effectiveMobilitiesWithDer(c[i], cmax[i], visc, relperm + 2*i, drelperm_ds + 4*i,
+                                                   mob + 2*i, dmobds + 4*i, dmobwatdc[i]);
+        }
+    }
+
+
+
+
+    void TwophaseFluidPolymer::adsorption(double c, double cmax, double& cads, double& dcadsdc) const
+    {
+        polyprops_->adsorptionWithDer(c, cmax, cads, dcadsdc);
+    }
+
+
+
+
+    void TwophaseFluidPolymer::computeMc(double c, double& mc, double& dmcdc) const
+    {
+        polyprops_->computeMcWithDer(c, mc, dmcdc);
+    }
+
+
+
+
+    void TwophaseFluidPolymer::pc(const int n, const int* cells, const double* s,
+                                  double* pcap, double* dpcap) const
+    {
+        double* pcow = pcow_.get(2*n);
+        double* dpcds = dpcds_.get(4*n);
+        props_->capPress(n, s, cells, pcow, dpcds);
+        for (int i = 0; i < n; ++i) {
+            pcap[i] = pcow[2*i + 0];
+            dpcap[i] = dpcds[4*i + 0];
+        }
+    }
+
+} // namespace Opm
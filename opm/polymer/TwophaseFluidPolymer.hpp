@@ -0,0 +1,101 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_TWOPHASEFLUIDPOLYMER_HEADER_INCLUDED
+#define OPM_TWOPHASEFLUIDPOLYMER_HEADER_INCLUDED
+
+#include <opm/polymer/ScratchBuffer.hpp>
+#include <vector>
+
+namespace Opm
+{
+
+    class IncompPropertiesInterface;
+    class PolymerProperties;
+
+    /// Fluid model for SinglePointUpwindTwoPhasePolymer, evaluating the
+    /// incompressible two-phase properties and the polymer properties
+    /// cell by cell. The property objects are referred to, not copied,
+    /// and must outlive the fluid (and any flux model holding a copy).
+    /// The batched evaluations use scratch storage sized for all cells
+    /// at construction, so they do not allocate, and must not be
+    /// called concurrently on the same object.
+    class TwophaseFluidPolymer
+    {
+    public:
+        /// Construct fluid.
+        /// \param[in] props      Rock and fluid properties.
+        /// \param[in] polyprops  Polymer properties.
+        TwophaseFluidPolymer(const IncompPropertiesInterface& props,
+                             const PolymerProperties& polyprops);
+
+        /// Phase density of phase (0 = water, 1 = oil).
+        double density(int phase) const;
+
+        /// Porosity, one value per cell.
+        const double* porosity() const;
+
+        /// Rock density used for adsorption.
+        double rockdensity() const;
+
+        /// Dead pore volume fraction.
+        double deadporespace() const;
+
+        /// Lower and upper water saturation bounds of a cell.
+        double s_min(int cell) const;
+        double s_max(int cell) const;
+
+        /// Phase mobilities with derivatives, for n cells at once.
+        /// \param[in]  cells      The n cells.
+        /// \param[in]  s          Saturations, 2 per cell.
+        /// \param[in]  c, cmax    Concentration and max concentration, 1 per cell.
+        /// \param[out] mob        Mobilities (water, oil), 2 per cell.
+        /// \param[out] dmobds     Derivatives with respect to saturations, 4 per cell,
+        ///                        same layout as PolymerProperties::effectiveMobilitiesWithDer().
+        /// \param[out] dmobwatdc  Derivative of the water mobility with respect to c, 1 per cell.
+        void mobility(const int n, const int* cells, const double* s,
+                      const double* c, const double* cmax,
+                      double* mob, double* dmobds, double* dmobwatdc) const;
+
+        /// Adsorbed concentration and its derivative with respect to c.
+        void adsorption(double c, double cmax, double& cads, double& dcadsdc) const;
+
+        /// Polymer concentration carried by the water phase, with derivative.
+        void computeMc(double c, double& mc, double& dmcdc) const;
+
+        /// Capillary pressure p_o - p_w and its derivative with respect to s_w,
+        /// for n cells at once (s has 2 values per cell, the outputs 1).
+        void pc(const int n, const int* cells, const double* s,
+                double* pcap, double* dpcap) const;
+
+    private:
+        const IncompPropertiesInterface* props_;
+        const PolymerProperties* polyprops_;
+        std::vector<double> smin_;
+        std::vector<double> smax_;
+        // Scratch storage for mobility() and pc().
+        mutable ScratchBuffer<double> kr_;
+        mutable ScratchBuffer<double> dkr_;
+        mutable ScratchBuffer<double> pcow_;
+        mutable ScratchBuffer<double> dpcds_;
+    };
+
+} // namespace Opm
+
+#endif // OPM_TWOPHASEFLUIDPOLYMER_HEADER_INCLUDED
@@ -0,0 +1,70 @@
+/*
+  Copyright 2014 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#include <opm/polymer/WellNameIndex.hpp>
+#include <opm/core/wells.h>
+
+namespace Opm
+{
+
+    WellNameIndex::WellNameIndex()
+    {
+    }
+
+
+
+    WellNameIndex::WellNameIndex(const Wells* wells)
+    {
+        if (wells == 0) {
+            return;
+        }
+        const int nw = wells->number_of_wells;
+        index_.reserve(nw);
+        for (int w = 0; w < nw; ++w) {
+            if (wells->name[w] != 0) {
+                index_.insert(std::make_pair(std::string(wells->name[w]), w));
+            }
+        }
+    }
+
+
+
+    int WellNameIndex::index(const std::string& name) const
+    {
+        std::unordered_map<std::string, int>::const_iterator it = index_.find(name);
+        return (it == index_.end()) ? -1 : it->second;
+    }
+
+
+
+    bool WellNameIndex::contains(const std::string& name) const
+    {
+        return index_.find(name) != index_.end();
+    }
+
+
+
+    int WellNameIndex::size() const
+    {
+        return index_.size();
+    }
+
+} // namespace Opm
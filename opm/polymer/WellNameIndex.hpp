@@ -0,0 +1,63 @@
+/*
+  Copyright 2014 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_WELLNAMEINDEX_HEADER_INCLUDED
+#define OPM_WELLNAMEINDEX_HEADER_INCLUDED
+
+#include <string>
+#include <unordered_map>
+
+struct Wells;
+
+namespace Opm
+{
+
+    /// @brief Hash index from well name to well number in a Wells struct.
+    /// The index is built once per Wells object (i.e. once per report
+    /// step) and may then be shared by all code that needs to resolve
+    /// deck well names, such as polymer inflow and RESV control setup.
+    class WellNameIndex
+    {
+    public:
+        /// Construct an empty index.
+        WellNameIndex();
+
+        /// Construct index for all named wells.
+        /// \param[in]  wells  Wells structure, may be null.
+        explicit WellNameIndex(const Wells* wells);
+
+        /// Well number of named well.
+        /// \param[in]  name  Well name.
+        /// \return  Index into Wells arrays, or -1 if not found.
+        int index(const std::string& name) const;
+
+        /// Test if named well is present.
+        bool contains(const std::string& name) const;
+
+        /// Number of indexed wells.
+        int size() const;
+
+    private:
+        std::unordered_map<std::string, int> index_;
+    };
+
+} // namespace Opm
+
+
+#endif // OPM_WELLNAMEINDEX_HEADER_INCLUDED
@@ -29,6 +29,7 @@
 #include <opm/autodiff/LinearisedBlackoilResidual.hpp>
 #include <opm/autodiff/NewtonIterationBlackoilInterface.hpp>
 #include <opm/polymer/PolymerProperties.hpp>
+#include <opm/polymer/PolymerStepMaxConcentration.hpp>
 #include <opm/polymer/fullyimplicit/PolymerPropsAd.hpp>
 
 #include <array>
@@ -42,7 +43,9 @@ namespace Opm {
     class DerivedGeology;
     class RockCompressibility;
     class NewtonIterationBlackoilInterface;
+    class NewtonIterationBlackoilReorderCPR;
     class PolymerBlackoilState;
+    class PolymerWellboreTransport;
     class WellStateFullyImplicitBlackoil;
 
 
@@ -119,6 +122,24 @@ namespace Opm {
         ///                                   of the grid passed in the constructor.
         void setThresholdPressures(const std::vector<double>& threshold_pressures_by_face);
 
+        /// \brief Use a multi-segment wellbore model for injected polymer.
+        /// Instead of imposing the injected concentration at every
+        /// perforation, the concentration leaving each perforation is
+        /// obtained from the wellbore transport model, re-solved on
+        /// every Newton iteration. The model must have been prepared
+        /// for the step with beginStep(), and must outlive the solver.
+        /// \param[in]  wellbore_transport   wellbore model, or null to disable
+        void setWellboreTransport(const PolymerWellboreTransport* wellbore_transport);
+
+        /// \brief Give the reorder CPR linear solver the flow direction.
+        /// Before every linear solve the water flux of the last
+        /// assembly is passed to reorder_cpr->setFlowDirection(), so
+        /// that its second stage sweeps in upwind order. This requires
+        /// an UnstructuredGrid, other grids sweep in natural order.
+        /// \param[in]  reorder_cpr   the linear solver given to the constructor,
+        ///                           or null to disable
+        void setReorderSolver(NewtonIterationBlackoilReorderCPR* reorder_cpr);
+
         /// Take a single forward step, modifiying
         ///   state.pressure()
         ///   state.faceflux()
@@ -137,6 +158,10 @@ namespace Opm {
 
         unsigned int newtonIterations () const { return newtonIterations_; }
         unsigned int linearIterations () const { return linearIterations_; }
+        /// Number of Newton iterations where oscillations were detected.
+        unsigned int oscillationDetections () const { return oscillationDetections_; }
+        /// Accumulated wall-clock time spent assembling well equations.
+        double wellAssemblyTime () const { return wellAssemblyTime_; }
 
     private:
         // Types and enums
@@ -172,9 +197,11 @@ namespace Opm {
         };
 
         struct WellOps {
-            WellOps(const Wells* wells);
+            WellOps(const Wells* wells, const int nc);
             M w2p;              // well -> perf (scatter)
             M p2w;              // perf -> well (gather)
+            M p2c;              // perf -> cell (scatter)
+            V is_inj;           // injector == 1, producer == 0
         };
 
         enum { Water        = BlackoilPropsAdInterface::Water,
@@ -201,6 +228,7 @@ namespace Opm {
         HelperOps                       ops_;
         const WellOps                   wops_;
         V                               cmax_;
+        PolymerStepMaxConcentration     step_cmax_;
         const bool has_disgas_;
         const bool has_vapoil_;
         const bool has_polymer_;
@@ -209,8 +237,12 @@ namespace Opm {
         SolverParameter                 param_;
         bool use_threshold_pressure_;
         V threshold_pressures_by_interior_face_;
+        const PolymerWellboreTransport* wellbore_transport_;
+        NewtonIterationBlackoilReorderCPR* reorder_cpr_;
 
         std::vector<ReservoirResidualQuant> rq_;
+        // Upwind selection per phase, set up by computeMassFlux().
+        std::vector<UpwindSelector<double> > upwind_;
         std::vector<PhasePresence> phaseCondition_;
         V well_perforation_pressure_diffs_; // Diff to bhp for each well perforation.
 
@@ -220,6 +252,8 @@ namespace Opm {
         bool terminal_output_;
         unsigned int newtonIterations_;
         unsigned int linearIterations_;
+        unsigned int oscillationDetections_;
+        double wellAssemblyTime_;
 
         std::vector<int>         primalVariable_;
 
@@ -259,6 +293,18 @@ namespace Opm {
                   V& aliveWells,
                   const std::vector<double>& polymer_inflow);
 
+        /// Polymer source terms per perforation.
+        /// \param[in] state           solution state
+        /// \param[in] cq_ps_water     water inflow rates into wellbore (producing connections)
+        /// \param[in] cq_is_water     water outflow rates from wellbore (injecting connections)
+        /// \param[in] polymer_inflow  injected concentration, per cell
+        /// \return                    polymer mass rates for all perforations
+        ADB
+        computePolymerWellSource(const SolutionState& state,
+                                 const ADB& cq_ps_water,
+                                 const ADB& cq_is_water,
+                                 const std::vector<double>& polymer_inflow) const;
+
         void updateWellControls(ADB& bhp,
                                 ADB& well_phase_flow_rate,
                                 WellStateFullyImplicitBlackoil& xw) const;
@@ -22,6 +22,10 @@
 
 #include <opm/polymer/fullyimplicit/FullyImplicitBlackoilPolymerSolver.hpp>
 #include <opm/polymer/PolymerBlackoilState.hpp>
+#include <opm/polymer/PolymerLog.hpp>
+#include <opm/polymer/PolymerTrace.hpp>
+#include <opm/polymer/PolymerWellboreTransport.hpp>
+#include <opm/polymer/fullyimplicit/NewtonIterationBlackoilReorderCPR.hpp>
 
 #include <opm/autodiff/AutoDiffBlock.hpp>
 #include <opm/autodiff/AutoDiffHelpers.hpp>
@@ -38,6 +42,7 @@
 #include <opm/core/utility/ErrorMacros.hpp>
 #include <opm/core/utility/Exceptions.hpp>
 #include <opm/core/utility/Units.hpp>
+#include <opm/core/utility/StopWatch.hpp>
 #include <opm/core/well_controls.h>
 #include <opm/core/utility/parameters/ParameterGroup.hpp>
 
@@ -85,6 +90,21 @@ typedef Eigen::Array<double,
 namespace detail {
 
 
+    // The reorder CPR solver sweeps in the upwind order of an
+    // UnstructuredGrid, other grid types use its natural order.
+    inline const UnstructuredGrid* unstructuredGrid(const UnstructuredGrid& grid)
+    {
+        return &grid;
+    }
+
+    template <class Grid>
+    const UnstructuredGrid* unstructuredGrid(const Grid&)
+    {
+        return 0;
+    }
+
+
+
     std::vector<int>
     buildAllCells(const int nc)
     {
@@ -229,7 +249,7 @@ namespace detail {
         , canph_ (detail::active2Canonical(fluid.phaseUsage()))
         , cells_ (detail::buildAllCells(Opm::AutoDiffGrid::numCells(grid)))
         , ops_   (grid)
-        , wops_  (wells_)
+        , wops_  (wells_, Opm::AutoDiffGrid::numCells(grid))
         , cmax_(V::Zero(Opm::AutoDiffGrid::numCells(grid)))
         , has_disgas_(has_disgas)
         , has_vapoil_(has_vapoil)
@@ -237,6 +257,8 @@ namespace detail {
         , poly_pos_(detail::polymerPos(fluid.phaseUsage()))
         , param_( param )
         , use_threshold_pressure_(false)
+        , wellbore_transport_(0)
+        , reorder_cpr_(0)
         , rq_    (fluid.numPhases())
         , phaseCondition_(AutoDiffGrid::numCells(grid))
         , residual_ ( { std::vector<ADB>(fluid.numPhases(), ADB::null()),
@@ -245,6 +267,8 @@ namespace detail {
         , terminal_output_ (terminal_output)
         , newtonIterations_( 0 )
         , linearIterations_( 0 )
+        , oscillationDetections_( 0 )
+        , wellAssemblyTime_( 0.0 )
     {
 #if HAVE_MPI
         if ( terminal_output_ ) {
@@ -291,6 +315,31 @@ namespace detail {
 
 
 
+    template<class T>
+    void
+    FullyImplicitBlackoilPolymerSolver<T>::
+    setWellboreTransport(const PolymerWellboreTransport* wellbore_transport)
+    {
+        wellbore_transport_ = wellbore_transport;
+    }
+
+
+
+
+    template<class T>
+    void
+    FullyImplicitBlackoilPolymerSolver<T>::
+    setReorderSolver(NewtonIterationBlackoilReorderCPR* reorder_cpr)
+    {
+        if (reorder_cpr != 0 && reorder_cpr != &linsolver_) {
+            OPM_THROW(std::logic_error, "The reorder CPR solver must be the linear solver of the Newton iterations.");
+        }
+        reorder_cpr_ = reorder_cpr;
+    }
+
+
+
+
     template<class T>
     int
     FullyImplicitBlackoilPolymerSolver<T>::
@@ -299,17 +348,22 @@ namespace detail {
          WellStateFullyImplicitBlackoil& xw,
          const std::vector<double>& polymer_inflow)
     {
+        OPM_POLYMER_TRACE_SCOPE("step");
         const V pvdt = geo_.poreVolume() / dt;
 
         // Initial max concentration of this time step from PolymerBlackoilState.
-        cmax_ = Eigen::Map<V>(&x.maxconcentration()[0], Opm::AutoDiffGrid::numCells(grid_));
+        step_cmax_.beginStep(x);
+        cmax_ = Eigen::Map<const V>(&step_cmax_.accumulation(1)[0], Opm::AutoDiffGrid::numCells(grid_));
         if (active_[Gas]) { updatePrimalVariableFromState(x); }
 
         // For each iteration we store in a vector the norms of the residual of
         // the mass balance for each active phase, the well flux and the well equations
         std::vector<std::vector<double>> residual_norms_history;
 
+        long elided = polymer_props_ad_.elidedBlockOperations();
         assemble(pvdt, x, true, xw, polymer_inflow);
+        OPM_POLYMER_LOG_DEBUG("Iteration 0: elided zero Jacobian blocks in polymer properties: "
+                              << polymer_props_ad_.elidedBlockOperations() - elided);
 
 
         bool converged = false;
@@ -337,6 +391,8 @@ namespace detail {
             detectNewtonOscillations(residual_norms_history, it, relaxRelTol(), isOscillate, isStagnate);
 
             if (isOscillate) {
+                ++oscillationDetections_;
+                OPM_POLYMER_TRACE_INSTANT("Newton oscillation");
                 omega -= relaxIncrement();
                 omega = std::max(omega, relaxMax());
                 if (terminal_output_)
@@ -349,12 +405,15 @@ namespace detail {
 
             updateState(dx, x, xw);
 
+            elided = polymer_props_ad_.elidedBlockOperations();
             assemble(pvdt, x, false, xw, polymer_inflow);
 
             residual_norms_history.push_back(computeResidualNorms());
 
             // increase iteration counter
             ++it;
+            OPM_POLYMER_LOG_DEBUG("Iteration " << it << ": elided zero Jacobian blocks in polymer properties: "
+                                  << polymer_props_ad_.elidedBlockOperations() - elided);
 
             converged = getConvergence(dt,it);
         }
@@ -410,33 +469,43 @@ namespace detail {
 
     template<class T>
     FullyImplicitBlackoilPolymerSolver<T>::
-    WellOps::WellOps(const Wells* wells)
+    WellOps::WellOps(const Wells* wells, const int nc)
       : w2p(),
-        p2w()
+        p2w(),
+        p2c(),
+        is_inj()
     {
         if( wells )
         {
             w2p = M(wells->well_connpos[ wells->number_of_wells ], wells->number_of_wells);
             p2w = M(wells->number_of_wells, wells->well_connpos[ wells->number_of_wells ]);
+            p2c = M(nc, wells->well_connpos[ wells->number_of_wells ]);
 
             const int        nw   = wells->number_of_wells;
             const int* const wpos = wells->well_connpos;
 
             typedef Eigen::Triplet<double> Tri;
 
-            std::vector<Tri> scatter, gather;
-            scatter.reserve(wpos[nw]);
-            gather .reserve(wpos[nw]);
+            std::vector<Tri> scatter, gather, cscatter;
+            scatter .reserve(wpos[nw]);
+            gather  .reserve(wpos[nw]);
+            cscatter.reserve(wpos[nw]);
 
+            is_inj = V::Zero(nw);
             for (int w = 0, i = 0; w < nw; ++w) {
+                if (wells->type[w] == INJECTOR) {
+                    is_inj[w] = 1.0;
+                }
                 for (; i < wpos[ w + 1 ]; ++i) {
-                    scatter.push_back(Tri(i, w, 1.0));
-                    gather .push_back(Tri(w, i, 1.0));
+                    scatter .push_back(Tri(i, w, 1.0));
+                    gather  .push_back(Tri(w, i, 1.0));
+                    cscatter.push_back(Tri(wells->well_cells[i], i, 1.0));
                 }
             }
 
-            w2p.setFromTriplets(scatter.begin(), scatter.end());
-            p2w.setFromTriplets(gather .begin(), gather .end());
+            w2p.setFromTriplets(scatter .begin(), scatter .end());
+            p2w.setFromTriplets(gather  .begin(), gather  .end());
+            p2c.setFromTriplets(cscatter.begin(), cscatter.end());
         }
     }
 
@@ -660,6 +729,7 @@ namespace detail {
     FullyImplicitBlackoilPolymerSolver<T>::computeAccum(const SolutionState& state,
                                                         const int            aix  )
     {
+        OPM_POLYMER_TRACE_SCOPE("computeAccum");
         const Opm::PhaseUsage& pu = fluid_.phaseUsage();
 
         const ADB&              press = state.pressure;
@@ -700,7 +770,8 @@ namespace detail {
                 
         if (has_polymer_) {
             // compute polymer properties.
-            const ADB cmax = ADB::constant(cmax_, state.concentration.blockPattern());
+            const V cmax_accum = Eigen::Map<const V>(&step_cmax_.accumulation(aix)[0], AutoDiffGrid::numCells(grid_));
+            const ADB cmax = ADB::constant(cmax_accum, state.concentration.blockPattern());
             const ADB ads  = polymer_props_ad_.adsorption(state.concentration, cmax);
             const double rho_rock = polymer_props_ad_.rockDensity();
             const V phi = Eigen::Map<const V>(& fluid_.porosity()[0], AutoDiffGrid::numCells(grid_), 1);
@@ -720,12 +791,7 @@ namespace detail {
     template<class T>
     void FullyImplicitBlackoilPolymerSolver<T>::computeCmax(PolymerBlackoilState& state)
     {
-        const int nc = AutoDiffGrid::numCells(grid_);
-        V tmp = V::Zero(nc);
-        for (int i = 0; i < nc; ++i) {
-            tmp[i] = std::max(state.maxconcentration()[i], state.concentration()[i]);
-        }
-        std::copy(&tmp[0], &tmp[0] + nc, state.maxconcentration().begin());
+        PolymerStepMaxConcentration::endStep(state);
     }
 
 
@@ -834,6 +900,7 @@ namespace detail {
              WellStateFullyImplicitBlackoil& xw,
              const std::vector<double>& polymer_inflow)
     {
+        OPM_POLYMER_TRACE_SCOPE("assemble");
         using namespace Opm::AutoDiffGrid;
         // Create the primary variables.
         SolutionState state = variableState(x, xw);
@@ -871,6 +938,7 @@ namespace detail {
         // for each active phase.
         const V transi = subset(geo_.transmissibility(), ops_.internal_faces);
         const std::vector<ADB> kr = computeRelPerm(state);
+        // Also sets up upwind_ for each phase.
         computeMassFlux(transi, kr, state.canonical_phase_pressures, state);
         for (int phaseIdx = 0; phaseIdx < fluid_.numPhases(); ++phaseIdx) {
             //            computeMassFlux(phaseIdx, transi, kr[canph_[phaseIdx]], state.canonical_phase_pressures[canph_[phaseIdx]], state);
@@ -888,13 +956,9 @@ namespace detail {
             const int po = fluid_.phaseUsage().phase_pos[ Oil ];
             const int pg = fluid_.phaseUsage().phase_pos[ Gas ];
 
-            const UpwindSelector<double> upwindOil(grid_, ops_,
-                                                rq_[po].head.value());
-            const ADB rs_face = upwindOil.select(state.rs);
-
-            const UpwindSelector<double> upwindGas(grid_, ops_,
-                                                rq_[pg].head.value());
-            const ADB rv_face = upwindGas.select(state.rv);
+            // Dissolved gas moves with the oil, vaporized oil with the gas.
+            const ADB rs_face = upwind_[po].select(state.rs);
+            const ADB rv_face = upwind_[pg].select(state.rv);
 
             residual_.material_balance_eq[ pg ] += ops_.div * (rs_face * rq_[po].mflux);
             residual_.material_balance_eq[ po ] += ops_.div * (rv_face * rq_[pg].mflux);
@@ -910,10 +974,14 @@ namespace detail {
         }
         // Note: updateWellControls() can change all its arguments if
         // a well control is switched.
+        Opm::time::StopWatch well_timer;
+        well_timer.start();
         updateWellControls(state.bhp, state.qs, xw);
         V aliveWells;
         addWellEq(state, xw, aliveWells, polymer_inflow);
         addWellControlEq(state, xw, aliveWells);
+        well_timer.stop();
+        wellAssemblyTime_ += well_timer.secsSinceStart();
     }
 
 
@@ -927,8 +995,8 @@ namespace detail {
                                                           const std::vector<double>& polymer_inflow)
     {
         if( ! wellsActive() ) return ;
+        OPM_POLYMER_TRACE_SCOPE("addWellEq");
 
-        const int nc = Opm::AutoDiffGrid::numCells(grid_);
         const int np = wells().number_of_phases;
         const int nw = wells().number_of_wells;
         const int nperf = wells().well_connpos[nw];
@@ -959,12 +1027,7 @@ namespace detail {
         auto connInjInx = drawdown.value() < 0;
 
         // injector == 1, producer == 0
-        V isInj = V::Zero(nw);
-        for (int w = 0; w < nw; ++w) {
-            if (wells().type[w] == INJECTOR) {
-                isInj[w] = 1;
-            }
-        }
+        const V& isInj = wops_.is_inj;
 
 //        // A cross-flow connection is defined as a connection which has opposite
 //        // flow-direction to the well total flow
@@ -985,14 +1048,8 @@ namespace detail {
 //        TODO: not allow for crossflow
 
 
-        V isInjInx = V::Zero(nperf);
-        V isNotInjInx = V::Zero(nperf);
-        for (int c = 0; c < nperf; ++c){
-            if (connInjInx[c])
-                isInjInx[c] = 1;
-            else
-                isNotInjInx[c] = 1;
-        }
+        const V isInjInx = connInjInx.cast<double>();
+        const V isNotInjInx = 1.0 - isInjInx;
 
 
         // HANDLE FLOW INTO WELLBORE
@@ -1100,29 +1157,29 @@ namespace detail {
         ADB cqt_is = cqt_i/volRat;
 
         // connection phase volumerates at std cond
+        std::vector<ADB> cq_is(np, ADB::null());
         std::vector<ADB> cq_s(np, ADB::null());
         for (int phase = 0; phase < np; ++phase) {
-            cq_s[phase] = cq_ps[phase] + (wops_.w2p * mix_s[phase])*cqt_is;
+            cq_is[phase] = cmix_s[phase]*cqt_is;
+            cq_s[phase] = cq_ps[phase] + cq_is[phase];
         }
 
         // DUMPVAL(mix_s[2]);
         // DUMPVAL(cq_ps[2]);
 
-        // Add well contributions to mass balance equations
+        // Add well contributions to mass balance equations. The scatter
+        // through p2c still forms a cell-sized value and Jacobian per
+        // equation: an ADB cannot be added to in place on a subset of
+        // its rows, and the product is the cheapest way to reach one.
         for (int phase = 0; phase < np; ++phase) {
-            residual_.material_balance_eq[phase] -= superset(cq_s[phase],well_cells,nc);
+            residual_.material_balance_eq[phase] -= wops_.p2c * cq_s[phase];
         }
 
-        
         // Add well contributions to polymer mass balance equation
         if (has_polymer_) {
-            const ADB mc = computeMc(state);
-            const V polyin = Eigen::Map<const V>(&polymer_inflow[0], nc);
-            const V poly_in_perf = subset(polyin, well_cells);
-            const V poly_mc_perf = subset(mc, well_cells).value();
-            residual_.material_balance_eq[poly_pos_] -= superset(cq_ps[pu.phase_pos[Water]]*poly_mc_perf
-                                                     + (wops_.w2p * mix_s[pu.phase_pos[Water]])*cqt_is*poly_in_perf,
-                                                     well_cells, nc);
+            const int water_pos = pu.phase_pos[Water];
+            residual_.material_balance_eq[poly_pos_] -=
+                wops_.p2c * computePolymerWellSource(state, cq_ps[water_pos], cq_is[water_pos], polymer_inflow);
         }
 
 
@@ -1149,6 +1206,66 @@ namespace detail {
 
 
 
+    template <class T>
+    ADB
+    FullyImplicitBlackoilPolymerSolver<T>::computePolymerWellSource(const SolutionState& state,
+                                                                    const ADB& cq_ps_water,
+                                                                    const ADB& cq_is_water,
+                                                                    const std::vector<double>& polymer_inflow) const
+    {
+        // Everything is evaluated on perforations only: producing
+        // connections carry the reservoir concentration (through m(c)c),
+        // injecting connections carry the injected concentration, or the
+        // wellbore concentration if a segment model is used.
+        const int nw = wells().number_of_wells;
+        const int nperf = wells().well_connpos[nw];
+        const std::vector<int> well_cells(wells().well_cells, wells().well_cells + nperf);
+        ADB poly_in_perf = ADB::null();
+        if (wellbore_transport_) {
+            // The segment concentrations depend on the injecting rates
+            // of the well, through the per-well recurrence. Chain their
+            // derivatives onto those of the rates, so the Jacobian stays
+            // consistent with the residual.
+            std::vector<double> perf_conc;
+            std::vector<double> dconc_drate;
+            wellbore_transport_->solve(cq_is_water.value().data(), perf_conc, dconc_drate);
+            typedef Eigen::Triplet<double> Tri;
+            std::vector<Tri> entries;
+            entries.reserve(dconc_drate.size());
+            const int* const wpos = wells().well_connpos;
+            for (int w = 0, block = 0; w < nw; ++w) {
+                const int n = wpos[w + 1] - wpos[w];
+                for (int i = 0; i < n; ++i) {
+                    for (int j = 0; j < n; ++j, ++block) {
+                        if (dconc_drate[block] != 0.0) {
+                            entries.push_back(Tri(wpos[w] + i, wpos[w] + j, dconc_drate[block]));
+                        }
+                    }
+                }
+            }
+            M dconc(nperf, nperf);
+            dconc.setFromTriplets(entries.begin(), entries.end());
+            std::vector<M> jacs(cq_is_water.numBlocks());
+            for (int block = 0; block < cq_is_water.numBlocks(); ++block) {
+                jacs[block] = dconc * cq_is_water.derivative()[block];
+            }
+            V conc = Eigen::Map<const V>(perf_conc.data(), nperf);
+            poly_in_perf = ADB::function(std::move(conc), std::move(jacs));
+        } else {
+            V conc(nperf);
+            for (int perf = 0; perf < nperf; ++perf) {
+                conc[perf] = polymer_inflow[well_cells[perf]];
+            }
+            poly_in_perf = ADB::constant(conc);
+        }
+        const ADB mc_perf = polymer_props_ad_.polymerWaterVelocityRatio(subset(state.concentration, well_cells));
+        return cq_ps_water * mc_perf + cq_is_water * poly_in_perf;
+    }
+
+
+
+
+
     namespace detail
     {
         double rateToCompare(const ADB& well_phase_flow_rate,
@@ -1266,6 +1383,7 @@ namespace detail {
             }
             if (ctrl_index != nwc) {
                 // Constraint number ctrl_index was broken, switch to it.
+                OPM_POLYMER_TRACE_INSTANT("well control switch");
                 if (terminal_output_)
                 {
                     std::cout << "Switching control mode for well " << wells().name[w]
@@ -1403,6 +1521,17 @@ namespace detail {
     template<class T>
     V FullyImplicitBlackoilPolymerSolver<T>::solveJacobianSystem() const
     {
+        OPM_POLYMER_TRACE_SCOPE("solveJacobianSystem");
+        const UnstructuredGrid* ug = detail::unstructuredGrid(grid_);
+        if (reorder_cpr_ != 0 && ug != 0 && active_[Water]) {
+            // Water flux of the last assembly, on all faces.
+            const V& mflux = rq_[fluid_.phaseUsage().phase_pos[Water]].mflux.value();
+            std::vector<double> face_flux(ug->number_of_faces, 0.0);
+            for (int i = 0; i < ops_.internal_faces.size(); ++i) {
+                face_flux[ops_.internal_faces[i]] = mflux[i];
+            }
+            reorder_cpr_->setFlowDirection(*ug, &face_flux[0], fluid_.numPhases());
+        }
         return linsolver_.computeNewtonIncrement(residual_);
     }
 
@@ -1434,6 +1563,7 @@ namespace detail {
                                                             PolymerBlackoilState& state,
                                                             WellStateFullyImplicitBlackoil& well_state)
     {
+        OPM_POLYMER_TRACE_SCOPE("updateState");
         using namespace Opm::AutoDiffGrid;
         const int np = fluid_.numPhases();
         const int nc = numCells(grid_);
@@ -1857,6 +1987,11 @@ namespace detail {
                                                            const std::vector<ADB>& phasePressure,
                                                            const SolutionState&    state)
     {
+        OPM_POLYMER_TRACE_SCOPE("computeMassFlux");
+        // One upwind selection per phase potential, reused for polymer
+        // (water) and in assemble() for rs and rv (oil and gas).
+        upwind_.clear();
+        upwind_.reserve(fluid_.numPhases());
         for (int phase = 0; phase < fluid_.numPhases(); ++phase) {
             const int canonicalPhaseIdx = canph_[phase];
             const std::vector<PhasePresence> cond = phaseCondition();
@@ -1880,6 +2015,8 @@ namespace detail {
             }
 
             head = transi*dp;
+            upwind_.push_back(UpwindSelector<double>(grid_, ops_, head.value()));
+            const UpwindSelector<double>& upwind = upwind_.back();
             if (canonicalPhaseIdx == Water) {
                 if(has_polymer_) {
                     const ADB cmax = ADB::constant(cmax_, state.concentration.blockPattern());
@@ -1893,14 +2030,11 @@ namespace detail {
                     rq_[poly_pos_].mob = tr_mult * mc * krw_eff * inv_wat_eff_visc; 
                     rq_[poly_pos_].b = rq_[phase].b;
                     rq_[poly_pos_].head = rq_[phase].head;
-                    UpwindSelector<double> upwind(grid_, ops_, rq_[poly_pos_].head.value());
                     rq_[poly_pos_].mflux = upwind.select(rq_[poly_pos_].b * rq_[poly_pos_].mob) * rq_[poly_pos_].head;
                 }
             }
             //head      = transi*(ops_.ngrad * phasePressure) + gflux;
 
-            UpwindSelector<double> upwind(grid_, ops_, head.value());
-
             const ADB& b       = rq_[phase].b;
             const ADB& mob     = rq_[phase].mob;
             rq_[phase].mflux = upwind.select(b * mob) * head;
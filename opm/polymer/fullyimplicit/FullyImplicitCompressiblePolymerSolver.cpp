@@ -33,12 +33,15 @@
 #include <opm/core/linalg/LinearSolverInterface.hpp>
 #include <opm/core/props/rock/RockCompressibility.hpp>
 #include <opm/polymer/PolymerBlackoilState.hpp>
+#include <opm/polymer/PolymerLog.hpp>
+#include <opm/polymer/PolymerTrace.hpp>
 #include <opm/core/utility/ErrorMacros.hpp>
 #include <opm/core/well_controls.h>
 #include <cassert>
 #include <cmath>
 #include <iostream>
 #include <iomanip>
+#include <sstream>
 
 // A debugging utility.
 #define DUMP(foo)                                                       \
@@ -202,8 +205,10 @@ namespace {
          WellStateFullyImplicitBlackoil& xw,
          const std::vector<double>& polymer_inflow)
     {
+        OPM_POLYMER_TRACE_SCOPE("step");
         // Initial max concentration of this time step from PolymerBlackoilState.
-        cmax_ = Eigen::Map<V>(&x.maxconcentration()[0], Opm::AutoDiffGrid::numCells(grid_));
+        step_cmax_.beginStep(x);
+        cmax_ = Eigen::Map<const V>(&step_cmax_.accumulation(1)[0], Opm::AutoDiffGrid::numCells(grid_));
 
         const SolutionState state = constantState(x, xw);
         computeAccum(state, 0);
@@ -211,20 +216,26 @@ namespace {
         const double atol  = 1.0e-12;
         const double rtol  = 5.0e-8;
         const int    maxit = 15;
+        long elided = polymer_props_ad_.elidedBlockOperations();
         assemble(dt, x, xw, polymer_inflow);
 
         const double r0  = residualNorm();
         const double r_polymer = residual_.material_balance_eq[2].value().matrix().lpNorm<Eigen::Infinity>();
         int          it  = 0;
-        std::cout << "\nIteration         Residual     Polymer Res\n"
-                  << std::setw(9) << it << std::setprecision(9)
-                  << std::setw(18) << r0 << std::setprecision(9)
-                  << std::setw(18) << r_polymer << std::endl;
+        // The iteration table is written as one message after the loop.
+        std::ostringstream table;
+        table << "\nIteration         Residual     Polymer Res\n"
+              << std::setw(9) << it << std::setprecision(9)
+              << std::setw(18) << r0 << std::setprecision(9)
+              << std::setw(18) << r_polymer;
+        OPM_POLYMER_LOG_DEBUG("Elided zero Jacobian blocks in polymer properties: "
+                              << polymer_props_ad_.elidedBlockOperations() - elided);
         bool resTooLarge = r0 > atol;
         while (resTooLarge && (it < maxit)) {
             const V dx = solveJacobianSystem();
 
             updateState(dx, x, xw);
+            elided = polymer_props_ad_.elidedBlockOperations();
             assemble(dt, x, xw, polymer_inflow);
 
             const double r = residualNorm();
@@ -233,13 +244,16 @@ namespace {
             resTooLarge = (r > atol) && (r > rtol*r0);
 
             it += 1;
-            std::cout << std::setw(9) << it << std::setprecision(9)
-                      << std::setw(18) << r << std::setprecision(9)
-                  << std::setw(18) << rr_polymer << std::endl;
+            table << '\n' << std::setw(9) << it << std::setprecision(9)
+                  << std::setw(18) << r << std::setprecision(9)
+                  << std::setw(18) << rr_polymer;
+            OPM_POLYMER_LOG_DEBUG("Elided zero Jacobian blocks in polymer properties: "
+                                  << polymer_props_ad_.elidedBlockOperations() - elided);
         }
+        OPM_POLYMER_LOG_INFO(table.str());
 
         if (resTooLarge) {
-            std::cerr << "Failed to compute converged solution in " << it << " iterations. Ignoring!\n";
+            OPM_POLYMER_LOG_WARNING("Failed to compute converged solution in " << it << " iterations. Ignoring!");
             // OPM_THROW(std::runtime_error, "Failed to compute converged solution in " << it << " iterations.");
         }
 
@@ -456,6 +470,7 @@ namespace {
     FullyImplicitCompressiblePolymerSolver::computeAccum(const SolutionState& state,
                                               		     const int            aix  )
     {
+        OPM_POLYMER_TRACE_SCOPE("computeAccum");
 
         const ADB&              press = state.pressure;
         const ADB&              temp  = state.temperature;
@@ -472,7 +487,8 @@ namespace {
         }
         rq_[0].accum[aix] = pv_mult * rq_[0].b * sat[0];
         rq_[1].accum[aix] = pv_mult * rq_[1].b * sat[1];
-		const ADB cmax = ADB::constant(cmax_, state.concentration.blockPattern());
+        const V cmax_accum = Eigen::Map<const V>(&step_cmax_.accumulation(aix)[0], grid_.number_of_cells);
+		const ADB cmax = ADB::constant(cmax_accum, state.concentration.blockPattern());
         const ADB ads = polymer_props_ad_.adsorption(state.concentration, cmax);
         const double rho_rock = polymer_props_ad_.rockDensity();
         const V phi = Eigen::Map<const V>(&fluid_.porosity()[0], grid_.number_of_cells, 1);
@@ -489,13 +505,7 @@ namespace {
     FullyImplicitCompressiblePolymerSolver::
     computeCmax(PolymerBlackoilState& state)
     {
-        const int nc = grid_.number_of_cells;
-        V tmp = V::Zero(nc);
-        for (int i = 0; i < nc; ++i) {
-            tmp[i] = std::max(state.maxconcentration()[i], state.concentration()[i]);
-        }
-
-        std::copy(&tmp[0], &tmp[0] + nc, state.maxconcentration().begin());
+        PolymerStepMaxConcentration::endStep(state);
     }
 
 
@@ -509,6 +519,7 @@ namespace {
              const WellStateFullyImplicitBlackoil& xw,
              const std::vector<double>& polymer_inflow)
     {
+        OPM_POLYMER_TRACE_SCOPE("assemble");
         // Create the primary variables.
         //
         const SolutionState state = variableState(x, xw);
@@ -680,6 +691,7 @@ namespace {
 
     V FullyImplicitCompressiblePolymerSolver::solveJacobianSystem() const
     {
+        OPM_POLYMER_TRACE_SCOPE("solveJacobianSystem");
         return linsolver_.computeNewtonIncrement(residual_);
     }
 
@@ -702,6 +714,7 @@ namespace {
                 PolymerBlackoilState& 	state,
                 WellStateFullyImplicitBlackoil& 				well_state) const
     {
+        OPM_POLYMER_TRACE_SCOPE("updateState");
         const int np = fluid_.numPhases();
         const int nc = grid_.number_of_cells;
         const int nw = wells_.number_of_wells;
@@ -848,6 +861,7 @@ namespace {
                                                  const ADB&              krw_eff,
                                                  const SolutionState&    state )
     {
+        OPM_POLYMER_TRACE_SCOPE("computeMassFlux");
         const ADB tr_mult = transMult(state.pressure);
         const std::vector<PhasePresence> cond = phaseCondition();
 		std::vector<ADB> press = computePressures(state);
@@ -866,15 +880,17 @@ namespace {
             const ADB rhoavg = ops_.caver * rho;
             const ADB dp = ops_.ngrad * press[phase] - geo_.gravity()[2] * (rhoavg * (ops_.ngrad * geo_.z().matrix()));
             head = transi*dp;
-            UpwindSelector<double> upwind(grid_, ops_, head.value());
+            const UpwindSelector<double> upwind(grid_, ops_, head.value());
             const ADB& b       = rq_[phase].b;
             const ADB& mob     = rq_[phase].mob;
             rq_[phase].mflux = upwind.select(b * mob) * head;
+            if (phase == 0) {
+                // Polymer moves with the water, reuse its upwind selection.
+                rq_[2].b = rq_[0].b;
+                rq_[2].head = rq_[0].head;
+                rq_[2].mflux = upwind.select(rq_[2].b * rq_[2].mob) * rq_[2].head;
+            }
         }
-        rq_[2].b = rq_[0].b;
-        rq_[2].head = rq_[0].head;
-        UpwindSelector<double> upwind(grid_, ops_, rq_[2].head.value());
-        rq_[2].mflux = upwind.select(rq_[2].b * rq_[2].mob) * rq_[2].head;
     }
 
 
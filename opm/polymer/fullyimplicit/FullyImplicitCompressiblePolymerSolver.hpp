@@ -27,6 +27,7 @@
 #include <opm/autodiff/NewtonIterationBlackoilInterface.hpp>
 #include <opm/autodiff/LinearisedBlackoilResidual.hpp>
 #include <opm/polymer/PolymerProperties.hpp>
+#include <opm/polymer/PolymerStepMaxConcentration.hpp>
 #include <opm/polymer/fullyimplicit/PolymerPropsAd.hpp>
 
 struct UnstructuredGrid;
@@ -136,6 +137,7 @@ namespace Opm {
         const WellOps                   wops_;
         const M                         grav_;
 		V    			 				cmax_;
+        PolymerStepMaxConcentration     step_cmax_;
         std::vector<PhasePresence> phaseCondition_;
         std::vector<ReservoirResidualQuant> rq_;
         // The mass_balance vector has one element for each active phase,
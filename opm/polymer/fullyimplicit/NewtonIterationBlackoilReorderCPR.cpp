@@ -0,0 +1,457 @@
+/*
+  Copyright 2014 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+#include <opm/polymer/fullyimplicit/NewtonIterationBlackoilReorderCPR.hpp>
+#include <opm/polymer/PolymerLog.hpp>
+#include <opm/autodiff/AutoDiffHelpers.hpp>
+#include <opm/core/grid.h>
+#include <opm/core/transport/reorder/reordersequence.h>
+#include <opm/core/utility/ErrorMacros.hpp>
+#include <opm/core/utility/Exceptions.hpp>
+#include <opm/core/utility/parameters/ParameterGroup.hpp>
+#include <Eigen/Dense>
+#include <Eigen/IterativeLinearSolvers>
+#include <Eigen/SparseLU>
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/operators.hh>
+#include <dune/istl/preconditioners.hh>
+#include <dune/istl/paamg/amg.hh>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace Opm
+{
+
+    namespace
+    {
+
+        typedef AutoDiffBlock<double> ADB;
+        typedef Eigen::SparseMatrix<double> ColMatrix;
+        typedef Eigen::SparseMatrix<double, Eigen::RowMajor> RowMatrix;
+        typedef Eigen::Triplet<double> Triplet;
+        typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> DenseBlock;
+
+        // The pressure stage, with the AMG setup of the elliptic stage
+        // of NewtonIterationBlackoilCPR.
+        typedef Dune::BCRSMatrix<Dune::FieldMatrix<double, 1, 1> > PressureMatrix;
+        typedef Dune::BlockVector<Dune::FieldVector<double, 1> > PressureVector;
+        typedef Dune::MatrixAdapter<PressureMatrix, PressureVector, PressureVector> PressureOperator;
+        typedef Dune::SeqILU0<PressureMatrix, PressureVector, PressureVector> PressureSmoother;
+        typedef Dune::Amg::AMG<PressureOperator, PressureVector, PressureSmoother> PressureAmg;
+        typedef Dune::Amg::CoarsenCriterion<Dune::Amg::SymmetricCriterion<PressureMatrix, Dune::Amg::FirstDiagonal> > PressureCriterion;
+
+        /// Two-stage CPR preconditioner, with the interface of the
+        /// preconditioners of Eigen's iterative solvers. The cell
+        /// unknowns are ordered by variable, unknown v of cell i has
+        /// index v*nc + i, with pressure first.
+        class ReorderCprPreconditioner
+        {
+        public:
+            ReorderCprPreconditioner()
+                : matrix_(0), nc_(0), neq_(0), num_pressure_equations_(0),
+                  order_(0), sweeps_(1),
+                  info_(Eigen::Success)
+            {
+            }
+
+            void setup(const RowMatrix& matrix, const int nc, const int neq,
+                       const int num_pressure_equations,
+                       const std::vector<int>* order, const int sweeps,
+                       const double relax)
+            {
+                matrix_ = &matrix;
+                nc_ = nc;
+                neq_ = neq;
+                num_pressure_equations_ = num_pressure_equations;
+                order_ = order;
+                sweeps_ = sweeps;
+                info_ = Eigen::Success;
+
+                // First stage: the pressure equation is a quasi-IMPES
+                // combination of the phase equations. The weights of a
+                // cell decouple its pressure from its other unknowns in
+                // the diagonal block, and scale the pressure diagonal
+                // to one, so that the rows of different phases enter
+                // with matching scales.
+                computeWeights(matrix);
+                std::vector<Triplet> triplets;
+                triplets.reserve(matrix.nonZeros()/neq);
+                for (int eq = 0; eq < num_pressure_equations_; ++eq) {
+                    for (int cell = 0; cell < nc_; ++cell) {
+                        const double w = weights_[cell*num_pressure_equations_ + eq];
+                        for (RowMatrix::InnerIterator it(matrix, eq*nc_ + cell); it; ++it) {
+                            if (it.col() < nc_) {
+                                triplets.push_back(Triplet(cell, it.col(), w*it.value()));
+                            }
+                        }
+                    }
+                }
+                RowMatrix pressure_matrix(nc_, nc_);
+                pressure_matrix.setFromTriplets(triplets.begin(), triplets.end());
+                setupPressureAmg(pressure_matrix, relax);
+
+                // Second stage: inverses of the diagonal cell blocks.
+                diag_inv_.resize(nc_*neq_*neq_);
+                DenseBlock block(neq_, neq_);
+                for (int cell = 0; cell < nc_; ++cell) {
+                    block.setZero();
+                    for (int eq = 0; eq < neq_; ++eq) {
+                        for (RowMatrix::InnerIterator it(matrix, eq*nc_ + cell); it; ++it) {
+                            if (it.col() % nc_ == cell) {
+                                block(eq, it.col()/nc_) = it.value();
+                            }
+                        }
+                    }
+                    const Eigen::FullPivLU<DenseBlock> lu(block);
+                    if (!lu.isInvertible()) {
+                        info_ = Eigen::NumericalIssue;
+                        return;
+                    }
+                    Eigen::Map<DenseBlock>(&diag_inv_[cell*neq_*neq_], neq_, neq_) = lu.inverse();
+                }
+            }
+
+            template <class MatrixType>
+            ReorderCprPreconditioner& analyzePattern(const MatrixType&)
+            {
+                return *this;
+            }
+
+            template <class MatrixType>
+            ReorderCprPreconditioner& factorize(const MatrixType&)
+            {
+                return *this;
+            }
+
+            template <class MatrixType>
+            ReorderCprPreconditioner& compute(const MatrixType&)
+            {
+                return *this;
+            }
+
+            Eigen::ComputationInfo info() const
+            {
+                return info_;
+            }
+
+            template <class Rhs>
+            Eigen::VectorXd solve(const Rhs& b) const
+            {
+                Eigen::VectorXd x;
+                apply(b, x);
+                return x;
+            }
+
+        private:
+            // Quasi-IMPES weights: w solves D^T w = e_p, with D the
+            // block of the phase equations and the first
+            // num_pressure_equations unknowns on the diagonal of the
+            // cell. Cells with a singular block use the plain sum.
+            void computeWeights(const RowMatrix& matrix)
+            {
+                const int np = num_pressure_equations_;
+                weights_.assign(nc_*np, 1.0);
+                DenseBlock block(np, np);
+                Eigen::VectorXd unit = Eigen::VectorXd::Zero(np);
+                unit[0] = 1.0;
+                for (int cell = 0; cell < nc_; ++cell) {
+                    block.setZero();
+                    for (int eq = 0; eq < np; ++eq) {
+                        for (RowMatrix::InnerIterator it(matrix, eq*nc_ + cell); it; ++it) {
+                            if (it.col() % nc_ == cell && it.col()/nc_ < np) {
+                                block(eq, it.col()/nc_) = it.value();
+                            }
+                        }
+                    }
+                    const Eigen::FullPivLU<DenseBlock> lu(block.transpose());
+                    if (lu.isInvertible()) {
+                        Eigen::Map<Eigen::VectorXd>(&weights_[cell*np], np) = lu.solve(unit);
+                    }
+                }
+            }
+
+            // Build the AMG hierarchy of the weighted pressure matrix,
+            // as the CPR solver does for its elliptic stage.
+            void setupPressureAmg(const RowMatrix& pressure_matrix, const double relax)
+            {
+                pressure_amg_.reset();
+                pressure_operator_.reset();
+                pressure_matrix_.reset(new PressureMatrix(nc_, nc_, pressure_matrix.nonZeros(),
+                                                          PressureMatrix::row_wise));
+                PressureMatrix& pm = *pressure_matrix_;
+                for (PressureMatrix::CreateIterator row = pm.createbegin(); row != pm.createend(); ++row) {
+                    for (RowMatrix::InnerIterator it(pressure_matrix, row.index()); it; ++it) {
+                        row.insert(it.col());
+                    }
+                }
+                for (int cell = 0; cell < nc_; ++cell) {
+                    for (RowMatrix::InnerIterator it(pressure_matrix, cell); it; ++it) {
+                        pm[cell][it.col()] = it.value();
+                    }
+                }
+                pressure_operator_.reset(new PressureOperator(pm));
+                Dune::Amg::SmootherTraits<PressureSmoother>::Arguments smoother_args;
+                smoother_args.iterations = 1;
+                smoother_args.relaxationFactor = relax;
+                PressureCriterion criterion(15, 2000);
+                criterion.setDebugLevel(0);
+                criterion.setDefaultValuesIsotropic(2);
+                criterion.setNoPreSmoothSteps(1);
+                criterion.setNoPostSmoothSteps(1);
+                pressure_amg_.reset(new PressureAmg(*pressure_operator_, criterion, smoother_args));
+                xp_.resize(nc_);
+                rp_.resize(nc_);
+                xp_ = 0.0;
+                rp_ = 0.0;
+                pressure_amg_->pre(xp_, rp_);
+            }
+
+            void apply(const Eigen::VectorXd& b, Eigen::VectorXd& x) const
+            {
+                // Pressure correction, one AMG cycle on the weighted
+                // pressure residual.
+                const int np = num_pressure_equations_;
+                for (int cell = 0; cell < nc_; ++cell) {
+                    double sum = 0.0;
+                    for (int eq = 0; eq < np; ++eq) {
+                        sum += weights_[cell*np + eq]*b[eq*nc_ + cell];
+                    }
+                    rp_[cell] = sum;
+                }
+                xp_ = 0.0;
+                pressure_amg_->apply(xp_, rp_);
+                x.setZero(b.size());
+                for (int cell = 0; cell < nc_; ++cell) {
+                    x[cell] = xp_[cell];
+                }
+                r_ = b - (*matrix_)*x;
+
+                // Block Gauss-Seidel on the remaining residual, in
+                // upwind order. Only cells already visited in this
+                // sweep have nonzero corrections, so with an exact
+                // upwind order the off-diagonal terms are the upstream
+                // ones.
+                y_.setZero(b.size());
+                Eigen::VectorXd rhs(neq_);
+                for (int sweep = 0; sweep < sweeps_; ++sweep) {
+                    for (int k = 0; k < nc_; ++k) {
+                        const int cell = order_ ? (*order_)[k] : k;
+                        for (int eq = 0; eq < neq_; ++eq) {
+                            const int row = eq*nc_ + cell;
+                            double sum = r_[row];
+                            for (RowMatrix::InnerIterator it(*matrix_, row); it; ++it) {
+                                if (it.col() % nc_ != cell) {
+                                    sum -= it.value()*y_[it.col()];
+                                }
+                            }
+                            rhs[eq] = sum;
+                        }
+                        const Eigen::Map<const DenseBlock> inv(&diag_inv_[cell*neq_*neq_], neq_, neq_);
+                        const Eigen::VectorXd dy = inv*rhs;
+                        for (int eq = 0; eq < neq_; ++eq) {
+                            y_[eq*nc_ + cell] = dy[eq];
+                        }
+                    }
+                }
+                x += y_;
+            }
+
+            const RowMatrix* matrix_;
+            int nc_;
+            int neq_;
+            int num_pressure_equations_;
+            const std::vector<int>* order_;
+            int sweeps_;
+            Eigen::ComputationInfo info_;
+            std::vector<double> weights_;
+            // The operator refers to the matrix, the AMG to both.
+            std::unique_ptr<PressureMatrix> pressure_matrix_;
+            std::unique_ptr<PressureOperator> pressure_operator_;
+            std::unique_ptr<PressureAmg> pressure_amg_;
+            std::vector<double> diag_inv_;
+            mutable PressureVector xp_;
+            mutable PressureVector rp_;
+            mutable Eigen::VectorXd r_;
+            mutable Eigen::VectorXd y_;
+        };
+
+    } // anonymous namespace
+
+
+
+
+    NewtonIterationBlackoilReorderCPR::NewtonIterationBlackoilReorderCPR(const parameter::ParameterGroup& param)
+        : iterations_(0),
+          num_phases_(0)
+    {
+        reduction_ = param.getDefault("linear_solver_reduction", 1e-2);
+        maxit_ = param.getDefault("linear_solver_maxiter", 150);
+        sweeps_ = param.getDefault("cpr_reorder_sweeps", 1);
+        relax_ = param.getDefault("cpr_relax", 1.0);
+        if (sweeps_ < 1) {
+            OPM_THROW(std::runtime_error, "cpr_reorder_sweeps must be at least 1, got " << sweeps_);
+        }
+    }
+
+
+
+
+    void NewtonIterationBlackoilReorderCPR::setFlowDirection(const UnstructuredGrid& grid,
+                                                             const double* face_flux,
+                                                             const int num_phases)
+    {
+        const int nc = grid.number_of_cells;
+        sequence_.resize(nc);
+        components_.resize(nc + 1);
+        int ncomp;
+        compute_sequence(&grid, face_flux, &sequence_[0], &components_[0], &ncomp);
+        num_phases_ = num_phases;
+    }
+
+
+
+
+    NewtonIterationBlackoilReorderCPR::SolutionVector
+    NewtonIterationBlackoilReorderCPR::computeNewtonIncrement(const LinearisedBlackoilResidual& residual) const
+    {
+        // The equations, cell equations first.
+        std::vector<const ADB*> eqs;
+        for (std::size_t eq = 0; eq < residual.material_balance_eq.size(); ++eq) {
+            eqs.push_back(&residual.material_balance_eq[eq]);
+        }
+        const int neq = eqs.size();
+        const int nc = residual.material_balance_eq[0].size();
+        const int ncv = neq*nc;
+        if (residual.well_flux_eq.size() > 0) {
+            eqs.push_back(&residual.well_flux_eq);
+            eqs.push_back(&residual.well_eq);
+        }
+
+        // Split the Jacobian into the cell block A, the well block D
+        // and the couplings B (cell equations, well unknowns) and C.
+        std::vector<Triplet> a_triplets;
+        std::vector<Triplet> b_triplets;
+        std::vector<Triplet> c_triplets;
+        std::vector<Triplet> d_triplets;
+        std::vector<double> rhs;
+        for (std::size_t eq = 0; eq < eqs.size(); ++eq) {
+            const int row_offset = rhs.size();
+            const ColMatrix jac = collapseJacs(*eqs[eq]);
+            for (int col = 0; col < jac.outerSize(); ++col) {
+                for (ColMatrix::InnerIterator it(jac, col); it; ++it) {
+                    const int row = row_offset + it.row();
+                    if (row < ncv) {
+                        if (col < ncv) {
+                            a_triplets.push_back(Triplet(row, col, it.value()));
+                        } else {
+                            b_triplets.push_back(Triplet(row, col - ncv, it.value()));
+                        }
+                    } else {
+                        if (col < ncv) {
+                            c_triplets.push_back(Triplet(row - ncv, col, it.value()));
+                        } else {
+                            d_triplets.push_back(Triplet(row - ncv, col - ncv, it.value()));
+                        }
+                    }
+                }
+            }
+            const ADB::V& value = eqs[eq]->value();
+            rhs.insert(rhs.end(), value.data(), value.data() + value.size());
+        }
+        const int size = rhs.size();
+        const int nw = size - ncv;
+        RowMatrix matrix(ncv, ncv);
+        matrix.setFromTriplets(a_triplets.begin(), a_triplets.end());
+        Eigen::VectorXd rc = Eigen::Map<const Eigen::VectorXd>(&rhs[0], ncv);
+
+        // Eliminate the well unknowns.
+        Eigen::SparseLU<ColMatrix> well_solver;
+        ColMatrix c_block(nw, ncv);
+        Eigen::VectorXd rw;
+        if (nw > 0) {
+            ColMatrix b_block(ncv, nw);
+            ColMatrix d_block(nw, nw);
+            b_block.setFromTriplets(b_triplets.begin(), b_triplets.end());
+            c_block.setFromTriplets(c_triplets.begin(), c_triplets.end());
+            d_block.setFromTriplets(d_triplets.begin(), d_triplets.end());
+            rw = Eigen::Map<const Eigen::VectorXd>(&rhs[ncv], nw);
+            well_solver.compute(d_block);
+            if (well_solver.info() != Eigen::Success) {
+                OPM_THROW(LinearSolverProblem, "Singular well equations in reorder CPR solver.");
+            }
+            const ColMatrix dinv_c = well_solver.solve(c_block);
+            const ColMatrix schur = b_block*dinv_c;
+            matrix -= RowMatrix(schur);
+            const Eigen::VectorXd dinv_rw = well_solver.solve(rw);
+            rc -= b_block*dinv_rw;
+        }
+
+        // Solve the cell system.
+        const bool have_order = int(sequence_.size()) == nc;
+        if (!have_order) {
+            OPM_POLYMER_LOG_DEBUG("Reorder CPR: no flow direction, sweeping in natural cell order.");
+        }
+        const int num_pressure_equations = (num_phases_ > 0) ? std::min(num_phases_, neq) : neq;
+        Eigen::BiCGSTAB<RowMatrix, ReorderCprPreconditioner> solver;
+        solver.preconditioner().setup(matrix, nc, neq, num_pressure_equations,
+                                      have_order ? &sequence_ : 0, sweeps_, relax_);
+        if (solver.preconditioner().info() != Eigen::Success) {
+            OPM_THROW(LinearSolverProblem, "Could not set up the reorder CPR preconditioner.");
+        }
+        solver.setTolerance(reduction_);
+        solver.setMaxIterations(maxit_);
+        solver.compute(matrix);
+        const Eigen::VectorXd dxc = solver.solve(rc);
+        iterations_ = solver.iterations();
+        if (solver.info() != Eigen::Success) {
+            OPM_THROW(LinearSolverProblem, "Convergence failure for linear system.");
+        }
+
+        // Recover the well unknowns.
+        SolutionVector dx(size);
+        dx.head(ncv) = dxc.array();
+        if (nw > 0) {
+            const Eigen::VectorXd dxw = well_solver.solve(rw - c_block*dxc);
+            dx.tail(nw) = dxw.array();
+        }
+        return dx;
+    }
+
+
+
+
+    int NewtonIterationBlackoilReorderCPR::iterations() const
+    {
+        return iterations_;
+    }
+
+
+
+
+    const boost::any& NewtonIterationBlackoilReorderCPR::parallelInformation() const
+    {
+        return parallel_information_;
+    }
+
+} // namespace Opm
@@ -0,0 +1,95 @@
+/*
+  Copyright 2014 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPM_NEWTONITERATIONBLACKOILREORDERCPR_HEADER_INCLUDED
+#define OPM_NEWTONITERATIONBLACKOILREORDERCPR_HEADER_INCLUDED
+
+#include <opm/autodiff/NewtonIterationBlackoilInterface.hpp>
+#include <boost/any.hpp>
+#include <vector>
+
+struct UnstructuredGrid;
+
+namespace Opm
+{
+
+    namespace parameter { class ParameterGroup; }
+
+    /// @brief CPR linear solver with a reordered Gauss-Seidel second stage.
+    ///
+    /// The well equations are eliminated by a Schur complement, and the
+    /// remaining cell system is solved with BiCGStab and a two-stage
+    /// preconditioner. The first stage applies one AMG cycle to the
+    /// pressure equation, a quasi-IMPES weighted sum of the phase mass
+    /// balances, set up like the elliptic stage of
+    /// NewtonIterationBlackoilCPR. The second stage is a block
+    /// Gauss-Seidel sweep over the cells, one block of all cell
+    /// unknowns per cell, in the upwind order of the water flux given
+    /// to setFlowDirection(). For advection dominated
+    /// systems the sweep follows the flow, like the reorder transport
+    /// solvers, and is nearly exact for the transport part. Without a
+    /// flow direction the cells are swept in their natural order.
+    class NewtonIterationBlackoilReorderCPR : public NewtonIterationBlackoilInterface
+    {
+    public:
+        /// Construct from parameters, this class accepts the following:
+        ///     parameter (default)            effect
+        /// -----------------------------------------------------------
+        ///     linear_solver_reduction (1e-2) relative residual reduction
+        ///     linear_solver_maxiter (150)    max BiCGStab iterations
+        ///     cpr_reorder_sweeps (1)         Gauss-Seidel sweeps in the second stage
+        ///     cpr_relax (1.0)                relaxation of the AMG smoother
+        explicit NewtonIterationBlackoilReorderCPR(const parameter::ParameterGroup& param);
+
+        /// Set the sweep order of the second stage from a face flux, as
+        /// in the reorder transport solvers. Positive flux goes from
+        /// face_cells[2*f] to face_cells[2*f + 1]. The first
+        /// num_phases material balance equations are summed to form the
+        /// pressure equation, leaving out e.g. a polymer equation.
+        /// The order is used by all later calls to
+        /// computeNewtonIncrement().
+        void setFlowDirection(const UnstructuredGrid& grid,
+                              const double* face_flux,
+                              const int num_phases);
+
+        /// Solve the linearised system J dx = r.
+        virtual SolutionVector computeNewtonIncrement(const LinearisedBlackoilResidual& residual) const;
+
+        /// Number of BiCGStab iterations of the last solve.
+        virtual int iterations() const;
+
+        /// No parallel information, this solver is serial.
+        virtual const boost::any& parallelInformation() const;
+
+    private:
+        double reduction_;
+        int maxit_;
+        int sweeps_;
+        double relax_;
+        mutable int iterations_;
+        int num_phases_;
+        std::vector<int> sequence_;
+        std::vector<int> components_;
+        boost::any parallel_information_;
+    };
+
+} // namespace Opm
+
+
+#endif // OPM_NEWTONITERATIONBLACKOILREORDERCPR_HEADER_INCLUDED
@@ -19,6 +19,7 @@
 */
 
 #include "config.h"
+#include <algorithm>
 #include <cmath>
 #include <vector>
 #include <opm/autodiff/AutoDiffBlock.hpp>
@@ -30,6 +31,62 @@ namespace Opm {
     typedef PolymerPropsAd::ADB ADB;
     typedef PolymerPropsAd::V V;
 
+    namespace
+    {
+
+        /// Jacobian blocks of f(x), given the diagonal matrix df/dx.
+        /// Blocks where x is structurally zero are left empty instead of
+        /// forming the product, and counted in elided.
+        std::vector<ADB::M> chainRule(const ADB::M& dfdx, const ADB& x, long& elided)
+        {
+            const int num_blocks = x.numBlocks();
+            std::vector<ADB::M> jacs(num_blocks);
+            for (int block = 0; block < num_blocks; ++block) {
+                const ADB::M& dx = x.derivative()[block];
+                if (dx.nonZeros() == 0) {
+                    jacs[block] = ADB::M(x.size(), dx.cols());
+                    ++elided;
+                } else {
+                    jacs[block] = dfdx * dx;
+                }
+            }
+            return jacs;
+        }
+
+
+
+
+        /// Jacobian blocks of f(x, y), given the diagonal matrices df/dx
+        /// and df/dy. Either argument may be a constant without blocks.
+        std::vector<ADB::M> chainRule(const ADB::M& dfdx, const ADB& x,
+                                      const ADB::M& dfdy, const ADB& y,
+                                      long& elided)
+        {
+            const int num_blocks = std::max(x.numBlocks(), y.numBlocks());
+            std::vector<ADB::M> jacs(num_blocks);
+            for (int block = 0; block < num_blocks; ++block) {
+                const bool x_active = block < x.numBlocks() && x.derivative()[block].nonZeros() > 0;
+                const bool y_active = block < y.numBlocks() && y.derivative()[block].nonZeros() > 0;
+                if (x_active && y_active) {
+                    jacs[block] = dfdx * x.derivative()[block] + dfdy * y.derivative()[block];
+                } else if (x_active) {
+                    jacs[block] = dfdx * x.derivative()[block];
+                    ++elided;
+                } else if (y_active) {
+                    jacs[block] = dfdy * y.derivative()[block];
+                    ++elided;
+                } else {
+                    const ADB::M& d = block < x.numBlocks() ? x.derivative()[block]
+                                                            : y.derivative()[block];
+                    jacs[block] = ADB::M(d.rows(), d.cols());
+                    elided += 2;
+                }
+            }
+            return jacs;
+        }
+
+    } // anonymous namespace
+
 
 
 
@@ -65,8 +122,18 @@ namespace Opm {
 	
 
     PolymerPropsAd::PolymerPropsAd(const PolymerProperties& polymer_props)
-        : polymer_props_ (polymer_props)
+        : polymer_props_ (polymer_props),
+          elided_blocks_ (0)
+    {
+    }
+
+
+
+
+
+    long PolymerPropsAd::elidedBlockOperations() const
     {
+        return elided_blocks_;
     }
 
 
@@ -112,11 +179,7 @@ namespace Opm {
     	    dinv_mu_w_eff(i) = dim;
     	}
         ADB::M dim_diag = spdiag(dinv_mu_w_eff);
-        const int num_blocks = c.numBlocks();
-        std::vector<ADB::M> jacs(num_blocks);
-        for (int block = 0; block < num_blocks; ++block) {
-            jacs[block] = dim_diag * c.derivative()[block];
-        }
+        std::vector<ADB::M> jacs = chainRule(dim_diag, c, elided_blocks_);
         return ADB::function(std::move(inv_mu_w_eff), std::move(jacs));
     }
 
@@ -159,11 +222,7 @@ namespace Opm {
         }
 
         ADB::M dmc_diag = spdiag(dmc);
-        const int num_blocks = c.numBlocks();
-        std::vector<ADB::M> jacs(num_blocks);
-        for (int block = 0; block < num_blocks; ++block) {
-            jacs[block] = dmc_diag * c.derivative()[block];
-        }
+        std::vector<ADB::M> jacs = chainRule(dmc_diag, c, elided_blocks_);
 
         return ADB::function(std::move(mc), std::move(jacs));
     }
@@ -207,11 +266,7 @@ namespace Opm {
         }
 
         ADB::M dads_diag = spdiag(dads);
-        int num_blocks = c.numBlocks();
-        std::vector<ADB::M> jacs(num_blocks);
-        for (int block = 0; block < num_blocks; ++block) {
-            jacs[block] = dads_diag * c.derivative()[block];
-        }
+        std::vector<ADB::M> jacs = chainRule(dads_diag, c, elided_blocks_);
 
         return ADB::function(std::move(ads), std::move(jacs));
     }
@@ -250,14 +305,20 @@ namespace Opm {
         const int nc = c.value().size();
         V one = V::Ones(nc);
         ADB ads = adsorption(c, cmax_cells);
-        V krw_eff = effectiveRelPerm(c.value(), cmax_cells.value(), krw.value());
 
         double max_ads = polymer_props_.cMaxAds();
         double res_factor = polymer_props_.resFactor();
         double factor = (res_factor - 1.) / max_ads;
-        ADB rk = one + ads * factor; 
-        
-        return krw / rk;
+        V rk = one + factor * ads.value();
+        V krw_eff = krw.value() / rk;
+
+        // krw depends on saturation and ads on concentration only, so
+        // most blocks of the quotient are structurally zero.
+        ADB::M dkrw_diag = spdiag(one / rk);
+        ADB::M dads_diag = spdiag(-factor * krw_eff / rk);
+        std::vector<ADB::M> jacs = chainRule(dkrw_diag, krw, dads_diag, ads, elided_blocks_);
+
+        return ADB::function(std::move(krw_eff), std::move(jacs));
     }
 
 }// namespace Opm
@@ -103,8 +103,13 @@ namespace Opm {
         ADB
         effectiveRelPerm(const ADB& c, const ADB& cmax_cells, const ADB& krw, const ADB& sw) const;
 
+		/// \return 	Number of Jacobian block products skipped so far
+		///				because the blocks were structurally zero.
+        long elidedBlockOperations() const;
+
     private:
         const PolymerProperties& polymer_props_;
+        mutable long elided_blocks_;
     };
     
 } //namespace Opm
@@ -35,6 +35,7 @@ namespace Opm
     class RockCompressibility;
     class DerivedGeology;
     class NewtonIterationBlackoilInterface;
+    class NewtonIterationBlackoilReorderCPR;
     class SimulatorTimer;
     class PolymerBlackoilState;
     class WellStateFullyImplicitBlackoil;
@@ -94,6 +95,12 @@ namespace Opm
                                               Opm::DeckConstPtr& deck,
                                               const std::vector<double>& threshold_pressures_by_face);
 
+        /// Pass the flow direction to a reorder CPR linear solver, see
+        /// FullyImplicitBlackoilPolymerSolver::setReorderSolver().
+        /// \param[in] reorder_cpr   the linear solver given to the constructor,
+        ///                          or null to disable
+        void setReorderSolver(NewtonIterationBlackoilReorderCPR* reorder_cpr);
+
         /// Run the simulation.
         /// This will run succesive timesteps until timer.done() is true. It will
         /// modify the reservoir and well states.
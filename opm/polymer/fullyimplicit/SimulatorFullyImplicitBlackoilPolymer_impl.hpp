@@ -25,6 +25,10 @@
 #include <opm/polymer/fullyimplicit/FullyImplicitBlackoilPolymerSolver.hpp>
 #include <opm/polymer/PolymerBlackoilState.hpp>
 #include <opm/polymer/PolymerInflow.hpp>
+#include <opm/polymer/PolymerLog.hpp>
+#include <opm/polymer/PolymerTrace.hpp>
+#include <opm/polymer/PolymerWellboreTransport.hpp>
+#include <opm/polymer/WellNameIndex.hpp>
 
 #include <opm/core/utility/parameters/ParameterGroup.hpp>
 #include <opm/core/utility/ErrorMacros.hpp>
@@ -32,7 +36,7 @@
 #include <opm/autodiff/GeoProps.hpp>
 #include <opm/autodiff/BlackoilPropsAdInterface.hpp>
 #include <opm/autodiff/WellStateFullyImplicitBlackoil.hpp>
-#include <opm/autodiff/RateConverter.hpp>
+#include <opm/autodiff/AutoDiffBlock.hpp>
 
 #include <opm/core/grid.h>
 #include <opm/core/wells.h>
@@ -99,12 +103,10 @@ namespace Opm
         SimulatorReport run(SimulatorTimer& timer,
                             PolymerBlackoilState& state);
 
+        void setReorderSolver(NewtonIterationBlackoilReorderCPR* reorder_cpr);
+
     private:
         // Data.
-        typedef RateConverter::
-        SurfaceToReservoirVoidage< BlackoilPropsAdInterface,
-                                   std::vector<int> > RateConverterType;
-
         const parameter::ParameterGroup param_;
 
         // Observed objects.
@@ -116,6 +118,7 @@ namespace Opm
         // Solvers
         const DerivedGeology& geo_;
         NewtonIterationBlackoilInterface& solver_;
+        NewtonIterationBlackoilReorderCPR* reorder_cpr_;
         // Misc. data
         std::vector<int> allcells_;
         const bool has_disgas_;
@@ -127,15 +130,23 @@ namespace Opm
         // output_writer
         BlackoilOutputWriter& output_writer_;
         Opm::DeckConstPtr& deck_;
-        RateConverterType rateConverter_;
         // Threshold pressures.
         std::vector<double> threshold_pressures_by_face_;
+        // Optional wellbore polymer transport.
+        std::unique_ptr<PolymerWellboreTransport> wellbore_transport_;
 
         void
         computeRESV(const std::size_t               step,
                     const Wells*                    wells,
-                    const BlackoilState&     x,
+                    const WellNameIndex&            well_index,
+                    const PolymerBlackoilState&     x,
                     WellStateFullyImplicitBlackoil& xw);
+
+        void
+        computeResvCoeff(const Wells&                wells,
+                         const int                   w,
+                         const PolymerBlackoilState& x,
+                         std::vector<double>&        coeff) const;
     };
 
 
@@ -175,6 +186,15 @@ namespace Opm
     }
 
 
+
+
+    template<class T>
+    void SimulatorFullyImplicitBlackoilPolymer<T>::setReorderSolver(NewtonIterationBlackoilReorderCPR* reorder_cpr)
+    {
+        pimpl_->setReorderSolver(reorder_cpr);
+    }
+
+
     // \TODO: Treat bcs.
     template<class T>
     SimulatorFullyImplicitBlackoilPolymer<T>::Impl::Impl(const parameter::ParameterGroup& param,
@@ -200,6 +220,7 @@ namespace Opm
           gravity_(gravity),
           geo_(geo),
           solver_(linsolver),
+          reorder_cpr_(0),
           has_disgas_(has_disgas),
           has_vapoil_(has_vapoil),
           has_polymer_(has_polymer),
@@ -207,7 +228,6 @@ namespace Opm
           eclipse_state_(eclipse_state),
           output_writer_(output_writer),
           deck_(deck),
-          rateConverter_(props_, std::vector<int>(AutoDiffGrid::numCells(grid_), 0)),
           threshold_pressures_by_face_(threshold_pressures_by_face)
     {
         // Misc init.
@@ -227,6 +247,20 @@ namespace Opm
             }
         }
 #endif
+        if (has_polymer_ && param.getDefault("polymer_wellbore_transport", false)) {
+            const double segment_volume = param.getDefault("wellbore_segment_volume", 1.0);
+            const double decay_rate = param.getDefault("polymer_wellbore_decay_rate", 0.0) / unit::day;
+            wellbore_transport_.reset(new PolymerWellboreTransport(segment_volume, decay_rate));
+        }
+    }
+
+
+
+
+    template<class T>
+    void SimulatorFullyImplicitBlackoilPolymer<T>::Impl::setReorderSolver(NewtonIterationBlackoilReorderCPR* reorder_cpr)
+    {
+        reorder_cpr_ = reorder_cpr;
     }
 
 
@@ -269,6 +303,7 @@ namespace Opm
 
         unsigned int totalNewtonIterations = 0;
         unsigned int totalLinearIterations = 0;
+        unsigned int totalOscillationDetections = 0;
 
         // Main simulation loop.
         while (!timer.done()) {
@@ -292,6 +327,7 @@ namespace Opm
             const Wells* wells = wells_manager.c_wells();
             WellStateFullyImplicitBlackoil well_state;
             well_state.init(wells, state.blackoilState(), prev_well_state);
+            const WellNameIndex well_index(wells);
 
             // compute polymer inflow
             std::unique_ptr<PolymerInflowInterface> polymer_inflow_ptr;
@@ -299,7 +335,7 @@ namespace Opm
                 if (wells_manager.c_wells() == 0) {
                     OPM_THROW(std::runtime_error, "Cannot control polymer injection via WPOLYMER without wells.");
                 }
-                polymer_inflow_ptr.reset(new PolymerInflowFromDeck(deck_, eclipse_state_, *wells, Opm::UgGridHelpers::numCells(grid_), timer.currentStepNum()));
+                polymer_inflow_ptr.reset(new PolymerInflowFromDeck(deck_, eclipse_state_, *wells, well_index, Opm::UgGridHelpers::numCells(grid_), timer.currentStepNum()));
             } else {
                 polymer_inflow_ptr.reset(new PolymerInflowBasic(0.0*Opm::unit::day,
                                                                 1.0*Opm::unit::day,
@@ -311,14 +347,17 @@ namespace Opm
                                                 polymer_inflow_c);
             
             // write simulation state at the report stage
-            output_writer_.writeTimeStep( timer, state.blackoilState(), well_state );
+            {
+                OPM_POLYMER_TRACE_SCOPE("output");
+                output_writer_.writeTimeStep( timer, state.blackoilState(), well_state );
+            }
 
             // Max oil saturation (for VPPARS), hysteresis update.
             props_.updateSatOilMax(state.saturation());
             props_.updateSatHyst(state.saturation(), allcells_);
 
             // Compute reservoir volumes for RESV controls.
-            computeRESV(timer.currentStepNum(), wells, state.blackoilState(), well_state);
+            computeRESV(timer.currentStepNum(), wells, well_index, state, well_state);
 
             // Run a multiple steps of the solver depending on the time step control.
             solver_timer.start();
@@ -327,6 +366,11 @@ namespace Opm
             if (!threshold_pressures_by_face_.empty()) {
                 solver.setThresholdPressures(threshold_pressures_by_face_);
             }
+            solver.setReorderSolver(reorder_cpr_);
+            if (wellbore_transport_ && wells) {
+                wellbore_transport_->beginStep(*wells, polymer_inflow_c, timer.currentStepLength());
+                solver.setWellboreTransport(wellbore_transport_.get());
+            }
 
             // If sub stepping is enabled allow the solver to sub cycle
             // in case the report steps are to large for the solver to converge
@@ -339,6 +383,9 @@ namespace Opm
                 // solve for complete report step
             solver.step(timer.currentStepLength(), state, well_state, polymer_inflow_c);
                 //            }
+            if (wellbore_transport_ && wells) {
+                wellbore_transport_->endStep();
+            }
 
             // take time that was used to solve system for this reportStep
             solver_timer.stop();
@@ -346,6 +393,7 @@ namespace Opm
             // accumulate the number of Newton and Linear Iterations
             totalNewtonIterations += solver.newtonIterations();
             totalLinearIterations += solver.linearIterations();
+            totalOscillationDetections += solver.oscillationDetections();
 
             // Report timing.
             const double st = solver_timer.secsSinceStart();
@@ -353,6 +401,7 @@ namespace Opm
             if ( terminal_output_ )
             {
                 std::cout << "Fully implicit solver took: " << st << " seconds." << std::endl;
+                std::cout << "    of which well assembly: " << solver.wellAssemblyTime() << " seconds." << std::endl;
             }
 
             stime += st;
@@ -369,7 +418,10 @@ namespace Opm
         }
 
         // Write final simulation state.
-        output_writer_.writeTimeStep( timer, state.blackoilState(), prev_well_state );
+        {
+            OPM_POLYMER_TRACE_SCOPE("output");
+            output_writer_.writeTimeStep( timer, state.blackoilState(), prev_well_state );
+        }
 
         // Stop timer and create timing report
         total_timer.stop();
@@ -379,22 +431,31 @@ namespace Opm
         report.total_time = total_timer.secsSinceStart();
         report.total_newton_iterations = totalNewtonIterations;
         report.total_linear_iterations = totalLinearIterations;
+        OPM_POLYMER_LOG_INFO("Newton iterations: " << totalNewtonIterations
+                             << ", oscillation detections: " << totalOscillationDetections);
         return report;
     }
 
     namespace SimFIBODetails {
-        typedef std::unordered_map<std::string, WellConstPtr> WellMap;
+        // Schedule wells by well number in the Wells struct; null for
+        // wells without a schedule entry.
+        typedef std::vector<WellConstPtr> WellMap;
 
         inline WellMap
-        mapWells(const std::vector<WellConstPtr>& wells)
+        mapWells(const std::vector<WellConstPtr>& wells,
+                 const Wells*                     c_wells,
+                 const WellNameIndex&             well_index)
         {
-            WellMap wmap;
+            WellMap wmap(c_wells ? c_wells->number_of_wells : 0);
 
             for (std::vector<WellConstPtr>::const_iterator
                      w = wells.begin(), e = wells.end();
                  w != e; ++w)
             {
-                wmap.insert(std::make_pair((*w)->name(), *w));
+                const int ix = well_index.index((*w)->name());
+                if (ix >= 0) {
+                    wmap[ix] = *w;
+                }
             }
 
             return wmap;
@@ -424,16 +485,14 @@ namespace Opm
 
         inline bool
         is_resv(const WellMap&     wmap,
-                const std::string& name,
+                const int          w,
                 const std::size_t  step)
         {
             bool match = false;
 
-            WellMap::const_iterator i = wmap.find(name);
-
-            if (i != wmap.end()) {
-                WellConstPtr wp = i->second;
+            WellConstPtr wp = wmap[w];
 
+            if (wp) {
                 match = (wp->isProducer(step) &&
                          wp->getProductionProperties(step)
                          .hasProductionControl(WellProducer::RESV))
@@ -454,9 +513,7 @@ namespace Opm
             if( wells )
             {
                 for (int w = 0, nw = wells->number_of_wells; w < nw; ++w) {
-                    if (is_resv(*wells, w) ||
-                        ((wells->name[w] != 0) &&
-                         is_resv(wmap, wells->name[w], step)))
+                    if (is_resv(*wells, w) || is_resv(wmap, w, step))
                     {
                         resv_wells.push_back(w);
                     }
@@ -503,13 +560,14 @@ namespace Opm
     SimulatorFullyImplicitBlackoilPolymer<T>::
     Impl::computeRESV(const std::size_t               step,
                       const Wells*                    wells,
-                      const BlackoilState&            x,
+                      const WellNameIndex&            well_index,
+                      const PolymerBlackoilState&     x,
                       WellStateFullyImplicitBlackoil& xw)
     {
         typedef SimFIBODetails::WellMap WellMap;
 
         const std::vector<WellConstPtr>& w_ecl = eclipse_state_->getSchedule()->getWells(step);
-        const WellMap& wmap = SimFIBODetails::mapWells(w_ecl);
+        const WellMap& wmap = SimFIBODetails::mapWells(w_ecl, wells, well_index);
 
         const std::vector<int>& resv_wells = SimFIBODetails::resvWells(wells, step, wmap);
 
@@ -517,11 +575,8 @@ namespace Opm
             const PhaseUsage&                    pu = props_.phaseUsage();
             const std::vector<double>::size_type np = props_.numPhases();
 
-            rateConverter_.defineState(x);
-
             std::vector<double> distr (np);
             std::vector<double> hrates(np);
-            std::vector<double> prates(np);
 
             for (std::vector<int>::const_iterator
                      rp = resv_wells.begin(), e = resv_wells.end();
@@ -530,40 +585,24 @@ namespace Opm
                 WellControls* ctrl = wells->ctrls[*rp];
                 const bool is_producer = wells->type[*rp] == PRODUCER;
 
+                // Conversion coefficients depend on perforated cell
+                // conditions only, and are shared by both control modes.
+                computeResvCoeff(*wells, *rp, x, distr);
+
                 // RESV control mode, all wells
                 {
                     const int rctrl = SimFIBODetails::resv_control(ctrl);
 
                     if (0 <= rctrl) {
-                        const std::vector<double>::size_type off = (*rp) * np;
-
-                        if (is_producer) {
-                            // Convert to positive rates to avoid issues
-                            // in coefficient calculations.
-                            std::transform(xw.wellRates().begin() + (off + 0*np),
-                                           xw.wellRates().begin() + (off + 1*np),
-                                           prates.begin(), std::negate<double>());
-                        } else {
-                            std::copy(xw.wellRates().begin() + (off + 0*np),
-                                      xw.wellRates().begin() + (off + 1*np),
-                                      prates.begin());
-                        }
-
-                        const int fipreg = 0; // Hack.  Ignore FIP regions.
-                        rateConverter_.calcCoeff(prates, fipreg, distr);
-
                         well_controls_iset_distr(ctrl, rctrl, & distr[0]);
                     }
                 }
 
-                // RESV control, WCONHIST wells.  A bit of duplicate
-                // work, regrettably.
-                if (is_producer && wells->name[*rp] != 0) {
-                    WellMap::const_iterator i = wmap.find(wells->name[*rp]);
-
-                    if (i != wmap.end()) {
-                        WellConstPtr wp = i->second;
+                // RESV control, WCONHIST wells.
+                if (is_producer) {
+                    WellConstPtr wp = wmap[*rp];
 
+                    if (wp) {
                         const WellProductionProperties& p =
                             wp->getProductionProperties(step);
 
@@ -571,9 +610,6 @@ namespace Opm
                             // History matching (WCONHIST/RESV)
                             SimFIBODetails::historyRates(pu, p, hrates);
 
-                            const int fipreg = 0; // Hack.  Ignore FIP regions.
-                            rateConverter_.calcCoeff(hrates, fipreg, distr);
-
                             // WCONHIST/RESV target is sum of all
                             // observed phase rates translated to
                             // reservoir conditions.  Recall sign
@@ -606,4 +642,138 @@ namespace Opm
             }
         }
     }
+
+
+
+    /// Reservoir volume coefficients for a well, such that the
+    /// reservoir voidage rate of surface rates q is sum(coeff * q).
+    /// Average conditions are taken over the perforated cells only,
+    /// weighted by connection mobility.  The water mobility uses the
+    /// polymer-modified viscosity, so perforations that polymer has
+    /// made less injective contribute less to the average.
+    template <class T>
+    void
+    SimulatorFullyImplicitBlackoilPolymer<T>::
+    Impl::computeResvCoeff(const Wells&                wells,
+                           const int                   w,
+                           const PolymerBlackoilState& x,
+                           std::vector<double>&        coeff) const
+    {
+        typedef AutoDiffBlock<double> ADB;
+        typedef ADB::V V;
+
+        const PhaseUsage& pu = props_.phaseUsage();
+        const int np = pu.num_phases;
+        const int begin = wells.well_connpos[w];
+        const int nperf = wells.well_connpos[w + 1] - begin;
+
+        std::fill(coeff.begin(), coeff.end(), 0.0);
+        if (nperf == 0) {
+            return;
+        }
+        const std::vector<int> cells(wells.well_cells + begin, wells.well_cells + begin + nperf);
+
+        // Gather perforated cell state.
+        V p(nperf), temp(nperf), rs(nperf), rv(nperf), conc(nperf);
+        std::vector<V> sat(np, V(nperf));
+        std::vector<PhasePresence> cond(nperf);
+        for (int perf = 0; perf < nperf; ++perf) {
+            const int cell = cells[perf];
+            p[perf]    = x.pressure()[cell];
+            temp[perf] = x.temperature()[cell];
+            rs[perf]   = x.gasoilratio()[cell];
+            rv[perf]   = x.rv()[cell];
+            conc[perf] = has_polymer_ ? x.concentration()[cell] : 0.0;
+            for (int phase = 0; phase < np; ++phase) {
+                sat[phase][perf] = x.saturation()[np*cell + phase];
+            }
+            if (pu.phase_used[BlackoilPhases::Aqua] && sat[pu.phase_pos[BlackoilPhases::Aqua]][perf] > 0.0) {
+                cond[perf].setFreeWater();
+            }
+            if (pu.phase_used[BlackoilPhases::Liquid] && sat[pu.phase_pos[BlackoilPhases::Liquid]][perf] > 0.0) {
+                cond[perf].setFreeOil();
+            }
+            if (pu.phase_used[BlackoilPhases::Vapour] && sat[pu.phase_pos[BlackoilPhases::Vapour]][perf] > 0.0) {
+                cond[perf].setFreeGas();
+            }
+        }
+
+        // Connection mobilities.
+        const ADB null = ADB::null();
+        const ADB p_ad = ADB::constant(p);
+        const ADB temp_ad = ADB::constant(temp);
+        const ADB sw = pu.phase_used[BlackoilPhases::Aqua]   ? ADB::constant(sat[pu.phase_pos[BlackoilPhases::Aqua]])   : null;
+        const ADB so = pu.phase_used[BlackoilPhases::Liquid] ? ADB::constant(sat[pu.phase_pos[BlackoilPhases::Liquid]]) : null;
+        const ADB sg = pu.phase_used[BlackoilPhases::Vapour] ? ADB::constant(sat[pu.phase_pos[BlackoilPhases::Vapour]]) : null;
+        const std::vector<ADB> kr = props_.relperm(sw, so, sg, cells);
+
+        V mob = V::Zero(nperf);
+        if (pu.phase_used[BlackoilPhases::Aqua]) {
+            const V mu_w = props_.muWat(p_ad, temp_ad, cells).value();
+            for (int perf = 0; perf < nperf; ++perf) {
+                const V c_perf = V::Constant(1, conc[perf]);
+                const double inv_mu_eff = has_polymer_
+                    ? polymer_props_.effectiveInvWaterVisc(c_perf, &mu_w[perf])[0]
+                    : 1.0 / mu_w[perf];
+                mob[perf] += kr[BlackoilPhases::Aqua].value()[perf] * inv_mu_eff;
+            }
+        }
+        if (pu.phase_used[BlackoilPhases::Liquid]) {
+            mob += kr[BlackoilPhases::Liquid].value()
+                / props_.muOil(p_ad, temp_ad, ADB::constant(rs), cond, cells).value();
+        }
+        if (pu.phase_used[BlackoilPhases::Vapour]) {
+            mob += kr[BlackoilPhases::Vapour].value()
+                / props_.muGas(p_ad, temp_ad, ADB::constant(rv), cond, cells).value();
+        }
+
+        V weight = Eigen::Map<const V>(wells.WI + begin, nperf) * mob;
+        const double wsum = weight.sum();
+        if (wsum > 0.0) {
+            weight /= wsum;
+        } else {
+            weight = V::Constant(nperf, 1.0 / nperf);
+        }
+        int dominant = 0;
+        weight.maxCoeff(&dominant);
+
+        // Average conditions, evaluated in the PVT region of the
+        // dominant connection.
+        const std::vector<int> avg_cell(1, cells[dominant]);
+        const std::vector<PhasePresence> avg_cond(1, cond[dominant]);
+        const ADB avg_p    = ADB::constant(V::Constant(1, (weight * p).sum()));
+        const ADB avg_temp = ADB::constant(V::Constant(1, (weight * temp).sum()));
+        const double avg_rs = (pu.phase_used[BlackoilPhases::Liquid] && pu.phase_used[BlackoilPhases::Vapour])
+            ? (weight * rs).sum() : 0.0;
+        const double avg_rv = (pu.phase_used[BlackoilPhases::Liquid] && pu.phase_used[BlackoilPhases::Vapour])
+            ? (weight * rv).sum() : 0.0;
+
+        if (pu.phase_used[BlackoilPhases::Aqua]) {
+            const double bw = props_.bWat(avg_p, avg_temp, avg_cell).value()[0];
+            coeff[pu.phase_pos[BlackoilPhases::Aqua]] = 1.0 / bw;
+        }
+
+        // Oil and gas reservoir volumes of surface rates qo, qg are
+        //   (qo - rv*qg) / (bo*d)  and  (qg - rs*qo) / (bg*d),
+        // with d = 1 - rs*rv.
+        const double d = 1.0 - avg_rs * avg_rv;
+        if (pu.phase_used[BlackoilPhases::Liquid]) {
+            const int io = pu.phase_pos[BlackoilPhases::Liquid];
+            const ADB avg_rs_ad = ADB::constant(V::Constant(1, avg_rs));
+            const double bo = props_.bOil(avg_p, avg_temp, avg_rs_ad, avg_cond, avg_cell).value()[0];
+            coeff[io] += 1.0 / (bo * d);
+            if (pu.phase_used[BlackoilPhases::Vapour]) {
+                coeff[pu.phase_pos[BlackoilPhases::Vapour]] -= avg_rv / (bo * d);
+            }
+        }
+        if (pu.phase_used[BlackoilPhases::Vapour]) {
+            const int ig = pu.phase_pos[BlackoilPhases::Vapour];
+            const ADB avg_rv_ad = ADB::constant(V::Constant(1, avg_rv));
+            const double bg = props_.bGas(avg_p, avg_temp, avg_rv_ad, avg_cond, avg_cell).value()[0];
+            coeff[ig] += 1.0 / (bg * d);
+            if (pu.phase_used[BlackoilPhases::Liquid]) {
+                coeff[pu.phase_pos[BlackoilPhases::Liquid]] -= avg_rs / (bg * d);
+            }
+        }
+    }
 } // namespace Opm
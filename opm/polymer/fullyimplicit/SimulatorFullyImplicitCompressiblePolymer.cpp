@@ -49,8 +49,11 @@
 #include <opm/core/props/rock/RockCompressibility.hpp>
 
 #include <opm/core/grid/ColumnExtract.hpp>
+#include <opm/polymer/CellRenumbering.hpp>
 #include <opm/polymer/PolymerBlackoilState.hpp>
 #include <opm/polymer/PolymerInflow.hpp>
+#include <opm/polymer/PolymerTrace.hpp>
+#include <opm/polymer/WellNameIndex.hpp>
 #include <opm/core/simulator/WellState.hpp>
 #include <opm/core/transport/reorder/TransportSolverCompressibleTwophaseReorder.hpp>
 
@@ -284,7 +287,8 @@ namespace Opm
                 if (wells_manager.c_wells() == 0) {
                     OPM_THROW(std::runtime_error, "Cannot control polymer injection via WPOLYMER without wells.");
                 }
-                polymer_inflow_ptr.reset(new PolymerInflowFromDeck(deck_, eclipse_state_, *wells, Opm::UgGridHelpers::numCells(grid_), timer.currentStepNum()));
+                const WellNameIndex well_index(wells);
+                polymer_inflow_ptr.reset(new PolymerInflowFromDeck(deck_, eclipse_state_, *wells, well_index, Opm::UgGridHelpers::numCells(grid_), timer.currentStepNum()));
             } else {
                 polymer_inflow_ptr.reset(new PolymerInflowBasic(0.0*Opm::unit::day,
                                                                 1.0*Opm::unit::day,
@@ -302,6 +306,7 @@ namespace Opm
                 outputStateMatlab(grid_, state, timer.currentStepNum(), output_dir_);
             }
             if (output_) {
+                OPM_POLYMER_TRACE_SCOPE("output");
                 if (timer.currentStepNum() == 0) {
                     output_writer_.writeInit(timer);
                 }
@@ -370,6 +375,7 @@ namespace Opm
                 outputStateVtk(grid_, state, timer.currentStepNum(), output_dir_);
             }
             outputStateMatlab(grid_, state, timer.currentStepNum(), output_dir_);
+            OPM_POLYMER_TRACE_SCOPE("output");
             output_writer_.writeTimeStep(timer, state.blackoilState(), prev_well_state);
         }
 
@@ -391,6 +397,7 @@ namespace Opm
                                    const int step,
                                    const std::string& output_dir)
         {
+            OPM_POLYMER_TRACE_SCOPE("output");
             // Write data in VTK format.
             std::ostringstream vtkfilename;
             vtkfilename << output_dir << "/vtk_files";
@@ -423,6 +430,7 @@ namespace Opm
                                       const int step,
                                       const std::string& output_dir)
         {
+            OPM_POLYMER_TRACE_SCOPE("output");
             Opm::DataMap dm;
             dm["saturation"] = &state.saturation();
             dm["pressure"] = &state.pressure();
@@ -450,7 +458,9 @@ namespace Opm
                     OPM_THROW(std::runtime_error, "Failed to open " << fname.str());
                 }
                 file.precision(15);
-                const std::vector<double>& d = *(it->second);
+                // Cell data in the original order if the grid was renumbered.
+                std::vector<double> d;
+                Opm::mapToOriginalOrdering(grid, *(it->second), d);
                 std::copy(d.begin(), d.end(), std::ostream_iterator<double>(file, "\n"));
             }
         }
@@ -459,6 +469,7 @@ namespace Opm
         static void outputWaterCut(const Opm::Watercut& watercut,
                     	            const std::string& output_dir)
         {
+            OPM_POLYMER_TRACE_SCOPE("output");
             // Write water cut curve.
             std::string fname = output_dir  + "/watercut.txt";
             std::ofstream os(fname.c_str());
@@ -0,0 +1,109 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+#define NVERBOSE
+
+#define BOOST_TEST_MODULE AdsorptionConservationTest
+#include <boost/test/unit_test.hpp>
+
+#include <opm/polymer/PolymerBlackoilState.hpp>
+#include <opm/polymer/PolymerProperties.hpp>
+#include <opm/polymer/PolymerStepMaxConcentration.hpp>
+
+#include <cmath>
+#include <vector>
+
+using namespace Opm;
+
+namespace
+{
+
+    PolymerProperties makeProps(const double smoothing_width)
+    {
+        std::vector<double> c_vals_visc = { 0.0, 2.0 };
+        std::vector<double> visc_mult_vals = { 1.0, 5.0 };
+        std::vector<double> c_vals_ads = { 0.0, 0.5, 1.0, 2.0 };
+        std::vector<double> ads_vals = { 0.0, 0.0006, 0.0009, 0.001 };
+        std::vector<double> water_vel_vals = { 0.0, 10.0 };
+        std::vector<double> shear_vrf_vals = { 1.0, 1.0 };
+        PolymerProperties props(2.0, 1.0, 1000.0, 0.0, 1.0, 0.001, PolymerProperties::NoDesorption,
+                                c_vals_visc, visc_mult_vals, c_vals_ads, ads_vals,
+                                water_vel_vals, shear_vrf_vals);
+        props.setSmoothing(smoothing_width);
+        return props;
+    }
+
+    // Run a single cell through a sequence of converged steps with the
+    // given concentrations, with the max concentration bookkeeping of
+    // the fully implicit solvers. Checks that the adsorption of the
+    // start-of-step accumulation of every step equals the one of the
+    // converged end-of-step accumulation of the previous step, and
+    // returns the adsorption at the end of the last step.
+    double runSteps(const PolymerProperties& props, const std::vector<double>& c)
+    {
+        PolymerBlackoilState state;
+        state.init(1, 0, 2);
+        state.concentration()[0] = c[0];
+        state.maxconcentration()[0] = c[0];
+        PolymerStepMaxConcentration step_cmax;
+        double ads_end = 0.0;
+        for (std::size_t step = 1; step < c.size(); ++step) {
+            step_cmax.beginStep(state);
+            double ads_start;
+            props.adsorption(state.concentration()[0], step_cmax.accumulation(0)[0], ads_start);
+            if (step > 1) {
+                BOOST_CHECK_EQUAL(ads_start, ads_end);
+            }
+            state.concentration()[0] = c[step];
+            props.adsorption(state.concentration()[0], step_cmax.accumulation(1)[0], ads_end);
+            PolymerStepMaxConcentration::endStep(state);
+        }
+        return ads_end;
+    }
+
+    // Rising and falling concentration, crossing the table points and
+    // passing below an earlier maximum.
+    const double concentrations[] = { 0.0, 0.3, 0.8, 1.2, 0.9, 0.5, 0.7, 1.3, 1.25, 0.2, 0.0 };
+
+} // anonymous namespace
+
+
+
+BOOST_AUTO_TEST_CASE(AccumulationContinuousAcrossStepsWithAndWithoutSmoothing)
+{
+    const std::vector<double> c(concentrations, concentrations + sizeof(concentrations)/sizeof(double));
+    const PolymerProperties exact = makeProps(0.0);
+    const PolymerProperties smooth = makeProps(0.2);
+
+    const double end_exact = runSteps(exact, c);
+    const double end_smooth = runSteps(smooth, c);
+
+    // Without desorption the polymer stays adsorbed at the largest
+    // concentration seen, and smoothing only perturbs that within its
+    // error bound.
+    double ads_max;
+    exact.adsorption(1.3, 1.3, ads_max);
+    BOOST_CHECK_SMALL(end_exact - ads_max, 1e-15);
+    BOOST_CHECK_LE(std::fabs(end_smooth - end_exact), smooth.adsorptionSmoothingError());
+}
@@ -0,0 +1,192 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+#define NVERBOSE
+
+#define BOOST_TEST_MODULE GravityColumnSolverPolymerTest
+#include <boost/test/unit_test.hpp>
+
+#include <opm/polymer/GravityColumnSolverPolymer.hpp>
+#include <opm/polymer/GravityColumns.hpp>
+#include <opm/polymer/SinglePointUpwindTwoPhasePolymer.hpp>
+#include <opm/polymer/TwophaseFluidPolymer.hpp>
+#include <opm/polymer/PolymerProperties.hpp>
+#include <opm/core/grid.h>
+#include <opm/core/grid/GridManager.hpp>
+#include <opm/core/props/IncompPropertiesBasic.hpp>
+#include <opm/core/props/satfunc/SaturationPropsBasic.hpp>
+
+#include <vector>
+
+using namespace Opm;
+
+namespace
+{
+
+    typedef SinglePointUpwindTwoPhasePolymer<TwophaseFluidPolymer> FluxModel;
+    typedef GravityColumnSolverPolymer<FluxModel, PolymerProperties> Solver;
+
+    // A 2 x 4 grid with gravity along the y-axis, giving two vertical
+    // columns of four cells. The first column is segregated with the
+    // heavier water at the bottom, the second has the water on top.
+    struct ColumnsSetup
+    {
+        ColumnsSetup()
+            : grid(2, 4),
+              props(2, SaturationPropsBasic::Linear,
+                    std::vector<double>{ 1000.0, 800.0 },
+                    std::vector<double>(2, 1e-3),
+                    0.2, 1e-12, 2, 8),
+              nc(grid.c_grid()->number_of_cells),
+              gravity{ 0.0, 10.0 },
+              porevol(nc, 0.2),
+              s(2*nc),
+              c(nc, 0.0),
+              cmax(nc, 0.0)
+        {
+            std::vector<double> c_vals_visc = { 0.0, 2.0 };
+            std::vector<double> visc_mult_vals = { 1.0, 5.0 };
+            std::vector<double> c_vals_ads = { 0.0, 2.0 };
+            std::vector<double> ads_vals = { 0.0, 0.0 };
+            std::vector<double> water_vel_vals = { 0.0, 10.0 };
+            std::vector<double> shear_vrf_vals = { 1.0, 1.0 };
+            poly_props.set(2.0, 1.0, 1000.0, 0.0, 1.0, 0.001, PolymerProperties::NoDesorption,
+                           c_vals_visc, visc_mult_vals, c_vals_ads, ads_vals,
+                           water_vel_vals, shear_vrf_vals);
+            for (int col = 0; col < 2; ++col) {
+                std::vector<int> column;
+                for (int j = 0; j < 4; ++j) {
+                    column.push_back(col + 2*j);
+                }
+                all_columns.push_back(column);
+            }
+            // Water, with polymer, in the two deepest cells of the
+            // first column and the two shallowest of the second.
+            for (int j = 0; j < 4; ++j) {
+                setCell(2*j, j >= 2 ? 1.0 : 0.0, j >= 2 ? 0.5 : 0.0);
+                setCell(2*j + 1, j < 2 ? 1.0 : 0.0, j < 2 ? 0.5 : 0.0);
+            }
+        }
+
+        void setCell(const int cell, const double sw, const double conc)
+        {
+            s[2*cell] = sw;
+            s[2*cell + 1] = 1.0 - sw;
+            c[cell] = conc;
+            cmax[cell] = conc;
+        }
+
+        // Water volume and dissolved polymer in a column.
+        void columnContents(const std::vector<int>& column, double& water, double& polymer) const
+        {
+            water = 0.0;
+            polymer = 0.0;
+            for (int cell : column) {
+                water += porevol[cell]*s[2*cell];
+                polymer += porevol[cell]*s[2*cell]*c[cell];
+            }
+        }
+
+        // Run one step of the segregation solver on the given columns.
+        void solve(const std::vector<std::vector<int> >& columns)
+        {
+            TwophaseFluidPolymer fluid(props, poly_props);
+            FluxModel fmodel(fluid, *grid.c_grid(), porevol, gravity);
+            const std::vector<double> htrans(grid.c_grid()->cell_facepos[nc], 1.0);
+            fmodel.initGravityTrans(*grid.c_grid(), htrans);
+            Solver solver(fmodel, poly_props, *grid.c_grid(), 1e-9, 30);
+            solver.solve(GravityColumns(columns), dt, s, c, cmax);
+        }
+
+        static constexpr double dt = 1e-4;
+
+        GridManager grid;
+        IncompPropertiesBasic props;
+        PolymerProperties poly_props;
+        int nc;
+        double gravity[2];
+        std::vector<double> porevol;
+        std::vector<double> s;
+        std::vector<double> c;
+        std::vector<double> cmax;
+        std::vector<std::vector<int> > all_columns;
+    };
+
+    constexpr double ColumnsSetup::dt;
+
+} // anonymous namespace
+
+
+
+BOOST_FIXTURE_TEST_CASE(EquilibriumColumnLeavesActiveSet, ColumnsSetup)
+{
+    const std::vector<double> s0 = s;
+    const std::vector<double> c0 = c;
+    double water0[2], polymer0[2];
+    for (int col = 0; col < 2; ++col) {
+        columnContents(all_columns[col], water0[col], polymer0[col]);
+    }
+    solve(all_columns);
+
+    // The segregated column is untouched.
+    for (int cell : all_columns[0]) {
+        BOOST_CHECK_EQUAL(s[2*cell], s0[2*cell]);
+        BOOST_CHECK_EQUAL(c[cell], c0[cell]);
+    }
+    // In the other column water sinks, and water and polymer are
+    // conserved.
+    const int top = all_columns[1].front();
+    const int bottom = all_columns[1].back();
+    BOOST_CHECK_LT(s[2*top], s0[2*top]);
+    BOOST_CHECK_GT(s[2*bottom], s0[2*bottom]);
+    double water, polymer;
+    columnContents(all_columns[1], water, polymer);
+    BOOST_CHECK_CLOSE(water, water0[1], 1e-8);
+    BOOST_CHECK_CLOSE(polymer, polymer0[1], 1e-6);
+}
+
+
+
+BOOST_FIXTURE_TEST_CASE(ColumnsSolvedIndependently, ColumnsSetup)
+{
+    // Solving both columns together, with the converged column
+    // dropping out of the active set, gives the same result as
+    // solving the unstable column on its own.
+    std::vector<double> s_all = s;
+    std::vector<double> c_all = c;
+    std::vector<double> cmax_all = cmax;
+    std::swap(s, s_all);
+    std::swap(c, c_all);
+    std::swap(cmax, cmax_all);
+    solve(all_columns);
+    std::swap(s, s_all);
+    std::swap(c, c_all);
+    std::swap(cmax, cmax_all);
+
+    solve(std::vector<std::vector<int> >(1, all_columns[1]));
+    for (int cell : all_columns[1]) {
+        BOOST_CHECK_CLOSE(s_all[2*cell], s[2*cell], 1e-8);
+        BOOST_CHECK_CLOSE(c_all[cell] + 1.0, c[cell] + 1.0, 1e-8);
+    }
+}
@@ -0,0 +1,167 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+#define NVERBOSE
+
+#define BOOST_TEST_MODULE GravitySweepTest
+#include <boost/test/unit_test.hpp>
+
+#include <opm/polymer/TransportSolverTwophaseCompressiblePolymer.hpp>
+#include <opm/polymer/GravityColumns.hpp>
+#include <opm/polymer/PolymerProperties.hpp>
+#include <opm/core/grid.h>
+#include <opm/core/grid/GridManager.hpp>
+#include <opm/core/props/BlackoilPropertiesBasic.hpp>
+#include <opm/core/utility/parameters/ParameterGroup.hpp>
+#include <opm/core/utility/Units.hpp>
+
+#include <vector>
+
+using namespace Opm;
+
+namespace
+{
+
+    parameter::ParameterGroup fluidParams()
+    {
+        parameter::ParameterGroup param;
+        param.insertParameter("num_phases", "2");
+        param.insertParameter("relperm_func", "Quadratic");
+        param.insertParameter("rho1", "1000");
+        param.insertParameter("rho2", "800");
+        param.insertParameter("mu1", "1");
+        param.insertParameter("mu2", "1");
+        param.insertParameter("porosity", "0.2");
+        param.insertParameter("permeability", "100");
+        return param;
+    }
+
+    // A vertical column of six cells, gravity along the y-axis, without
+    // any Darcy flux. Water with polymer fills the two shallowest cells
+    // and oil the rest. Initially only the face between water and oil
+    // carries counter-current flow; the faces above and below it start
+    // to once the cells next to the interface have both phases.
+    struct ColumnSetup
+    {
+        ColumnSetup()
+            : grid(1, 6),
+              nc(grid.c_grid()->number_of_cells),
+              props(fluidParams(), 2, nc),
+              gravity{ 0.0, 9.81 },
+              flux(grid.c_grid()->number_of_faces, 0.0),
+              pressure(nc, 200.0*unit::barsa),
+              temperature(nc, 300.0),
+              porevol(nc),
+              src(nc, 0.0),
+              inflow_c(nc, 0.0),
+              s(2*nc),
+              surfvol(2*nc),
+              c(nc, 0.0),
+              cmax(nc, 0.0)
+        {
+            std::vector<double> c_vals_visc = { 0.0, 2.0 };
+            std::vector<double> visc_mult_vals = { 1.0, 5.0 };
+            std::vector<double> c_vals_ads = { 0.0, 2.0 };
+            std::vector<double> ads_vals = { 0.0, 0.0 };
+            std::vector<double> water_vel_vals = { 0.0, 10.0 };
+            std::vector<double> shear_vrf_vals = { 1.0, 1.0 };
+            poly_props.set(2.0, 1.0, 1000.0, 0.0, 1.0, 0.001, PolymerProperties::NoDesorption,
+                           c_vals_visc, visc_mult_vals, c_vals_ads, ads_vals,
+                           water_vel_vals, shear_vrf_vals);
+            for (int cell = 0; cell < nc; ++cell) {
+                porevol[cell] = props.porosity()[cell]*grid.c_grid()->cell_volumes[cell];
+                const double sw = (cell < 2) ? 1.0 : 0.0;
+                s[2*cell] = sw;
+                s[2*cell + 1] = 1.0 - sw;
+                c[cell] = (cell < 2) ? 0.5 : 0.0;
+                cmax[cell] = c[cell];
+                column.push_back(cell);
+            }
+        }
+
+        GridManager grid;
+        int nc;
+        BlackoilPropertiesBasic props;
+        PolymerProperties poly_props;
+        double gravity[2];
+        std::vector<double> flux;
+        std::vector<double> pressure;
+        std::vector<double> temperature;
+        std::vector<double> porevol;
+        std::vector<double> src;
+        std::vector<double> inflow_c;
+        std::vector<double> s;
+        std::vector<double> surfvol;
+        std::vector<double> c;
+        std::vector<double> cmax;
+        std::vector<int> column;
+    };
+
+    const double dt = 20.0*unit::day;
+    const double tol = 1e-10;
+    const int maxit = 50;
+
+} // anonymous namespace
+
+
+
+BOOST_FIXTURE_TEST_CASE(SweepMatchesSegregationSplit, ColumnSetup)
+{
+    // Segregation split: a transport step without flux, followed by
+    // the column-wise gravity solve.
+    std::vector<double> s_split = s;
+    std::vector<double> c_split = c;
+    std::vector<double> cmax_split = cmax;
+    {
+        TransportSolverTwophaseCompressiblePolymer tsolver(*grid.c_grid(), props, poly_props,
+                                                           TransportSolverTwophaseCompressiblePolymer::Bracketing,
+                                                           tol, maxit);
+        tsolver.initGravity(gravity);
+        tsolver.solve(&flux[0], pressure, pressure, temperature, &porevol[0], &porevol[0],
+                      &src[0], &inflow_c[0], dt, s_split, surfvol, c_split, cmax_split);
+        tsolver.solveGravity(GravityColumns(std::vector<std::vector<int> >(1, column)),
+                             dt, s_split, surfvol, c_split, cmax_split);
+    }
+
+    // Gravity in the reordered sweep.
+    TransportSolverTwophaseCompressiblePolymer tsolver(*grid.c_grid(), props, poly_props,
+                                                       TransportSolverTwophaseCompressiblePolymer::Bracketing,
+                                                       tol, maxit);
+    tsolver.initGravity(gravity);
+    tsolver.setGravityInSweep(true);
+    tsolver.solve(&flux[0], pressure, pressure, temperature, &porevol[0], &porevol[0],
+                  &src[0], &inflow_c[0], dt, s, surfvol, c, cmax);
+
+    double water = 0.0;
+    for (int cell = 0; cell < nc; ++cell) {
+        BOOST_CHECK_CLOSE(s[2*cell] + 1.0, s_split[2*cell] + 1.0, 1e-5);
+        BOOST_CHECK_CLOSE(c[cell] + 1.0, c_split[cell] + 1.0, 1e-5);
+        BOOST_CHECK_CLOSE(cmax[cell] + 1.0, cmax_split[cell] + 1.0, 1e-5);
+        water += porevol[cell]*s[2*cell];
+    }
+    // Water has moved into the lower cells, and is conserved.
+    BOOST_CHECK_GT(s[2*2], 0.0);
+    BOOST_CHECK_LT(s[2*1], 1.0);
+    BOOST_CHECK_CLOSE(water, 2.0*porevol[0], 1e-6);
+}
@@ -0,0 +1,273 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+#define NVERBOSE
+
+#define BOOST_TEST_MODULE ImplicitTransportPolymerTest
+#include <boost/test/unit_test.hpp>
+
+#include <opm/polymer/ImplicitTransportSolverPolymer.hpp>
+#include <opm/polymer/SinglePointUpwindTwoPhasePolymer.hpp>
+#include <opm/polymer/TwophaseFluidPolymer.hpp>
+#include <opm/polymer/PolymerProperties.hpp>
+#include <opm/core/grid.h>
+#include <opm/core/grid/GridManager.hpp>
+#include <opm/core/linalg/LinearSolverInterface.hpp>
+#include <opm/core/props/IncompPropertiesBasic.hpp>
+#include <opm/core/props/satfunc/SaturationPropsBasic.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace Opm;
+
+namespace
+{
+
+    // Gaussian elimination with partial pivoting on the dense copy of
+    // the system, enough for the small grids of these tests.
+    class DenseLinearSolver : public LinearSolverInterface
+    {
+    public:
+        DenseLinearSolver()
+            : tol_(1e-12)
+        {
+        }
+
+        LinearSolverReport solve(const int size, const int nonzeros,
+                                 const int* ia, const int* ja, const double* sa,
+                                 const double* rhs, double* solution) const
+        {
+            (void) nonzeros;
+            std::vector<double> a(size*size, 0.0);
+            std::vector<double> b(rhs, rhs + size);
+            for (int row = 0; row < size; ++row) {
+                for (int k = ia[row]; k < ia[row + 1]; ++k) {
+                    a[row*size + ja[k]] += sa[k];
+                }
+            }
+            for (int col = 0; col < size; ++col) {
+                int pivot = col;
+                for (int row = col + 1; row < size; ++row) {
+                    if (std::fabs(a[row*size + col]) > std::fabs(a[pivot*size + col])) {
+                        pivot = row;
+                    }
+                }
+                for (int k = 0; k < size; ++k) {
+                    std::swap(a[col*size + k], a[pivot*size + k]);
+                }
+                std::swap(b[col], b[pivot]);
+                for (int row = col + 1; row < size; ++row) {
+                    const double factor = a[row*size + col] / a[col*size + col];
+                    for (int k = col; k < size; ++k) {
+                        a[row*size + k] -= factor*a[col*size + k];
+                    }
+                    b[row] -= factor*b[col];
+                }
+            }
+            for (int row = size - 1; row >= 0; --row) {
+                double sum = b[row];
+                for (int k = row + 1; k < size; ++k) {
+                    sum -= a[row*size + k]*solution[k];
+                }
+                solution[row] = sum / a[row*size + row];
+            }
+            LinearSolverReport rep;
+            rep.converged = true;
+            rep.iterations = 1;
+            rep.residual_reduction = 0.0;
+            return rep;
+        }
+
+        void setTolerance(const double tol)
+        {
+            tol_ = tol;
+        }
+
+        double getTolerance() const
+        {
+            return tol_;
+        }
+
+    private:
+        double tol_;
+    };
+
+    typedef SinglePointUpwindTwoPhasePolymer<TwophaseFluidPolymer> FluxModel;
+    typedef ImplicitTransportSolverPolymer<FluxModel, PolymerProperties> Solver;
+
+    // An 8 x 1 grid with a water and polymer injector in the first
+    // cell, a producer in the last and a uniform flux between them.
+    struct ColumnSetup
+    {
+        ColumnSetup()
+            : grid(8, 1),
+              props(2, SaturationPropsBasic::Linear,
+                    std::vector<double>(2, 1000.0),
+                    std::vector<double>(2, 1e-3),
+                    0.2, 1e-12, 2, 8),
+              nc(grid.c_grid()->number_of_cells),
+              flux(grid.c_grid()->number_of_faces, 0.0),
+              porevol(nc, 0.2),
+              src(nc, 0.0),
+              inflow_c(nc, 0.0),
+              s(2*nc),
+              c(nc),
+              cmax(nc)
+        {
+            const UnstructuredGrid& g = *grid.c_grid();
+            for (int f = 0; f < g.number_of_faces; ++f) {
+                if (g.face_cells[2*f] >= 0 && g.face_cells[2*f + 1] == g.face_cells[2*f] + 1) {
+                    flux[f] = q;
+                }
+            }
+            src[0] = q;
+            src[nc - 1] = -q;
+            inflow_c[0] = 1.0;
+        }
+
+        void setPolymer(const std::vector<double>& ads_vals)
+        {
+            std::vector<double> c_vals_visc = { 0.0, 2.0 };
+            std::vector<double> visc_mult_vals = { 1.0, 5.0 };
+            std::vector<double> c_vals_ads = { 0.0, 1.0, 2.0 };
+            std::vector<double> water_vel_vals = { 0.0, 10.0 };
+            std::vector<double> shear_vrf_vals = { 1.0, 1.0 };
+            poly_props.set(2.0, 1.0, 1000.0, 0.1, 1.0, 0.001, PolymerProperties::NoDesorption,
+                           c_vals_visc, visc_mult_vals, c_vals_ads, ads_vals,
+                           water_vel_vals, shear_vrf_vals);
+        }
+
+        void setState(const double s_init, const double c_init)
+        {
+            for (int cell = 0; cell < nc; ++cell) {
+                s[2*cell] = s_init;
+                s[2*cell + 1] = 1.0 - s_init;
+                c[cell] = c_init;
+                cmax[cell] = c_init;
+            }
+        }
+
+        // Dissolved and adsorbed polymer in the grid.
+        double polymerMass() const
+        {
+            const double poro = props.porosity()[0];
+            double mass = 0.0;
+            for (int cell = 0; cell < nc; ++cell) {
+                double ads;
+                poly_props.adsorption(c[cell], cmax[cell], ads);
+                mass += porevol[cell]*((1.0 - poly_props.deadPoreVol())*s[2*cell]*c[cell]
+                                       + poly_props.rockDensity()*(1.0 - poro)/poro*ads);
+            }
+            return mass;
+        }
+
+        // Run one step with the implicit solver.
+        void solve()
+        {
+            TwophaseFluidPolymer fluid(props, poly_props);
+            FluxModel fmodel(fluid, *grid.c_grid(), porevol);
+            const std::vector<double> htrans(grid.c_grid()->cell_facepos[nc], 1.0);
+            fmodel.initGravityTrans(*grid.c_grid(), htrans);
+            Solver solver(fmodel, poly_props, *grid.c_grid(), linsolver, 1e-10, 25);
+            solver.solve(&flux[0], &porevol[0], &src[0], &inflow_c[0], dt, s, c, cmax);
+            newton_its = solver.newtonIterations();
+        }
+
+        static constexpr double q = 0.05;
+        static constexpr double dt = 1.0;
+
+        GridManager grid;
+        IncompPropertiesBasic props;
+        PolymerProperties poly_props;
+        DenseLinearSolver linsolver;
+        int nc;
+        std::vector<double> flux;
+        std::vector<double> porevol;
+        std::vector<double> src;
+        std::vector<double> inflow_c;
+        std::vector<double> s;
+        std::vector<double> c;
+        std::vector<double> cmax;
+        int newton_its;
+    };
+
+    constexpr double ColumnSetup::q;
+    constexpr double ColumnSetup::dt;
+
+} // anonymous namespace
+
+
+
+BOOST_FIXTURE_TEST_CASE(PolymerMassConserved, ColumnSetup)
+{
+    setPolymer(std::vector<double>{ 0.0, 0.0005, 0.0007 });
+    setState(0.2, 0.0);
+    const double mass0 = polymerMass();
+    solve();
+    BOOST_CHECK_GE(newton_its, 1);
+    for (int cell = 0; cell < nc; ++cell) {
+        BOOST_CHECK_GE(s[2*cell], 0.2 - 1e-12);
+        BOOST_CHECK_LE(s[2*cell], 1.0);
+        BOOST_CHECK_GE(c[cell], 0.0);
+        BOOST_CHECK_LE(c[cell], 1.0 + 1e-12);
+    }
+    // The front stays well inside the grid, so nothing is produced.
+    BOOST_CHECK_SMALL(c[nc - 1], 1e-10);
+    BOOST_CHECK_CLOSE(polymerMass() - mass0, q*dt*inflow_c[0], 1e-6);
+}
+
+
+
+BOOST_FIXTURE_TEST_CASE(DryCellsKeepConcentration, ColumnSetup)
+{
+    // Without adsorption a cell without water stores no polymer, so
+    // its c-equation has no accumulation term. Flow is confined to
+    // the first six cells, the last two stay dry.
+    const int nflow = 6;
+    const UnstructuredGrid& g = *grid.c_grid();
+    for (int f = 0; f < g.number_of_faces; ++f) {
+        if (g.face_cells[2*f + 1] >= nflow) {
+            flux[f] = 0.0;
+        }
+    }
+    src[nc - 1] = 0.0;
+    src[nflow - 1] = -q;
+    setPolymer(std::vector<double>{ 0.0, 0.0, 0.0 });
+    setState(0.0, 0.3);
+    const double mass0 = polymerMass();
+    solve();
+    BOOST_CHECK_GT(s[0], 0.0);
+    for (int cell = 0; cell < nc; ++cell) {
+        BOOST_CHECK(std::isfinite(c[cell]));
+        BOOST_CHECK_GE(c[cell], 0.0);
+    }
+    for (int cell = nflow; cell < nc; ++cell) {
+        BOOST_CHECK_EQUAL(s[2*cell], 0.0);
+        BOOST_CHECK_EQUAL(c[cell], 0.3);
+    }
+    // Only a trace of water reaches the producer.
+    BOOST_CHECK_CLOSE(polymerMass() - mass0, q*dt*inflow_c[0], 1e-3);
+}
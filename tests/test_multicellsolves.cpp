@@ -0,0 +1,218 @@
+/*
+  Copyright 2015 SINTEF ICT, Applied Mathematics.
+
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <config.h>
+
+#if HAVE_DYNAMIC_BOOST_TEST
+#define BOOST_TEST_DYN_LINK
+#endif
+#define NVERBOSE
+
+#define BOOST_TEST_MODULE MultiCellSolvesTest
+#include <boost/test/unit_test.hpp>
+
+#include <opm/polymer/TransportSolverTwophasePolymer.hpp>
+#include <opm/polymer/TransportSolverTwophaseCompressiblePolymer.hpp>
+#include <opm/polymer/PolymerProperties.hpp>
+#include <opm/core/grid.h>
+#include <opm/core/grid/GridManager.hpp>
+#include <opm/core/props/BlackoilPropertiesBasic.hpp>
+#include <opm/core/props/IncompPropertiesBasic.hpp>
+#include <opm/core/props/satfunc/SaturationPropsBasic.hpp>
+#include <opm/core/utility/parameters/ParameterGroup.hpp>
+#include <opm/core/utility/Units.hpp>
+
+#include <map>
+#include <vector>
+
+using namespace Opm;
+
+namespace
+{
+
+    // Set the flux q around a cycle of neighbouring cells,
+    // cycle[0] -> cycle[1] -> ... -> cycle[0].
+    void addCyclicFlux(const UnstructuredGrid& g, const std::vector<int>& cycle,
+                       const double q, std::vector<double>& flux)
+    {
+        const int n = cycle.size();
+        for (int i = 0; i < n; ++i) {
+            const int from = cycle[i];
+            const int to = cycle[(i + 1) % n];
+            bool found = false;
+            for (int f = 0; f < g.number_of_faces; ++f) {
+                if (g.face_cells[2*f] == from && g.face_cells[2*f + 1] == to) {
+                    flux[f] = q;
+                    found = true;
+                } else if (g.face_cells[2*f] == to && g.face_cells[2*f + 1] == from) {
+                    flux[f] = -q;
+                    found = true;
+                }
+            }
+            BOOST_REQUIRE(found);
+        }
+    }
+
+    // A 5 x 2 grid with two flux cycles, one through the four cells of
+    // the first two columns and one through the six cells of the last
+    // three, giving one strongly connected component of each size.
+    // Polymer concentration is zero and cmax differs from cell to cell.
+    struct CyclicSetup
+    {
+        CyclicSetup()
+            : grid(5, 2),
+              props(2, SaturationPropsBasic::Linear,
+                    std::vector<double>(2, 1000.0),
+                    std::vector<double>(2, 1e-3),
+                    0.2, 1e-12, 2, 10),
+              nc(grid.c_grid()->number_of_cells),
+              flux(grid.c_grid()->number_of_faces, 0.0),
+              porevol(nc, 0.2),
+              src(nc, 0.0),
+              inflow_c(nc, 0.0),
+              s(2*nc),
+              c(nc, 0.0),
+              cmax(nc)
+        {
+            std::vector<double> c_vals_visc = { 0.0, 7.0 };
+            std::vector<double> visc_mult_vals = { 1.0, 20.0 };
+            std::vector<double> c_vals_ads = { 0.0, 2.0, 8.0 };
+            std::vector<double> ads_vals = { 0.0, 0.0015, 0.0025 };
+            std::vector<double> water_vel_vals = { 0.0, 10.0 };
+            std::vector<double> shear_vrf_vals = { 1.0, 1.0 };
+            poly_props.set(5.0, 1.0, 1000.0, 0.0, 1.0, 1.0, PolymerProperties::NoDesorption,
+                           c_vals_visc, visc_mult_vals, c_vals_ads, ads_vals,
+                           water_vel_vals, shear_vrf_vals);
+            const int small_cycle[] = { 0, 1, 6, 5 };
+            const int large_cycle[] = { 2, 3, 4, 9, 8, 7 };
+            addCyclicFlux(*grid.c_grid(), std::vector<int>(small_cycle, small_cycle + 4), 1.0, flux);
+            addCyclicFlux(*grid.c_grid(), std::vector<int>(large_cycle, large_cycle + 6), 1.0, flux);
+            for (int cell = 0; cell < nc; ++cell) {
+                s[2*cell] = 0.2 + 0.06*cell;
+                s[2*cell + 1] = 1.0 - s[2*cell];
+                cmax[cell] = 0.1*(cell + 1);
+            }
+        }
+
+        GridManager grid;
+        IncompPropertiesBasic props;
+        PolymerProperties poly_props;
+        int nc;
+        std::vector<double> flux;
+        std::vector<double> porevol;
+        std::vector<double> src;
+        std::vector<double> inflow_c;
+        std::vector<double> s;
+        std::vector<double> c;
+        std::vector<double> cmax;
+    };
+
+    const double dt = 0.1;
+    const double tol = 1e-9;
+    const int maxit = 30;
+
+    // Fluid matching the incompressible properties of CyclicSetup,
+    // for the compressible solver.
+    parameter::ParameterGroup blackoilParams()
+    {
+        parameter::ParameterGroup param;
+        param.insertParameter("num_phases", "2");
+        param.insertParameter("relperm_func", "Linear");
+        param.insertParameter("rho1", "1000");
+        param.insertParameter("rho2", "1000");
+        param.insertParameter("mu1", "1");
+        param.insertParameter("mu2", "1");
+        param.insertParameter("porosity", "0.2");
+        return param;
+    }
+
+} // anonymous namespace
+
+
+
+BOOST_FIXTURE_TEST_CASE(CyclicComponentsKeepCellCmax, CyclicSetup)
+{
+    TransportSolverTwophasePolymer tsolver(*grid.c_grid(), props, poly_props,
+                                           TransportSolverTwophasePolymer::Bracketing, tol, maxit);
+    const std::vector<double> cmax_start = cmax;
+    tsolver.solve(&flux[0], &porevol[0], &src[0], &inflow_c[0], dt, s, c, cmax);
+    for (int cell = 0; cell < nc; ++cell) {
+        BOOST_CHECK_SMALL(c[cell], 1e-12);
+        BOOST_CHECK_EQUAL(cmax[cell], cmax_start[cell]);
+    }
+}
+
+
+
+BOOST_FIXTURE_TEST_CASE(CompressibleCyclicComponentsKeepCellCmax, CyclicSetup)
+{
+    BlackoilPropertiesBasic blackoil_props(blackoilParams(), 2, nc);
+    TransportSolverTwophaseCompressiblePolymer tsolver(*grid.c_grid(), blackoil_props, poly_props,
+                                                       TransportSolverTwophaseCompressiblePolymer::Bracketing,
+                                                       tol, maxit);
+    const std::vector<double> pressure(nc, 200.0*unit::barsa);
+    const std::vector<double> temperature(nc, 300.0);
+    std::vector<double> surfacevol(2*nc);
+    const std::vector<double> cmax_start = cmax;
+    tsolver.solve(&flux[0], pressure, pressure, temperature, &porevol[0], &porevol[0],
+                  &src[0], &inflow_c[0], dt, s, surfacevol, c, cmax);
+    BOOST_CHECK_EQUAL(tsolver.multiCellIterations().size(), 2u);
+    for (int cell = 0; cell < nc; ++cell) {
+        BOOST_CHECK_SMALL(c[cell], 1e-12);
+        BOOST_CHECK_EQUAL(cmax[cell], cmax_start[cell]);
+    }
+}
+
+
+
+BOOST_FIXTURE_TEST_CASE(AndersonScratchSizedBeforeSolve, CyclicSetup)
+{
+    TransportSolverTwophasePolymer tsolver(*grid.c_grid(), props, poly_props,
+                                           TransportSolverTwophasePolymer::Bracketing, tol, maxit);
+    tsolver.setAndersonDepth(3);
+    const int allocations = tsolver.scratchAllocations();
+    for (int step = 0; step < 2; ++step) {
+        tsolver.solve(&flux[0], &porevol[0], &src[0], &inflow_c[0], dt, s, c, cmax);
+        BOOST_CHECK_EQUAL(tsolver.scratchAllocations(), allocations);
+    }
+}
+
+
+
+BOOST_FIXTURE_TEST_CASE(CyclicComponentIterationCounts, CyclicSetup)
+{
+    TransportSolverTwophasePolymer tsolver(*grid.c_grid(), props, poly_props,
+                                           TransportSolverTwophasePolymer::Bracketing, tol, maxit);
+    const int num_solves = 3;
+    for (int step = 0; step < num_solves; ++step) {
+        tsolver.solve(&flux[0], &porevol[0], &src[0], &inflow_c[0], dt, s, c, cmax);
+    }
+    const std::map<int, std::pair<int, int> >& stats = tsolver.multiCellIterations();
+    BOOST_REQUIRE_EQUAL(stats.size(), 2u);
+    const int sizes[] = { 4, 6 };
+    for (int i = 0; i < 2; ++i) {
+        const std::map<int, std::pair<int, int> >::const_iterator it = stats.find(sizes[i]);
+        BOOST_REQUIRE(it != stats.end());
+        // One component of each size per solve, and at least one
+        // Gauss-Seidel pass per component.
+        BOOST_CHECK_EQUAL(it->second.first, num_solves);
+        BOOST_CHECK_GE(it->second.second, num_solves);
+        BOOST_CHECK_LE(it->second.second, num_solves*maxit);
+    }
+}